@@ -373,7 +373,7 @@ void SimpleSimulator::run() {
 int main(int argc, char* argv[])
 {
 /*	if (( argc != 1) && ( argc != 3)) {
-        	std::cout << "usage: SimpleSimulator [host] [port]\n";
+        	std::cout << "usage: SimpleSimulator [host] [port] | [port] | [unix socket path]\n";
         	return 0;
 	}*/
 
@@ -383,14 +383,23 @@ int main(int argc, char* argv[])
     if ((argc>1) && ((std::string(argv[1]).find("-NSDocumentRevisionsDebugMode")==0 ) || (std::string(argv[1]).find("-psn_")==0))) argc = 1;
 #endif
 
+	// a single absolute path argument selects a local TUIO/UNIX socket
+	bool unix_path = (argc == 2) && (argv[1][0] == '/');
+
 	TuioServer *server = NULL;
 	if( argc == 3 ) {
 		server = new TuioServer(argv[1],atoi(argv[2]));
+	} else if ( unix_path ) {
+		OscSender *unix_sender = NULL;
+		try { unix_sender = new UnixSender(argv[1]); }
+		catch (std::exception e) { unix_sender = NULL; }
+		if (unix_sender) server = new TuioServer(unix_sender);
+		else server = new TuioServer();
 	} else server = new TuioServer(); // default is UDP port 3333 on localhost
 
 	// add an additional TUIO/TCP sender
 	OscSender *tcp_sender = NULL;
-	if( argc == 2 ) {
+	if( ( argc == 2 ) && !unix_path ) {
 		try { tcp_sender = new TcpSender(atoi(argv[1])); }
 		catch (std::exception e) { tcp_sender = NULL; }
 	} else if ( argc == 3 ) {
@@ -28,6 +28,7 @@
 
 #include "TcpSender.h"
 #include "WebSockSender.h"
+#include "UnixSender.h"
 
 #ifdef __APPLE__
 #include <SDL2/SDL.h>
@@ -0,0 +1,345 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "JitterBuffer.h"
+#include "TuioClock.h"
+#include "osc/OscReceivedElements.h"
+#include <cstring>
+#include <cstdio>
+
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+
+using namespace TUIO;
+using namespace osc;
+
+// the frame properties which are extracted from a packet without processing its messages
+struct JitterFrame {
+	std::string source;
+	int32 fseq;
+	uint64 timetag;
+	bool frame;
+};
+
+static void scanElements(ReceivedBundle bundle, JitterFrame &frame) {
+	for (ReceivedBundle::const_iterator i = bundle.ElementsBegin(); i != bundle.ElementsEnd(); ++i) {
+		if (i->IsBundle()) {
+			scanElements(ReceivedBundle(*i), frame);
+			continue;
+		}
+
+		ReceivedMessage message(*i);
+		if (strncmp(message.AddressPattern(), "/tuio/", 6)!=0) continue;
+		ReceivedMessage::const_iterator arg = message.ArgumentsBegin();
+		if ((arg==message.ArgumentsEnd()) || !arg->IsString()) continue;
+
+		const char *cmd = arg->AsStringUnchecked();
+		if (strcmp(cmd,"source")==0) {
+			if ((++arg!=message.ArgumentsEnd()) && arg->IsString()) frame.source = arg->AsStringUnchecked();
+		} else if (strcmp(cmd,"fseq")==0) {
+			if ((++arg!=message.ArgumentsEnd()) && arg->IsInt32()) {
+				frame.fseq = arg->AsInt32Unchecked();
+				frame.frame = true;
+			}
+		}
+	}
+}
+
+static uint64 hashPacket(const char *data, int size) {
+	// FNV-1a
+	uint64 hash = 14695981039346656037ULL;
+	for (int i=0;i<size;i++) {
+		hash ^= (unsigned char)data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+JitterBuffer::JitterBuffer(int max, int min)
+: sequence		(0)
+, max_delay		((int64)max*1000000)
+, min_delay		((int64)min*1000000)
+, delay			((int64)min*1000000)
+, depth			(0)
+, late_count		(0)
+, dropped_count	(0)
+, duplicate_count	(0)
+, running		(false)
+{
+	if (min_delay>max_delay) min_delay = max_delay;
+#ifdef WIN32
+	bufferMutex = CreateMutex(NULL,FALSE,NULL);
+	bufferEvent = CreateEvent(NULL,FALSE,FALSE,NULL);
+#else
+	pthread_mutex_init(&bufferMutex,NULL);
+	pthread_cond_init(&bufferCond,NULL);
+#endif
+}
+
+JitterBuffer::~JitterBuffer() {
+	stop();
+#ifdef WIN32
+	CloseHandle(bufferMutex);
+	CloseHandle(bufferEvent);
+#else
+	pthread_mutex_destroy(&bufferMutex);
+	pthread_cond_destroy(&bufferCond);
+#endif
+}
+
+void JitterBuffer::addPacket(const char *data, int size, const IpEndpointName &endpoint, int64 receive_time) {
+
+	int64 now = TuioClock::getSystemTime();
+
+	JitterFrame frame;
+	frame.fseq = 0;
+	frame.timetag = 1;
+	frame.frame = false;
+	try {
+		ReceivedPacket p(data, size);
+		if (p.IsBundle()) {
+			ReceivedBundle bundle(p);
+			frame.timetag = bundle.TimeTag();
+			scanElements(bundle, frame);
+		}
+	} catch (Exception& e) {
+		// malformed packets are released immediately and reported by the TuioClient
+		frame.frame = false;
+	}
+
+	JitterPacket *packet = new JitterPacket();
+	packet->data.assign(data, size);
+	packet->endpoint = endpoint;
+	packet->receive_time = receive_time;
+	packet->release_time = now;
+	packet->fseq = frame.fseq;
+
+	lock();
+	if (!running) {
+		unlock();
+		delete packet;
+		return;
+	}
+
+	if (!frame.frame) {
+		controlList.push_back(packet);
+		signal();
+		unlock();
+		return;
+	}
+
+	// unnamed sources are distinguished by their origin
+	if (frame.source.empty()) {
+		char address[32];
+		sprintf(address, "@%lu:%d", endpoint.address, endpoint.port);
+		frame.source = address;
+	}
+
+	std::map<std::string,JitterSource>::iterator iter = sourceList.find(frame.source);
+	if (iter==sourceList.end()) {
+		JitterSource source;
+		source.release_fseq = -1;
+		source.receive_fseq = 0;
+		source.release_time = 0;
+		source.base_transit = 0;
+		source.last_transit = 0;
+		source.late_margin = 0;
+		source.jitter = 0.0;
+		source.initialized = false;
+		iter = sourceList.insert(std::pair<std::string,JitterSource>(frame.source,source)).first;
+	}
+	JitterSource &source = iter->second;
+
+	if (frame.fseq>0) {
+		// redundant bundles without a frame sequence may be identical, therefore only frames are compared
+		uint64 hash = hashPacket(data, size);
+		if (isDuplicate(source, hash)) {
+			duplicate_count++;
+			unlock();
+			delete packet;
+			return;
+		}
+		source.historyList.push_back(hash);
+		if (source.historyList.size()>JITTER_HISTORY) source.historyList.pop_front();
+
+		if ((frame.fseq<source.release_fseq) && ((source.release_fseq-frame.fseq)<=100)) {
+			// a newer frame was already released, the delay needs to cover this arrival next time
+			source.late_margin += now-source.release_time;
+			if (source.late_margin>max_delay) source.late_margin = max_delay;
+			late_count++;
+			unlock();
+			delete packet;
+			return;
+		}
+		if ((frame.fseq>source.receive_fseq) || ((source.receive_fseq-frame.fseq)>100)) source.receive_fseq = frame.fseq;
+	} else packet->fseq = source.receive_fseq;
+
+	// the transit time includes the unknown clock offset, which cancels out against the base transit
+	int64 source_time = (frame.timetag>1) ? TuioClock::getTime(frame.timetag) : now;
+	int64 transit = now-source_time;
+	if (!source.initialized) {
+		source.base_transit = source.last_transit = transit;
+		source.initialized = true;
+	} else {
+		int64 difference = transit-source.last_transit;
+		if (difference<0) difference = -difference;
+		source.jitter += ((double)difference-source.jitter)/16.0;
+		source.last_transit = transit;
+		if (transit<source.base_transit) source.base_transit = transit;
+		else source.base_transit += (transit-source.base_transit)/1024;
+	}
+
+	delay = min_delay + (int64)(3.0*source.jitter) + source.late_margin;
+	if (delay>max_delay) delay = max_delay;
+	packet->release_time = source_time+source.base_transit+delay;
+
+	source.frameList[std::pair<int32,unsigned long>(packet->fseq,sequence++)] = packet;
+	depth++;
+
+	// release the oldest frame immediately if the source exceeds the buffer size
+	if (source.frameList.size()>JITTER_MAX_FRAMES) source.frameList.begin()->second->release_time = 0;
+
+	signal();
+	unlock();
+}
+
+bool JitterBuffer::isDuplicate(JitterSource &source, uint64 hash) {
+	for (std::list<uint64>::iterator iter = source.historyList.begin(); iter!=source.historyList.end(); iter++)
+		if ((*iter)==hash) return true;
+	return false;
+}
+
+JitterPacket* JitterBuffer::getPacket() {
+
+	lock();
+	while (running) {
+
+		if (!controlList.empty()) {
+			JitterPacket *packet = controlList.front();
+			controlList.pop_front();
+			unlock();
+			return packet;
+		}
+
+		// only the oldest frame of each source is eligible, so that frames leave in fseq order
+		int64 now = TuioClock::getSystemTime();
+		int64 next_release = -1;
+		for (std::map<std::string,JitterSource>::iterator iter = sourceList.begin(); iter!=sourceList.end(); iter++) {
+			JitterSource &source = iter->second;
+			if (source.frameList.empty()) continue;
+
+			JitterPacket *packet = source.frameList.begin()->second;
+			if (packet->release_time<=now) {
+				source.frameList.erase(source.frameList.begin());
+				depth--;
+				if ((source.release_fseq>0) && (packet->fseq>source.release_fseq+1)) dropped_count += packet->fseq-source.release_fseq-1;
+				if ((packet->fseq>source.release_fseq) || ((source.release_fseq-packet->fseq)>100)) source.release_fseq = packet->fseq;
+				source.release_time = now;
+				// every frame in time slowly reduces the additional delay of earlier late frames
+				source.late_margin -= source.late_margin/256;
+				unlock();
+				return packet;
+			}
+			if ((next_release<0) || (packet->release_time<next_release)) next_release = packet->release_time;
+		}
+
+		wait((next_release<0) ? -1 : next_release-now);
+	}
+	unlock();
+	return NULL;
+}
+
+void JitterBuffer::freePacket(JitterPacket *packet) {
+	delete packet;
+}
+
+void JitterBuffer::start() {
+	lock();
+	running = true;
+	unlock();
+}
+
+void JitterBuffer::stop() {
+	lock();
+	running = false;
+	for (std::list<JitterPacket*>::iterator iter = controlList.begin(); iter!=controlList.end(); iter++) delete (*iter);
+	controlList.clear();
+	for (std::map<std::string,JitterSource>::iterator iter = sourceList.begin(); iter!=sourceList.end(); iter++) {
+		for (std::map<std::pair<int32,unsigned long>,JitterPacket*>::iterator frame = iter->second.frameList.begin(); frame!=iter->second.frameList.end(); frame++)
+			delete frame->second;
+	}
+	sourceList.clear();
+	depth = 0;
+	signal();
+	unlock();
+}
+
+void JitterBuffer::resetCounters() {
+	lock();
+	late_count = 0;
+	dropped_count = 0;
+	duplicate_count = 0;
+	unlock();
+}
+
+void JitterBuffer::lock() {
+#ifdef WIN32
+	WaitForSingleObject(bufferMutex, INFINITE);
+#else
+	pthread_mutex_lock(&bufferMutex);
+#endif
+}
+
+void JitterBuffer::unlock() {
+#ifdef WIN32
+	ReleaseMutex(bufferMutex);
+#else
+	pthread_mutex_unlock(&bufferMutex);
+#endif
+}
+
+void JitterBuffer::signal() {
+#ifdef WIN32
+	SetEvent(bufferEvent);
+#else
+	pthread_cond_signal(&bufferCond);
+#endif
+}
+
+void JitterBuffer::wait(int64 timeout) {
+#ifdef WIN32
+	unlock();
+	WaitForSingleObject(bufferEvent, (timeout<0) ? INFINITE : (DWORD)(timeout/1000000+1));
+	lock();
+#else
+	if (timeout<0) {
+		pthread_cond_wait(&bufferCond, &bufferMutex);
+		return;
+	}
+
+	// the condition variable waits for an absolute time of the real-time clock
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	int64 until = (int64)now.tv_sec*1000000000 + (int64)now.tv_usec*1000 + timeout;
+	struct timespec deadline;
+	deadline.tv_sec = (time_t)(until/1000000000);
+	deadline.tv_nsec = (long)(until%1000000000);
+	pthread_cond_timedwait(&bufferCond, &bufferMutex, &deadline);
+#endif
+}
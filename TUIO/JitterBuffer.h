@@ -0,0 +1,196 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_JITTERBUFFER_H
+#define INCLUDED_JITTERBUFFER_H
+
+#include "LibExport.h"
+#include "osc/OscTypes.h"
+#include "ip/IpEndpointName.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <map>
+#include <list>
+#include <string>
+
+#define JITTER_MAX_FRAMES 256
+#define JITTER_HISTORY 16
+
+namespace TUIO {
+
+	/**
+	 * A received OSC packet, which is held by the JitterBuffer until its release time
+	 */
+	struct LIBDECL JitterPacket {
+		std::string data;
+		IpEndpointName endpoint;
+		osc::int64 receive_time;
+		osc::int64 release_time;
+		osc::int32 fseq;
+	};
+
+	/**
+	 * The JitterBuffer holds the complete frames of each TUIO source for a bounded delay
+	 * and releases them in fseq order at the cadence of their OSC time tags.
+	 * The delay adapts to the measured transit jitter of each source and is extended
+	 * whenever a frame arrives after a newer frame of its source had already been released.
+	 * Packets without a frame sequence, such as the clock synchronization replies, are released immediately.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL JitterBuffer {
+
+	public:
+
+		/**
+		 * This constructor creates a JitterBuffer with the provided delay limits
+		 *
+		 * @param  max_delay  the maximum delay in milliseconds
+		 * @param  min_delay  the minimum delay in milliseconds
+		 */
+		JitterBuffer(int max_delay=100, int min_delay=0);
+
+		/**
+		 * The destructor releases all remaining packets
+		 */
+		~JitterBuffer();
+
+		/**
+		 * Adds a copy of the provided OSC packet, this method can be called from any thread
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @param  endpoint  the source of the OSC packet
+		 * @param  receive_time  the kernel receive time in nanoseconds since the epoch, or 0 if unknown
+		 */
+		void addPacket(const char *data, int size, const IpEndpointName &endpoint, osc::int64 receive_time);
+
+		/**
+		 * Waits until the next packet is due for its release
+		 *
+		 * @return the released packet, which has to be freed with freePacket(), or NULL if the buffer was stopped
+		 */
+		JitterPacket* getPacket();
+
+		/**
+		 * Frees a packet that was returned by getPacket()
+		 *
+		 * @param  packet  the released packet
+		 */
+		void freePacket(JitterPacket *packet);
+
+		/**
+		 * Enables the release of packets by getPacket()
+		 */
+		void start();
+
+		/**
+		 * Interrupts a pending getPacket() call and discards all held packets
+		 */
+		void stop();
+
+		/**
+		 * Returns the number of frames that are currently held
+		 *
+		 * @return the current buffer depth
+		 */
+		int getDepth() { return depth; };
+
+		/**
+		 * Returns the current delay of the latest source
+		 *
+		 * @return the current delay in nanoseconds
+		 */
+		osc::int64 getDelay() { return delay; };
+
+		/**
+		 * Returns the number of frames, which were discarded because a newer frame of their source had already been released
+		 *
+		 * @return the number of late frames
+		 */
+		long getLateCount() { return late_count; };
+
+		/**
+		 * Returns the number of frames, which never arrived before a newer frame of their source was released
+		 *
+		 * @return the number of dropped frames
+		 */
+		long getDroppedCount() { return dropped_count; };
+
+		/**
+		 * Returns the number of discarded duplicate packets
+		 *
+		 * @return the number of duplicate packets
+		 */
+		long getDuplicateCount() { return duplicate_count; };
+
+		/**
+		 * Resets the late, dropped and duplicate counters
+		 */
+		void resetCounters();
+
+	private:
+
+		struct JitterSource {
+			std::map<std::pair<osc::int32,unsigned long>,JitterPacket*> frameList;
+			std::list<osc::uint64> historyList;
+			osc::int32 release_fseq;
+			osc::int32 receive_fseq;
+			osc::int64 release_time;
+			osc::int64 base_transit;
+			osc::int64 last_transit;
+			osc::int64 late_margin;
+			double jitter;
+			bool initialized;
+		};
+
+		bool isDuplicate(JitterSource &source, osc::uint64 hash);
+		void lock();
+		void unlock();
+		void signal();
+		void wait(osc::int64 timeout);
+
+		std::map<std::string,JitterSource> sourceList;
+		std::list<JitterPacket*> controlList;
+		unsigned long sequence;
+
+		osc::int64 max_delay;
+		osc::int64 min_delay;
+		osc::int64 delay;
+		int depth;
+		long late_count;
+		long dropped_count;
+		long duplicate_count;
+		bool running;
+
+#ifdef WIN32
+		HANDLE bufferMutex;
+		HANDLE bufferEvent;
+#else
+		pthread_mutex_t bufferMutex;
+		pthread_cond_t bufferCond;
+#endif
+	};
+}
+#endif /* INCLUDED_JITTERBUFFER_H */
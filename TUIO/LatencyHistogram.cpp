@@ -0,0 +1,118 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "LatencyHistogram.h"
+
+#ifdef WIN32
+#include <windows.h>
+#define LATENCY_ADD(target,value) InterlockedExchangeAdd64((volatile LONGLONG*)(target),(value))
+#define LATENCY_CAS(target,expected,value) (InterlockedCompareExchange64((volatile LONGLONG*)(target),(value),(expected))==(expected))
+#else
+#define LATENCY_ADD(target,value) __sync_fetch_and_add((target),(value))
+#define LATENCY_CAS(target,expected,value) __sync_bool_compare_and_swap((target),(expected),(value))
+#endif
+
+using namespace TUIO;
+
+LatencyHistogram::LatencyHistogram() {
+	reset();
+}
+
+void LatencyHistogram::reset() {
+	for (int i=0;i<LATENCY_BUCKETS;i++) counts[i] = 0;
+	total_count = 0;
+	total_sum = 0;
+	min_value = -1;
+	max_value = 0;
+}
+
+int LatencyHistogram::getBucket(osc::int64 value) {
+
+	if (value<LATENCY_SUB_BUCKETS) return (int)value;
+
+	int exponent = LATENCY_SUB_BITS;
+	while ((exponent<LATENCY_MAX_EXPONENT) && ((value>>(exponent+1))>0)) exponent++;
+	if ((value>>(exponent+1))>0) return LATENCY_BUCKETS-1;
+
+	int shift = exponent-LATENCY_SUB_BITS+1;
+	int sub_bucket = (int)(value>>shift) - LATENCY_SUB_BUCKETS/2;
+	return LATENCY_SUB_BUCKETS + (exponent-LATENCY_SUB_BITS)*(LATENCY_SUB_BUCKETS/2) + sub_bucket;
+}
+
+osc::int64 LatencyHistogram::getBucketLimit(int bucket) {
+
+	if (bucket<LATENCY_SUB_BUCKETS) return bucket;
+
+	int index = bucket-LATENCY_SUB_BUCKETS;
+	int shift = index/(LATENCY_SUB_BUCKETS/2) + 1;
+	osc::int64 sub_bucket = index%(LATENCY_SUB_BUCKETS/2) + LATENCY_SUB_BUCKETS/2;
+	return ((sub_bucket+1)<<shift) - 1;
+}
+
+void LatencyHistogram::record(osc::int64 value) {
+
+	if (value<0) value = 0;
+	LATENCY_ADD(&counts[getBucket(value)], 1);
+	LATENCY_ADD(&total_count, 1);
+	LATENCY_ADD(&total_sum, value);
+
+	osc::int64 current = min_value;
+	while (((current<0) || (value<current)) && !LATENCY_CAS(&min_value, current, value)) current = min_value;
+	current = max_value;
+	while ((value>current) && !LATENCY_CAS(&max_value, current, value)) current = max_value;
+}
+
+osc::int64 LatencyHistogram::getCount() const {
+	return total_count;
+}
+
+osc::int64 LatencyHistogram::getMin() const {
+	return (min_value<0) ? 0 : min_value;
+}
+
+osc::int64 LatencyHistogram::getMax() const {
+	return max_value;
+}
+
+double LatencyHistogram::getMean() const {
+	osc::int64 count = total_count;
+	if (count==0) return 0.0;
+	return (double)total_sum/(double)count;
+}
+
+osc::int64 LatencyHistogram::getPercentile(double percentile) const {
+
+	osc::int64 count = 0;
+	for (int i=0;i<LATENCY_BUCKETS;i++) count += counts[i];
+	if (count==0) return 0;
+
+	if (percentile<0.0) percentile = 0.0;
+	else if (percentile>100.0) percentile = 100.0;
+	osc::int64 rank = (osc::int64)(percentile/100.0*(double)count + 0.5);
+	if (rank<1) rank = 1;
+
+	osc::int64 sum = 0;
+	for (int i=0;i<LATENCY_BUCKETS;i++) {
+		sum += counts[i];
+		if (sum>=rank) {
+			osc::int64 limit = getBucketLimit(i);
+			return (limit<max_value) ? limit : max_value;
+		}
+	}
+	return max_value;
+}
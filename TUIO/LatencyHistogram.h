@@ -0,0 +1,117 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_LATENCYHISTOGRAM_H
+#define INCLUDED_LATENCYHISTOGRAM_H
+
+#include "LibExport.h"
+#include "osc/OscTypes.h"
+
+/*
+ The histogram uses a log-linear bucket layout: values below LATENCY_SUB_BUCKETS
+ nanoseconds are counted exactly, each following power of two is divided into
+ LATENCY_SUB_BUCKETS/2 linear buckets, which keeps the relative error below 1.6%.
+ Values above 2^LATENCY_MAX_EXPONENT nanoseconds (about 18 minutes) are clamped.
+*/
+
+#define LATENCY_SUB_BITS 7
+#define LATENCY_SUB_BUCKETS (1<<LATENCY_SUB_BITS)
+#define LATENCY_MAX_EXPONENT 40
+#define LATENCY_BUCKETS (LATENCY_SUB_BUCKETS+(LATENCY_MAX_EXPONENT-LATENCY_SUB_BITS+1)*(LATENCY_SUB_BUCKETS/2))
+
+namespace TUIO {
+
+	/**
+	 * The LatencyHistogram records nanosecond latencies into fixed log-linear buckets.
+	 * Recording is lock-free and can be done from any thread, while the statistics
+	 * can be queried concurrently without stopping the recording threads.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL LatencyHistogram {
+
+	public:
+
+		/**
+		 * The default constructor creates an empty histogram
+		 */
+		LatencyHistogram();
+
+		/**
+		 * Adds the provided latency to the histogram, negative values are counted as zero
+		 *
+		 * @param  value  the latency in nanoseconds
+		 */
+		void record(osc::int64 value);
+
+		/**
+		 * Removes all recorded values from the histogram
+		 */
+		void reset();
+
+		/**
+		 * Returns the number of recorded values
+		 *
+		 * @return the number of recorded values
+		 */
+		osc::int64 getCount() const;
+
+		/**
+		 * Returns the smallest recorded value
+		 *
+		 * @return the smallest latency in nanoseconds, or 0 if the histogram is empty
+		 */
+		osc::int64 getMin() const;
+
+		/**
+		 * Returns the largest recorded value
+		 *
+		 * @return the largest latency in nanoseconds
+		 */
+		osc::int64 getMax() const;
+
+		/**
+		 * Returns the mean of all recorded values
+		 *
+		 * @return the mean latency in nanoseconds
+		 */
+		double getMean() const;
+
+		/**
+		 * Returns the value below which the provided percentage of all recorded values falls.
+		 * The result is the upper bound of the corresponding bucket.
+		 *
+		 * @param  percentile  the percentile between 0 and 100
+		 * @return the latency percentile in nanoseconds
+		 */
+		osc::int64 getPercentile(double percentile) const;
+
+	private:
+
+		static int getBucket(osc::int64 value);
+		static osc::int64 getBucketLimit(int bucket);
+
+		volatile osc::int64 counts[LATENCY_BUCKETS];
+		volatile osc::int64 total_count;
+		volatile osc::int64 total_sum;
+		volatile osc::int64 min_value;
+		volatile osc::int64 max_value;
+	};
+}
+#endif /* INCLUDED_LATENCYHISTOGRAM_H */
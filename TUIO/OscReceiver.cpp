@@ -23,7 +23,7 @@ using namespace osc;
 
 void OscReceiver::ProcessMessage( const ReceivedMessage& msg, const IpEndpointName& remoteEndpoint) {
 	for (std::list<TuioClient*>::iterator client=clientList.begin(); client!= clientList.end(); client++)
-		(*client)->processOSC(msg);
+		if (!(*client)->isJitterBufferEnabled()) (*client)->processOSC(msg);
 }
 void OscReceiver::ProcessBundle( const ReceivedBundle& b, const IpEndpointName& remoteEndpoint) {
 	
@@ -41,10 +41,36 @@ void OscReceiver::ProcessBundle( const ReceivedBundle& b, const IpEndpointName&
 }
 
 void OscReceiver::ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint ) {
+	ProcessPacket( data, size, remoteEndpoint, 0 );
+}
+
+void OscReceiver::ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint, osc::int64 receiveTime ) {
+	for (std::list<PacketListener*>::iterator tap=tapList.begin(); tap!= tapList.end(); tap++)
+		(*tap)->ProcessPacket(data, size, remoteEndpoint, receiveTime);
+
+	// clients with a jitter buffer process their copy of the packet later
+	bool direct = false;
+	for (std::list<TuioClient*>::iterator client=clientList.begin(); client!= clientList.end(); client++) {
+		if ((*client)->bufferPacket(data, size, remoteEndpoint, receiveTime)) continue;
+		(*client)->setReceiveTime(receiveTime);
+		(*client)->setRemoteEndpoint(remoteEndpoint);
+		direct = true;
+	}
+	if (!direct) return;
+
 	try {
 		ReceivedPacket p( data, size );
-		if(p.IsBundle()) ProcessBundle( ReceivedBundle(p), remoteEndpoint);
-		else ProcessMessage( ReceivedMessage(p), remoteEndpoint);
+		if(p.IsBundle()) {
+			ReceivedBundle b(p);
+			for (std::list<TuioClient*>::iterator client=clientList.begin(); client!= clientList.end(); client++)
+				if (!(*client)->isJitterBufferEnabled()) (*client)->setTimeTag(b.TimeTag());
+			ProcessBundle( b, remoteEndpoint);
+		} else {
+			// a single message carries no time tag, which is treated like an immediate bundle
+			for (std::list<TuioClient*>::iterator client=clientList.begin(); client!= clientList.end(); client++)
+				if (!(*client)->isJitterBufferEnabled()) (*client)->setTimeTag(1);
+			ProcessMessage( ReceivedMessage(p), remoteEndpoint);
+		}
 	} catch (MalformedBundleException& e) {
 		std::cerr << "malformed OSC bundle: " << e.what() << std::endl;
 	}
@@ -58,3 +84,11 @@ void OscReceiver::addTuioClient(TuioClient *client) {
 	clientList.push_back(client);
 }
 
+void OscReceiver::addPacketTap(PacketListener *tap) {
+	tapList.push_back(tap);
+}
+
+void OscReceiver::removePacketTap(PacketListener *tap) {
+	tapList.remove(tap);
+}
+
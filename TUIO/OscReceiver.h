@@ -75,6 +75,21 @@ namespace TUIO {
 		 * @param  client	a pointer to the TuioClient to attach
 		 */
 		void addTuioClient(TuioClient *client);
+
+		/**
+		 * Attaches a PacketListener such as the TuioRecorder, which receives every OSC packet
+		 * along with its receive time before the attached TuioClients process it
+		 *
+		 * @param  tap	a pointer to the PacketListener to attach
+		 */
+		void addPacketTap(PacketListener *tap);
+
+		/**
+		 * Detaches the provided PacketListener
+		 *
+		 * @param  tap	a pointer to the PacketListener to detach
+		 */
+		void removePacketTap(PacketListener *tap);
 		
 		/**
 		 * The OSC callback method where the incoming OSC data is received
@@ -84,6 +99,28 @@ namespace TUIO {
 		 * @param  remoteEndpoint	the origin of the received OSC data 
 		 */
 		void ProcessPacket( const char *data, int size, const IpEndpointName &remoteEndpoint );
+
+		/**
+		 * The OSC callback method where the incoming OSC data is received along with its kernel receive time,
+		 * which is passed on to the attached TuioClients for their latency statistics
+		 *
+		 * @param  data		the received OSC data
+		 * @param  size		the size of the received OSC data
+		 * @param  remoteEndpoint	the origin of the received OSC data 
+		 * @param  receiveTime	the kernel receive time in nanoseconds since the epoch, or 0 if unknown
+		 */
+		virtual void ProcessPacket( const char *data, int size, const IpEndpointName &remoteEndpoint, osc::int64 receiveTime );
+
+		/**
+		 * Sends the provided OSC packet back to the origin of a received packet,
+		 * which is used by the attached TuioClients for the clock synchronization
+		 *
+		 * @param  data		the OSC data to send
+		 * @param  size		the size of the OSC data
+		 * @param  remoteEndpoint	the origin of the received OSC data
+		 * @return true if this transport supports replies and the packet was sent
+		 */
+		virtual bool replyPacket( const char *data, int size, const IpEndpointName &remoteEndpoint ) { return false; };
 		
 	protected:
 		void ProcessBundle( const osc::ReceivedBundle& b, const IpEndpointName& remoteEndpoint);
@@ -91,6 +128,7 @@ namespace TUIO {
 		void ProcessMessage( const osc::ReceivedMessage& message, const IpEndpointName& remoteEndpoint);
 		
 		std::list<TuioClient*> clientList;
+		std::list<PacketListener*> tapList;
 		bool connected;
 	};
 };
@@ -25,6 +25,8 @@
 #include "ip/NetworkingUtils.h"
 #include <iostream>
 #include <cstring>
+#include <string>
+#include <vector>
 
 namespace TUIO {
 	
@@ -55,6 +57,15 @@ namespace TUIO {
 		 * @return true if the data was delivered successfully
 		 */
 		virtual bool sendOscPacket (osc::OutboundPacketStream *bundle) = 0;
+
+		/**
+		 * This method delivers an already encoded OSC packet, such as a recorded bundle
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @return true if the data was delivered successfully, or false if this transport does not support it
+		 */
+		virtual bool sendOscData (const char *data, unsigned int size) { return false; };
 		
 		/**
 		 * This method returns the connection state
@@ -76,6 +87,37 @@ namespace TUIO {
 		 * @return the maximum bundle size in bytes
 		 */
 		int getBufferSize () { return buffer_size; };
+
+		/**
+		 * This method answers the pending clock synchronization requests of the receivers,
+		 * it is called with every frame by the TuioServer if time tags are enabled.
+		 * Transports that answer these requests on their own thread do not need to implement it.
+		 */
+		virtual void answerPings () {};
+
+		/**
+		 * This method marks the cached keyframe as outdated, it is called by the TuioServer
+		 * whenever the scene changed, and once when the OscSender is added to the TuioServer.
+		 * Transports with individual client connections then hold back all packets for a new client
+		 * until its keyframe has been delivered, all other transports do not need to implement it.
+		 */
+		virtual void invalidateKeyframe () {};
+
+		/**
+		 * This method returns true if a client is waiting for a keyframe that has not been encoded yet,
+		 * it is called by the TuioServer after each frame, which then encodes the keyframe on demand.
+		 *
+		 * @return true if a new keyframe is required
+		 */
+		virtual bool requestsKeyframe () { return false; };
+
+		/**
+		 * This method caches the provided keyframe and delivers it to all waiting clients.
+		 * A keyframe consists of the already encoded OSC packets, which describe the full state of all profiles.
+		 *
+		 * @param  packets  the encoded keyframe packets
+		 */
+		virtual void setKeyframe (const std::vector<std::string> &packets) {};
 	
 		virtual const char* tuio_type() = 0;
 		
@@ -0,0 +1,166 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_PACKEDPROFILE_H
+#define INCLUDED_PACKEDPROFILE_H
+
+#include "osc/OscTypes.h"
+#include <cstring>
+
+/*
+ The packed profile replaces the individual "set" messages of a bundle with a single
+ /tuio/[profile] "pset" [format] [blob] message. The blob contains a contiguous array
+ of fixed-size records in network byte order, which carry the same attributes as
+ the corresponding "set" message:
+
+ 2Dcur: s_id x y X Y m
+ 2Dobj: s_id i x y a X Y A m r
+ 2Dblb: s_id x y a w h f X Y A m r
+
+ With the PACKED_FIXED16 format the x and y positions are encoded as unsigned
+ 16bit fixed-point values, saving four bytes per record.
+
+ The quantized profile keeps the regular "set" messages, but combines pairs of
+ 16bit fixed-point values into single int32 arguments (high word first).
+ It is identified by its distinct type-tag layout:
+
+ 2Dcur: s_id (x|y) (X|Y) m
+ 2Dobj: s_id i (x|y) (a|A) (X|Y) m r
+ 2Dblb: s_id (x|y) (a|A) (w|h) (X|Y) f m r
+
+ Positions and sizes are unsigned fractions of the unit range, angles are unsigned
+ fractions of a full turn and speeds are signed fractions of QUANTIZED_SPEED_RANGE.
+ Values are rounded to the configured number of significant bits before they are
+ scaled to 16bit, therefore the receiver never needs to know the quantization level.
+*/
+
+#define PACKED_FLOAT32 0
+#define PACKED_FIXED16 1
+
+#define PACKED_CUR_RECORD_SIZE 24
+#define PACKED_OBJ_RECORD_SIZE 40
+#define PACKED_BLB_RECORD_SIZE 48
+#define PACKED_FIXED16_SAVING 4
+
+// size prefix, address, type tags, "pset", format and blob length of the message, plus the blob padding
+#define PACKED_MESSAGE_OVERHEAD 44
+
+#define QUANTIZED_CUR_TYPETAGS "siiif"
+#define QUANTIZED_OBJ_TYPETAGS "siiiiiff"
+#define QUANTIZED_BLB_TYPETAGS "siiiiifff"
+#define QUANTIZED_SPEED_RANGE 16.0f
+#define QUANTIZED_TWO_PI 6.28318530718f
+
+namespace TUIO {
+
+	inline char* packInt32(char *dst, osc::int32 value) {
+		dst[0] = (char)((value>>24) & 255);
+		dst[1] = (char)((value>>16) & 255);
+		dst[2] = (char)((value>>8) & 255);
+		dst[3] = (char)(value & 255);
+		return dst+4;
+	}
+
+	inline char* packFloat32(char *dst, float value) {
+		osc::int32 bits;
+		memcpy(&bits, &value, 4);
+		return packInt32(dst, bits);
+	}
+
+	inline char* packFixed16(char *dst, float value) {
+		if (value<0.0f) value = 0.0f;
+		else if (value>1.0f) value = 1.0f;
+		unsigned int fixed = (unsigned int)(value*65535.0f+0.5f);
+		dst[0] = (char)((fixed>>8) & 255);
+		dst[1] = (char)(fixed & 255);
+		return dst+2;
+	}
+
+	inline const char* unpackInt32(const char *src, osc::int32 &value) {
+		const unsigned char *u = (const unsigned char*)src;
+		value = (osc::int32)(((osc::uint32)u[0]<<24) | ((osc::uint32)u[1]<<16) | ((osc::uint32)u[2]<<8) | (osc::uint32)u[3]);
+		return src+4;
+	}
+
+	inline const char* unpackFloat32(const char *src, float &value) {
+		osc::int32 bits;
+		src = unpackInt32(src, bits);
+		memcpy(&value, &bits, 4);
+		return src;
+	}
+
+	inline const char* unpackFixed16(const char *src, float &value) {
+		const unsigned char *u = (const unsigned char*)src;
+		value = (float)(((unsigned int)u[0]<<8) | (unsigned int)u[1]) / 65535.0f;
+		return src+2;
+	}
+
+	inline osc::uint32 quantizeUnit(float value, int bits) {
+		if (value<0.0f) value = 0.0f;
+		else if (value>1.0f) value = 1.0f;
+		float levels = (float)((1<<bits)-1);
+		float q = (float)(int)(value*levels+0.5f);
+		return (osc::uint32)(q/levels*65535.0f+0.5f);
+	}
+
+	inline float dequantizeUnit(osc::uint32 q) {
+		return (float)(q & 0xFFFF) / 65535.0f;
+	}
+
+	inline osc::uint32 quantizeAngle(float angle, int bits) {
+		float turn = angle/QUANTIZED_TWO_PI;
+		turn -= (float)(int)turn;
+		if (turn<0.0f) turn += 1.0f;
+		osc::uint32 q = (osc::uint32)(turn*(float)(1<<bits)+0.5f) & ((1<<bits)-1);
+		return q << (16-bits);
+	}
+
+	inline float dequantizeAngle(osc::uint32 q) {
+		return (float)(q & 0xFFFF) / 65536.0f * QUANTIZED_TWO_PI;
+	}
+
+	inline osc::uint32 quantizeSpeed(float speed, int bits) {
+		float value = speed/QUANTIZED_SPEED_RANGE;
+		if (value<-1.0f) value = -1.0f;
+		else if (value>1.0f) value = 1.0f;
+		float levels = (float)((1<<(bits-1))-1);
+		float q = value*levels;
+		q = (float)(int)(q<0.0f ? q-0.5f : q+0.5f);
+		q = q/levels*32767.0f;
+		return (osc::uint32)(osc::int32)(q<0.0f ? q-0.5f : q+0.5f) & 0xFFFF;
+	}
+
+	inline float dequantizeSpeed(osc::uint32 q) {
+		osc::int32 value = (osc::int32)(q & 0xFFFF);
+		if (value>32767) value -= 65536;
+		return (float)value / 32767.0f * QUANTIZED_SPEED_RANGE;
+	}
+
+	inline osc::int32 packQuantized(osc::uint32 high, osc::uint32 low) {
+		return (osc::int32)(((high & 0xFFFF)<<16) | (low & 0xFFFF));
+	}
+
+	inline osc::uint32 quantizedHigh(osc::int32 value) {
+		return ((osc::uint32)value>>16) & 0xFFFF;
+	}
+
+	inline osc::uint32 quantizedLow(osc::int32 value) {
+		return (osc::uint32)value & 0xFFFF;
+	}
+}
+#endif /* INCLUDED_PACKEDPROFILE_H */
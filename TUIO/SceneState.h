@@ -0,0 +1,114 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_SCENESTATE_H
+#define INCLUDED_SCENESTATE_H
+
+#include "ShmRing.h"
+
+/*
+ The scene state is a shared-memory segment that always holds the latest frame of a
+ single TUIO source as fixed-size records in native byte order. The segment starts
+ with a SceneHeader, followed by the cursor, object and blob arrays, whose capacities
+ are defined in the header:
+
+ segment:  header[128] cursors[max_cursors*32] objects[max_objects*48] blobs[max_blobs*56]
+
+ The publisher protects each frame with a seqlock: it increments the sequence to an odd
+ value, writes the counts and records, and increments the sequence to an even value
+ again. A reader copies the counts and records and accepts this snapshot only if the
+ sequence was even and unchanged before and after the copy, otherwise it simply tries
+ again. Readers therefore never block the publisher and do not need to write into the segment.
+*/
+
+#define TUIO_SCENE_NAME "/tuio_scene"
+#define TUIO_SCENE_MAGIC 0x54534353
+#define TUIO_SCENE_VERSION 1
+#define TUIO_SCENE_MAX 1024
+#define TUIO_SCENE_HEADER_SIZE 128
+#define TUIO_SCENE_RETRIES 1000
+#define TUIO_SCENE_SPINS 16
+
+namespace TUIO {
+
+	struct SceneHeader {
+		osc::uint32 magic;
+		osc::uint32 version;
+		osc::uint32 max_cursors;
+		osc::uint32 max_objects;
+		osc::uint32 max_blobs;
+		volatile osc::uint32 closed;
+		char pad0[40];
+		// the fields below are only valid within a consistent snapshot
+		volatile osc::uint32 sequence;
+		osc::uint32 cursor_count;
+		osc::uint32 object_count;
+		osc::uint32 blob_count;
+		osc::int32 frame_id;
+		osc::uint32 truncated;
+		osc::int64 frame_time;
+		osc::int64 publish_time;
+		char pad1[24];
+	};
+
+	struct SceneCursor {
+		osc::int32 session_id;
+		osc::int32 cursor_id;
+		float x, y;
+		float x_speed, y_speed;
+		float motion_accel;
+		osc::int32 state;
+	};
+
+	struct SceneObject {
+		osc::int32 session_id;
+		osc::int32 symbol_id;
+		float x, y, angle;
+		float x_speed, y_speed, rotation_speed;
+		float motion_accel, rotation_accel;
+		osc::int32 state;
+		osc::int32 reserved;
+	};
+
+	struct SceneBlob {
+		osc::int32 session_id;
+		osc::int32 blob_id;
+		float x, y, angle;
+		float width, height, area;
+		float x_speed, y_speed, rotation_speed;
+		float motion_accel, rotation_accel;
+		osc::int32 state;
+	};
+
+	inline unsigned int sceneSegmentSize(unsigned int max_cursors, unsigned int max_objects, unsigned int max_blobs) {
+		return TUIO_SCENE_HEADER_SIZE + max_cursors*sizeof(SceneCursor) + max_objects*sizeof(SceneObject) + max_blobs*sizeof(SceneBlob);
+	}
+
+	inline SceneCursor* sceneCursors(SceneHeader *header) {
+		return (SceneCursor*)((char*)header + TUIO_SCENE_HEADER_SIZE);
+	}
+
+	inline SceneObject* sceneObjects(SceneHeader *header) {
+		return (SceneObject*)((char*)sceneCursors(header) + header->max_cursors*sizeof(SceneCursor));
+	}
+
+	inline SceneBlob* sceneBlobs(SceneHeader *header) {
+		return (SceneBlob*)((char*)sceneObjects(header) + header->max_objects*sizeof(SceneObject));
+	}
+}
+#endif /* INCLUDED_SCENESTATE_H */
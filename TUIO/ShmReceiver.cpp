@@ -0,0 +1,231 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "ShmReceiver.h"
+#include <cstdio>
+#include <cstring>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+using namespace TUIO;
+
+#ifndef  WIN32
+static void* ReceiverThreadFunc( void* obj )
+#else
+static DWORD WINAPI ReceiverThreadFunc( LPVOID obj )
+#endif
+{
+	ShmReceiver *receiver = static_cast<ShmReceiver*>(obj);
+	receiver->runReceiver();
+	return 0;
+};
+
+ShmReceiver::ShmReceiver(const char *shm_name)
+: header	(NULL)
+, ring		(NULL)
+, mapping_size	(0)
+, read_pos	(0)
+, overrun_count	(0)
+, buffer	(NULL)
+, buffer_size	(0)
+, running	(false)
+, receiver_thread	(0)
+, locked	(false)
+{
+	snprintf(name, sizeof(name), "%s", shm_name);
+#ifdef WIN32
+	mapping_handle = NULL;
+#endif
+	std::cout << "listening to TUIO/SHM messages on " << name << std::endl;
+}
+
+ShmReceiver::~ShmReceiver() {
+	disconnect();
+	delete[] buffer;
+}
+
+bool ShmReceiver::attach() {
+
+	void *mapping = NULL;
+#ifdef WIN32
+	char mapping_name[80];
+	snprintf(mapping_name, sizeof(mapping_name), "Local\\%s", (name[0]=='/') ? name+1 : name);
+	mapping_handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, mapping_name);
+	if (mapping_handle==NULL) return false;
+	mapping = MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	if (mapping!=NULL) {
+		MEMORY_BASIC_INFORMATION info;
+		VirtualQuery(mapping, &info, sizeof(info));
+		mapping_size = (unsigned int)info.RegionSize;
+	}
+#else
+	int fd = shm_open(name, O_RDWR, 0666);
+	if (fd<0) return false;
+	struct stat info;
+	if ((fstat(fd, &info)==0) && (info.st_size>TUIO_SHM_HEADER_SIZE)) {
+		mapping_size = (unsigned int)info.st_size;
+		mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (mapping==MAP_FAILED) mapping = NULL;
+	}
+	::close(fd);
+#endif
+
+	if (mapping==NULL) {
+		detach();
+		return false;
+	}
+
+	header = (ShmRingHeader*)mapping;
+	ring = (char*)mapping + TUIO_SHM_HEADER_SIZE;
+	if ((header->magic!=TUIO_SHM_MAGIC) || (header->version!=TUIO_SHM_VERSION) || (header->closed) || (TUIO_SHM_HEADER_SIZE+header->capacity>mapping_size)) {
+		detach();
+		return false;
+	}
+
+	// packets are copied out of the ring before processing, and can use up to a quarter of its capacity
+	if (buffer_size<header->capacity/4) {
+		delete[] buffer;
+		buffer_size = header->capacity/4;
+		buffer = new char[buffer_size];
+	}
+
+	// a new receiver starts with the next packet
+	read_pos = header->write_pos;
+	return true;
+}
+
+void ShmReceiver::detach() {
+#ifdef WIN32
+	if (header!=NULL) UnmapViewOfFile(header);
+	if (mapping_handle!=NULL) CloseHandle(mapping_handle);
+	mapping_handle = NULL;
+#else
+	if (header!=NULL) munmap(header, mapping_size);
+#endif
+	header = NULL;
+	ring = NULL;
+}
+
+void ShmReceiver::runReceiver() {
+
+	IpEndpointName endpoint;
+	while (running) {
+
+		if (header==NULL) {
+			if (!attach()) {
+#ifdef WIN32
+				Sleep(TUIO_SHM_TIMEOUT);
+#else
+				usleep(TUIO_SHM_TIMEOUT*1000);
+#endif
+				continue;
+			}
+		} else if (header->closed) {
+			detach();
+			continue;
+		}
+
+		osc::int32 seen = header->notify;
+		SHM_BARRIER();
+		osc::uint64 write_pos = header->write_pos;
+		if (read_pos==write_pos) {
+			shmWait(header, seen, TUIO_SHM_TIMEOUT);
+			continue;
+		}
+
+		unsigned int capacity = header->capacity;
+		while (running && (read_pos<write_pos)) {
+
+			unsigned int offset = (unsigned int)(read_pos & (capacity-1));
+			const char *record = ring+offset;
+			osc::uint32 size = *(const osc::uint32*)record;
+			osc::uint32 type = *(const osc::uint32*)(record+4);
+			osc::int64 time = *(const osc::int64*)(record+8);
+			SHM_BARRIER();
+
+			// records further behind than half the capacity may already be overwritten
+			if (header->write_pos-read_pos>capacity/2) {
+				overrun_count++;
+				read_pos = header->write_pos;
+				break;
+			}
+
+			if (type==TUIO_SHM_WRAP) {
+				read_pos += capacity-offset;
+				continue;
+			} else if ((type!=TUIO_SHM_PACKET) || (shmRecordSize(size)>capacity/4)) {
+				overrun_count++;
+				read_pos = header->write_pos;
+				break;
+			}
+
+			// the packet is copied out of the ring and dropped if the sender overtook it meanwhile
+			memcpy(buffer, record+TUIO_SHM_RECORD_SIZE, size);
+			SHM_BARRIER();
+			if (header->write_pos-read_pos>capacity/2) {
+				overrun_count++;
+				read_pos = header->write_pos;
+				break;
+			}
+
+			read_pos += shmRecordSize(size);
+			ProcessPacket(buffer, (int)size, endpoint, time);
+		}
+	}
+
+	detach();
+}
+
+void ShmReceiver::connect(bool lk) {
+
+	if (connected) return;
+	locked = lk;
+
+	running = true;
+	connected = true;
+
+	if (!locked) {
+#ifndef WIN32
+		pthread_create(&receiver_thread , NULL, ReceiverThreadFunc, this);
+#else
+		receiver_thread = CreateThread( 0, 0, ReceiverThreadFunc, this, 0, &ReceiverThreadId );
+#endif
+	} else runReceiver();
+}
+
+void ShmReceiver::disconnect() {
+
+	if (!connected) return;
+	running = false;
+
+	if (!locked) {
+#ifdef WIN32
+		WaitForSingleObject(receiver_thread, INFINITE);
+		if( receiver_thread ) CloseHandle( receiver_thread );
+#else
+		pthread_join(receiver_thread, NULL);
+#endif
+		receiver_thread = 0;
+	} else locked = false;
+
+	connected = false;
+}
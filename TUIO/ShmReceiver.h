@@ -0,0 +1,108 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_SHMRECEIVER_H
+#define INCLUDED_SHMRECEIVER_H
+
+#include "OscReceiver.h"
+#include "ShmRing.h"
+
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
+namespace TUIO {
+
+	/**
+	 * The ShmReceiver provides the OscReceiver functionality for the shared-memory transport method of the ShmSender.
+	 * It copies each packet out of the shared ring buffer before processing it, and waits for new packets without polling on Linux.
+	 * The packets are not read in place, since the sender never waits for its receivers and may overwrite a packet
+	 * while a slow client still parses it. The copy costs a single memcpy of at most a quarter of the ring capacity,
+	 * which is not measurable against the packet processing, while a slow or crashed receiver can never stall the sender.
+	 * The receiver can be started before the sender, and attaches again when the sender is restarted.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL ShmReceiver: public OscReceiver {
+
+	public:
+
+		/**
+		 * This constructor creates a ShmReceiver for the provided shared-memory segment
+		 *
+		 * @param  name  the shared-memory segment name, defaults to "/tuio"
+		 */
+		ShmReceiver (const char *name=TUIO_SHM_NAME);
+
+		/**
+		 * The destructor disconnects the ShmReceiver
+		 */
+		virtual ~ShmReceiver();
+
+		/**
+		 * The ShmReceiver connects and starts receiving TUIO messages from the shared-memory segment
+		 *
+		 * @param  lock  running in the background if set to false (default)
+		 */
+		void connect(bool lock=false);
+
+		/**
+		 * The ShmReceiver disconnects and stops receiving TUIO messages
+		 */
+		void disconnect();
+
+		/**
+		 * Returns the number of times this receiver fell too far behind the sender and skipped the overwritten packets
+		 *
+		 * @return the number of overruns
+		 */
+		long getOverrunCount() { return overrun_count; };
+
+		/**
+		 * This method runs the receive loop until the ShmReceiver is disconnected,
+		 * it is only public to be accessible from the thread function
+		 */
+		void runReceiver();
+
+	private:
+		bool attach();
+		void detach();
+
+		ShmRingHeader *header;
+		char *ring;
+		unsigned int mapping_size;
+		osc::uint64 read_pos;
+		long overrun_count;
+		char *buffer;
+		unsigned int buffer_size;
+		char name[64];
+		volatile bool running;
+
+#ifndef WIN32
+		pthread_t receiver_thread;
+#else
+		HANDLE mapping_handle;
+		HANDLE receiver_thread;
+		DWORD ReceiverThreadId;
+#endif
+
+		bool locked;
+	};
+}
+#endif /* INCLUDED_SHMRECEIVER_H */
@@ -0,0 +1,130 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_SHMRING_H
+#define INCLUDED_SHMRING_H
+
+#include "osc/OscTypes.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#endif
+#endif
+
+/*
+ The shared-memory transport is a single-producer/multi-consumer ring of OSC packets.
+ The segment starts with a ShmRingHeader, followed by the data area of a power-of-two
+ capacity. Each packet is stored as a 16 byte record header and the packet data,
+ padded to 16 bytes, and never wraps around the end of the data area:
+
+ record:  size(uint32) type(uint32) time(int64) data[size] padding
+
+ The producer advances write_pos, the total number of bytes ever written, only after
+ the record is complete. Every consumer keeps its own read position and copies each
+ packet out of the ring. Since a record is limited to a quarter of the capacity, a record
+ stays intact while the consumer lags less than half the capacity behind write_pos,
+ which is checked again after the copy. Otherwise the consumer drops the overwritten
+ packets and skips to the latest one. Sleeping consumers
+ are woken through a futex on Linux, and poll the ring on other platforms.
+*/
+
+#define TUIO_SHM_NAME "/tuio"
+#define TUIO_SHM_MAGIC 0x54534852
+#define TUIO_SHM_VERSION 1
+#define TUIO_SHM_CAPACITY 1048576
+#define TUIO_SHM_MIN_CAPACITY 65536
+#define TUIO_SHM_PACKET_SIZE 65536
+#define TUIO_SHM_HEADER_SIZE 256
+#define TUIO_SHM_RECORD_SIZE 16
+#define TUIO_SHM_PACKET 1
+#define TUIO_SHM_WRAP 2
+#define TUIO_SHM_TIMEOUT 100
+
+#ifdef WIN32
+#define SHM_BARRIER() MemoryBarrier()
+#else
+#define SHM_BARRIER() __sync_synchronize()
+#endif
+
+namespace TUIO {
+
+	struct ShmRingHeader {
+		osc::uint32 magic;
+		osc::uint32 version;
+		osc::uint32 capacity;
+		volatile osc::uint32 closed;
+		char pad0[48];
+		// the producer and the consumers access these fields on separate cache lines
+		volatile osc::uint64 write_pos;
+		char pad1[56];
+		volatile osc::int32 notify;
+		volatile osc::int32 waiters;
+		char pad2[56];
+	};
+
+	inline unsigned int shmRecordSize(unsigned int size) {
+		return TUIO_SHM_RECORD_SIZE + ((size+15) & ~15U);
+	}
+
+	inline void shmIncrement(volatile osc::int32 *value) {
+#ifdef WIN32
+		InterlockedIncrement((volatile LONG*)value);
+#else
+		__sync_fetch_and_add(value, 1);
+#endif
+	}
+
+	inline void shmDecrement(volatile osc::int32 *value) {
+#ifdef WIN32
+		InterlockedDecrement((volatile LONG*)value);
+#else
+		__sync_fetch_and_sub(value, 1);
+#endif
+	}
+
+	/* wakes all consumers that are waiting for the next packet */
+	inline void shmWake(ShmRingHeader *header) {
+		shmIncrement(&header->notify);
+#ifdef __linux__
+		if (header->waiters>0) syscall(SYS_futex, (int*)&header->notify, FUTEX_WAKE, 0x7FFFFFFF, NULL, NULL, 0);
+#endif
+	}
+
+	/* waits until the notify counter differs from the provided value or the timeout expired */
+	inline void shmWait(ShmRingHeader *header, osc::int32 seen, int timeout) {
+#ifdef __linux__
+		struct timespec ts;
+		ts.tv_sec = timeout/1000;
+		ts.tv_nsec = (timeout%1000)*1000000;
+		shmIncrement(&header->waiters);
+		syscall(SYS_futex, (int*)&header->notify, FUTEX_WAIT, seen, &ts, NULL, 0);
+		shmDecrement(&header->waiters);
+#elif defined(WIN32)
+		if (header->notify==seen) Sleep(1);
+#else
+		if (header->notify==seen) usleep(1000);
+#endif
+	}
+}
+#endif /* INCLUDED_SHMRING_H */
@@ -0,0 +1,142 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "ShmSender.h"
+#include "TuioClock.h"
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+using namespace TUIO;
+
+ShmSender::ShmSender(const char *shm_name, unsigned int capacity)
+	:header		(NULL)
+	,ring		(NULL)
+	,mapping_size	(0)
+{
+	local = true;
+	snprintf(name, sizeof(name), "%s", shm_name);
+
+	unsigned int size = TUIO_SHM_MIN_CAPACITY;
+	while (size<capacity) size <<= 1;
+	capacity = size;
+	mapping_size = TUIO_SHM_HEADER_SIZE + capacity;
+	buffer_size = (capacity/8<TUIO_SHM_PACKET_SIZE) ? capacity/8 : TUIO_SHM_PACKET_SIZE;
+
+	void *mapping = NULL;
+#ifdef WIN32
+	char mapping_name[80];
+	snprintf(mapping_name, sizeof(mapping_name), "Local\\%s", (name[0]=='/') ? name+1 : name);
+	mapping_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, mapping_size, mapping_name);
+	if (mapping_handle!=NULL) mapping = MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, mapping_size);
+#else
+	int fd = shm_open(name, O_CREAT | O_RDWR, 0666);
+	if (fd>=0) {
+		struct stat info;
+		if ((fstat(fd, &info)==0) && (info.st_size!=(off_t)mapping_size)) {
+			if (ftruncate(fd, mapping_size)<0) {
+				::close(fd);
+				fd = -1;
+			}
+		}
+	}
+	if (fd>=0) {
+		mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (mapping==MAP_FAILED) mapping = NULL;
+		::close(fd);
+	}
+#endif
+
+	if (mapping==NULL) {
+		std::cout << "could not create TUIO/SHM segment " << name << std::endl;
+		throw std::exception();
+	}
+
+	header = (ShmRingHeader*)mapping;
+	ring = (char*)mapping + TUIO_SHM_HEADER_SIZE;
+
+	// a segment that was left behind by a previous sender is continued
+	if ((header->magic!=TUIO_SHM_MAGIC) || (header->version!=TUIO_SHM_VERSION) || (header->capacity!=capacity)) {
+		memset(header, 0, TUIO_SHM_HEADER_SIZE);
+		header->version = TUIO_SHM_VERSION;
+		header->capacity = capacity;
+		SHM_BARRIER();
+		header->magic = TUIO_SHM_MAGIC;
+	}
+	header->closed = 0;
+	SHM_BARRIER();
+
+	std::cout << "TUIO/SHM messages to " << name << std::endl;
+}
+
+ShmSender::~ShmSender() {
+
+	if (header==NULL) return;
+	header->closed = 1;
+	shmWake(header);
+
+#ifdef WIN32
+	UnmapViewOfFile(header);
+	CloseHandle(mapping_handle);
+#else
+	munmap(header, mapping_size);
+	shm_unlink(name);
+#endif
+}
+
+bool ShmSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
+	if ( bundle->Size() == 0 ) return false;
+	return sendOscData(bundle->Data(), (unsigned int)bundle->Size());
+}
+
+bool ShmSender::sendOscData (const char *data, unsigned int size) {
+
+	if (header==NULL) return false;
+	unsigned int capacity = header->capacity;
+	unsigned int record_size = shmRecordSize(size);
+	if (record_size>capacity/4) return false;
+
+	osc::uint64 pos = header->write_pos;
+	unsigned int offset = (unsigned int)(pos & (capacity-1));
+
+	// records never wrap, the rest of the data area is skipped instead
+	if (capacity-offset<record_size) {
+		char *wrap = ring+offset;
+		*(osc::uint32*)wrap = 0;
+		*(osc::uint32*)(wrap+4) = TUIO_SHM_WRAP;
+		pos += capacity-offset;
+		offset = 0;
+	}
+
+	char *record = ring+offset;
+	*(osc::uint32*)record = size;
+	*(osc::uint32*)(record+4) = TUIO_SHM_PACKET;
+	*(osc::int64*)(record+8) = TuioClock::getSystemTime() - TuioClock::getClockSkew();
+	memcpy(record+TUIO_SHM_RECORD_SIZE, data, size);
+
+	SHM_BARRIER();
+	header->write_pos = pos + record_size;
+	shmWake(header);
+	return true;
+}
@@ -0,0 +1,90 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_SHMSENDER_H
+#define INCLUDED_SHMSENDER_H
+
+#include "OscSender.h"
+#include "ShmRing.h"
+
+namespace TUIO {
+
+	/**
+	 * The ShmSender implements a shared-memory transport method for OSC, which delivers the TUIO bundles
+	 * to any number of ShmReceivers on the same host. Each bundle is written once into a ring buffer,
+	 * which all receivers read in place without any system calls on the data path.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL ShmSender : public OscSender {
+
+	public:
+
+		/**
+		 * This constructor creates a ShmSender with the provided segment name and ring capacity,
+		 * an existing segment of the same capacity is taken over, so that its receivers continue seamlessly
+		 *
+		 * @param  name  the shared-memory segment name, defaults to "/tuio"
+		 * @param  capacity  the ring capacity in bytes, which is rounded up to a power of two
+		 */
+		ShmSender(const char *name=TUIO_SHM_NAME, unsigned int capacity=TUIO_SHM_CAPACITY);
+
+		/**
+		 * The destructor notifies the receivers and removes the shared-memory segment
+		 */
+		virtual ~ShmSender();
+
+		/**
+		 * This method delivers the provided OSC data
+		 *
+		 * @param *bundle  the OSC stream to deliver
+		 * @return true if the data was delivered successfully
+		 */
+		bool sendOscPacket (osc::OutboundPacketStream *bundle);
+
+		/**
+		 * This method delivers an already encoded OSC packet
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @return true if the data was delivered successfully
+		 */
+		bool sendOscData (const char *data, unsigned int size);
+
+		/**
+		 * This method returns the connection state
+		 *
+		 * @return true if the shared-memory segment is mapped
+		 */
+		bool isConnected () { return (header!=NULL); };
+
+		const char* tuio_type() { return "TUIO/SHM"; }
+
+	private:
+		ShmRingHeader *header;
+		char *ring;
+		unsigned int mapping_size;
+		char name[64];
+
+#ifdef WIN32
+		HANDLE mapping_handle;
+#endif
+	};
+}
+#endif /* INCLUDED_SHMSENDER_H */
@@ -0,0 +1,249 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "SocketPoller.h"
+
+#ifndef WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#endif
+
+// without a wakeup channel on Windows, socket changes are picked up after this period
+#define POLLER_WIN32_TIMEOUT 10
+
+using namespace TUIO;
+
+SocketPoller::SocketPoller() {
+#ifdef WIN32
+	socketMutex = CreateMutex(NULL,FALSE,NULL);
+#else
+	if (pipe(wakeup_pipe)<0) {
+		wakeup_pipe[0] = wakeup_pipe[1] = -1;
+	} else {
+		setNonBlocking(wakeup_pipe[0]);
+		setNonBlocking(wakeup_pipe[1]);
+	}
+#ifdef __linux__
+	epoll_fd = epoll_create(POLLER_MAX_EVENTS);
+	if (wakeup_pipe[0]>=0) {
+		struct epoll_event event;
+		event.events = EPOLLIN;
+		event.data.fd = wakeup_pipe[0];
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_pipe[0], &event);
+	}
+#else
+	pthread_mutex_init(&socketMutex,NULL);
+#endif
+#endif
+}
+
+SocketPoller::~SocketPoller() {
+#ifdef WIN32
+	CloseHandle(socketMutex);
+#else
+#ifdef __linux__
+	close(epoll_fd);
+#else
+	pthread_mutex_destroy(&socketMutex);
+#endif
+	if (wakeup_pipe[0]>=0) close(wakeup_pipe[0]);
+	if (wakeup_pipe[1]>=0) close(wakeup_pipe[1]);
+#endif
+}
+
+bool SocketPoller::addSocket(SocketHandle socket, bool writable) {
+#ifdef __linux__
+	struct epoll_event event;
+	event.events = EPOLLIN | (writable ? (uint32_t)EPOLLOUT : (uint32_t)0);
+	event.data.fd = socket;
+	return (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, socket, &event)==0);
+#elif defined(WIN32)
+	WaitForSingleObject(socketMutex, INFINITE);
+	socketList[socket] = writable;
+	ReleaseMutex(socketMutex);
+	return true;
+#else
+	pthread_mutex_lock(&socketMutex);
+	socketList[socket] = writable;
+	pthread_mutex_unlock(&socketMutex);
+	wakeup();
+	return true;
+#endif
+}
+
+void SocketPoller::setWritable(SocketHandle socket, bool writable) {
+#ifdef __linux__
+	struct epoll_event event;
+	event.events = EPOLLIN | (writable ? (uint32_t)EPOLLOUT : (uint32_t)0);
+	event.data.fd = socket;
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, socket, &event);
+#elif defined(WIN32)
+	WaitForSingleObject(socketMutex, INFINITE);
+	std::map<SocketHandle,bool>::iterator iter = socketList.find(socket);
+	if (iter!=socketList.end()) iter->second = writable;
+	ReleaseMutex(socketMutex);
+#else
+	pthread_mutex_lock(&socketMutex);
+	std::map<SocketHandle,bool>::iterator iter = socketList.find(socket);
+	if (iter!=socketList.end()) iter->second = writable;
+	pthread_mutex_unlock(&socketMutex);
+	wakeup();
+#endif
+}
+
+void SocketPoller::removeSocket(SocketHandle socket) {
+#ifdef __linux__
+	struct epoll_event event;
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, socket, &event);
+#elif defined(WIN32)
+	WaitForSingleObject(socketMutex, INFINITE);
+	socketList.erase(socket);
+	ReleaseMutex(socketMutex);
+#else
+	pthread_mutex_lock(&socketMutex);
+	socketList.erase(socket);
+	pthread_mutex_unlock(&socketMutex);
+#endif
+}
+
+int SocketPoller::wait(int timeout) {
+
+	eventList.clear();
+
+#ifdef __linux__
+	int count = epoll_wait(epoll_fd, epoll_events, POLLER_MAX_EVENTS, timeout);
+	for (int i=0;i<count;i++) {
+		if (epoll_events[i].data.fd==wakeup_pipe[0]) {
+			char buf[64];
+			while (read(wakeup_pipe[0], buf, sizeof(buf))>0);
+			continue;
+		}
+
+		PollEvent event;
+		event.socket = epoll_events[i].data.fd;
+		event.readable = (epoll_events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))!=0;
+		event.writable = (epoll_events[i].events & EPOLLOUT)!=0;
+		eventList.push_back(event);
+	}
+#elif defined(WIN32)
+	fd_set read_fds, write_fds;
+	FD_ZERO(&read_fds);
+	FD_ZERO(&write_fds);
+
+	WaitForSingleObject(socketMutex, INFINITE);
+	if (socketList.empty()) {
+		ReleaseMutex(socketMutex);
+		Sleep(POLLER_WIN32_TIMEOUT);
+		return 0;
+	}
+	for (std::map<SocketHandle,bool>::iterator iter = socketList.begin(); iter!=socketList.end(); iter++) {
+		FD_SET(iter->first, &read_fds);
+		if (iter->second) FD_SET(iter->first, &write_fds);
+	}
+	ReleaseMutex(socketMutex);
+
+	if ((timeout<0) || (timeout>POLLER_WIN32_TIMEOUT)) timeout = POLLER_WIN32_TIMEOUT;
+	struct timeval tv;
+	tv.tv_sec = 0;
+	tv.tv_usec = timeout*1000;
+
+	if (select(0, &read_fds, &write_fds, NULL, &tv)<=0) return 0;
+	for (u_int i=0;i<read_fds.fd_count;i++) {
+		PollEvent event;
+		event.socket = read_fds.fd_array[i];
+		event.readable = true;
+		event.writable = (FD_ISSET(event.socket, &write_fds)!=0);
+		eventList.push_back(event);
+	}
+	for (u_int i=0;i<write_fds.fd_count;i++) {
+		if (FD_ISSET(write_fds.fd_array[i], &read_fds)) continue;
+		PollEvent event;
+		event.socket = write_fds.fd_array[i];
+		event.readable = false;
+		event.writable = true;
+		eventList.push_back(event);
+	}
+#else
+	pollList.clear();
+	struct pollfd wake;
+	wake.fd = wakeup_pipe[0];
+	wake.events = POLLIN;
+	wake.revents = 0;
+	pollList.push_back(wake);
+
+	pthread_mutex_lock(&socketMutex);
+	for (std::map<SocketHandle,bool>::iterator iter = socketList.begin(); iter!=socketList.end(); iter++) {
+		struct pollfd entry;
+		entry.fd = iter->first;
+		entry.events = POLLIN | (iter->second ? POLLOUT : 0);
+		entry.revents = 0;
+		pollList.push_back(entry);
+	}
+	pthread_mutex_unlock(&socketMutex);
+
+	if (poll(&pollList[0], pollList.size(), timeout)<=0) return 0;
+	if (pollList[0].revents) {
+		char buf[64];
+		while (read(wakeup_pipe[0], buf, sizeof(buf))>0);
+	}
+
+	for (unsigned int i=1;i<pollList.size();i++) {
+		if (!pollList[i].revents) continue;
+		PollEvent event;
+		event.socket = pollList[i].fd;
+		event.readable = (pollList[i].revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL))!=0;
+		event.writable = (pollList[i].revents & POLLOUT)!=0;
+		eventList.push_back(event);
+	}
+#endif
+
+	return (int)eventList.size();
+}
+
+SocketHandle SocketPoller::getSocket(int index) {
+	return eventList[index].socket;
+}
+
+bool SocketPoller::isReadable(int index) {
+	return eventList[index].readable;
+}
+
+bool SocketPoller::isWritable(int index) {
+	return eventList[index].writable;
+}
+
+void SocketPoller::wakeup() {
+#ifndef WIN32
+	if (wakeup_pipe[1]>=0) {
+		char signal = 1;
+		if (write(wakeup_pipe[1], &signal, 1)<0) return;
+	}
+#endif
+}
+
+bool SocketPoller::setNonBlocking(SocketHandle socket) {
+#ifdef WIN32
+	u_long mode = 1;
+	return (ioctlsocket(socket, FIONBIO, &mode)==0);
+#else
+	int flags = fcntl(socket, F_GETFL, 0);
+	if (flags<0) return false;
+	return (fcntl(socket, F_SETFL, flags | O_NONBLOCK)==0);
+#endif
+}
@@ -0,0 +1,165 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_SOCKETPOLLER_H
+#define INCLUDED_SOCKETPOLLER_H
+
+#include "LibExport.h"
+
+#ifdef WIN32
+#include <winsock.h>
+#else
+#include <pthread.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+#endif
+
+#include <map>
+#include <vector>
+
+#define POLLER_MAX_EVENTS 64
+
+namespace TUIO {
+
+#ifdef WIN32
+	typedef SOCKET SocketHandle;
+#else
+	typedef int SocketHandle;
+#endif
+
+	/**
+	 * The SocketPoller waits for read and write readiness on a set of non-blocking sockets.
+	 * It is based on epoll on Linux, on poll on other POSIX systems and on select on Windows.
+	 * Sockets can be added and modified from any thread, while wait() is called from a single event loop.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL SocketPoller {
+
+	public:
+
+		/**
+		 * The default constructor creates the poller and its wakeup channel
+		 */
+		SocketPoller();
+
+		/**
+		 * The destructor releases the poller, but does not close any registered sockets
+		 */
+		~SocketPoller();
+
+		/**
+		 * Registers the provided socket for read readiness and optionally write readiness
+		 *
+		 * @param  socket  the socket to register
+		 * @param  writable  also report write readiness if set to true
+		 * @return true if the socket was registered
+		 */
+		bool addSocket(SocketHandle socket, bool writable=false);
+
+		/**
+		 * Enables or disables the write readiness notification of a registered socket
+		 *
+		 * @param  socket  the registered socket
+		 * @param  writable  report write readiness if set to true
+		 */
+		void setWritable(SocketHandle socket, bool writable);
+
+		/**
+		 * Removes the provided socket from the poller, this needs to be done before the socket is closed
+		 *
+		 * @param  socket  the registered socket
+		 */
+		void removeSocket(SocketHandle socket);
+
+		/**
+		 * Waits until at least one of the registered sockets is ready, the timeout expired or wakeup() was called
+		 *
+		 * @param  timeout  the maximum waiting time in milliseconds, or -1 to wait indefinitely
+		 * @return the number of ready sockets, which can be accessed by their index
+		 */
+		int wait(int timeout);
+
+		/**
+		 * Returns the socket of the ready event at the provided index
+		 *
+		 * @param  index  the event index
+		 * @return the ready socket
+		 */
+		SocketHandle getSocket(int index);
+
+		/**
+		 * Returns true if the socket at the provided index is readable, or if it was closed or failed
+		 *
+		 * @param  index  the event index
+		 * @return true if the socket is readable
+		 */
+		bool isReadable(int index);
+
+		/**
+		 * Returns true if the socket at the provided index is writable
+		 *
+		 * @param  index  the event index
+		 * @return true if the socket is writable
+		 */
+		bool isWritable(int index);
+
+		/**
+		 * Interrupts a pending wait() call from any other thread
+		 */
+		void wakeup();
+
+		/**
+		 * Switches the provided socket into non-blocking mode
+		 *
+		 * @param  socket  the socket to configure
+		 * @return true if the socket is non-blocking
+		 */
+		static bool setNonBlocking(SocketHandle socket);
+
+	private:
+
+		struct PollEvent {
+			SocketHandle socket;
+			bool readable;
+			bool writable;
+		};
+
+		std::vector<PollEvent> eventList;
+
+#ifdef WIN32
+		std::map<SocketHandle,bool> socketList;
+		HANDLE socketMutex;
+#else
+		int wakeup_pipe[2];
+#ifdef __linux__
+		int epoll_fd;
+		struct epoll_event epoll_events[POLLER_MAX_EVENTS];
+#else
+		std::map<SocketHandle,bool> socketList;
+		std::vector<struct pollfd> pollList;
+		pthread_mutex_t socketMutex;
+#endif
+#endif
+	};
+}
+#endif /* INCLUDED_SOCKETPOLLER_H */
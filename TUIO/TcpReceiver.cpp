@@ -17,6 +17,8 @@
 */
 
 #include "TcpReceiver.h"
+#include "TuioClock.h"
+#include <errno.h>
 
 using namespace TUIO;
 using namespace osc;
@@ -26,51 +28,71 @@ int tcp_connect(int socket, const struct sockaddr *address, socklen_t address_le
 	return connect(socket, address, address_len);
 }
 
-#ifdef WIN32
-static DWORD WINAPI ClientThreadFunc( LPVOID obj )
-#else
-static void* ClientThreadFunc( void* obj )
-#endif
+TcpStream::TcpStream(SocketHandle socket)
+	: socket		(socket)
+	, data_size	(0)
 {
-	TcpReceiver *sender = static_cast<TcpReceiver*>(obj);
-	char data_buffer[MAX_TCP_SIZE+4];
-	char data_size[4];
-	int32_t bundle_size;
+	buffer = new char[TCP_STREAM_BUFFER_SIZE];
+}
 
-#ifdef WIN32
-	SOCKET client = sender->tcp_client_list.back();
-#else
-	int client = sender->tcp_client_list.back();
-#endif
+TcpStream::~TcpStream() {
+	delete[] buffer;
+}
+
+int TcpStream::receive(PacketListener *listener) {
+
+	// the kernel receive time of the latest segment applies to all packets completed by this read
+	osc::int64 receive_time = 0;
+#ifdef SO_TIMESTAMPNS
+	struct iovec vector;
+	vector.iov_base = buffer+data_size;
+	vector.iov_len = TCP_STREAM_BUFFER_SIZE-data_size;
+	char control[64];
+	struct msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_iov = &vector;
+	message.msg_iovlen = 1;
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
 
-	int32_t bytes = 1;
-	while (bytes) {
-		bytes = recv(client, data_buffer, sizeof(data_buffer),0);
-
-		if (bytes>=4) {
-			memcpy(&data_size[0],&data_buffer[0], 4);
-#ifdef OSC_HOST_LITTLE_ENDIAN
-			bundle_size = 0xFF & data_size[3];
-			bundle_size |= (0xFF & data_size[2]) << 8;
-			bundle_size |= (0xFF & data_size[1]) << 16;
-			bundle_size |= (int32_t)(0xFF & data_size[0]) << 24;
+	int bytes = (int)recvmsg(socket, &message, 0);
+	if (bytes<=0) return bytes;
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg!=NULL; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+		if ((cmsg->cmsg_level==SOL_SOCKET) && (cmsg->cmsg_type==SCM_TIMESTAMPNS)) {
+			struct timespec ts;
+			memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+			receive_time = (osc::int64)ts.tv_sec*1000000000 + ts.tv_nsec;
+		}
+	}
 #else
-			bundle_size = (int32_t)(*data_size);
+	int bytes = recv(socket, buffer+data_size, TCP_STREAM_BUFFER_SIZE-data_size, 0);
+	if (bytes<=0) return bytes;
 #endif
-			if (bundle_size+4==bytes) {
-				sender->ProcessPacket(&data_buffer[4],(int)bundle_size,IpEndpointName());
-			}
+	data_size += bytes;
+
+	unsigned int offset = 0;
+	while (data_size-offset>=4) {
+		const unsigned char *header = (const unsigned char*)&buffer[offset];
+		uint32_t bundle_size = ((uint32_t)header[0]<<24) | ((uint32_t)header[1]<<16) | ((uint32_t)header[2]<<8) | (uint32_t)header[3];
+		if (bundle_size>MAX_TCP_SIZE) {
+			std::cerr << "invalid TUIO/TCP packet size: " << bundle_size << std::endl;
+			data_size = 0;
+			return 0;
 		}
-	}
 
-	sender->tcp_client_list.remove(client);
-	std::cout << "closed TUIO/TCP connection" << std::endl;
+		if (data_size-offset-4<bundle_size) break;
+		if (bundle_size>0) listener->ProcessPacket(&buffer[offset+4],(int)bundle_size,IpEndpointName(),receive_time);
+		offset += 4+bundle_size;
+	}
 
-	//if (sender->tcp_client_list.size()==0) sender->connected=false;
-	//std::cout << sender->tcp_client_list.size() << " clients left"<< std::endl;	
+	// carry over the partial packet
+	if (offset>0) {
+		data_size -= offset;
+		if (data_size>0) memmove(buffer, &buffer[offset], data_size);
+	}
 
-	return 0;
-};
+	return bytes;
+}
 
 #ifndef  WIN32
 static void* ServerThreadFunc( void* obj )
@@ -78,40 +100,22 @@ static void* ServerThreadFunc( void* obj )
 static DWORD WINAPI ServerThreadFunc( LPVOID obj )
 #endif
 {
-	TcpReceiver *sender = static_cast<TcpReceiver*>(obj);
-	struct sockaddr_in client_addr;
-	socklen_t len = sizeof(client_addr);
+	TcpReceiver *receiver = static_cast<TcpReceiver*>(obj);
+	receiver->runEventLoop();
+	return 0;
+};
 
-	while ((int)sender->tcp_socket>0) {
 #ifdef WIN32
-		SOCKET tcp_client = -1;
+#define TCP_WOULD_BLOCK (WSAGetLastError()==WSAEWOULDBLOCK)
 #else
-		int tcp_client = -1;
+#define TCP_WOULD_BLOCK ((errno==EAGAIN) || (errno==EWOULDBLOCK) || (errno==EINTR))
 #endif
-		tcp_client = accept(sender->tcp_socket, (struct sockaddr*)&client_addr, &len);
-
-		if (tcp_client>0) { 
-			std::cout << "listening to TUIO/TCP messages from " << inet_ntoa(client_addr.sin_addr) << "@" << client_addr.sin_port << std::endl;
-			sender->tcp_client_list.push_back(tcp_client);
-			//sender->connected=true;
-			//std::cout << sender->tcp_client_list.size() << " clients connected"<< std::endl;	
-			
-#ifndef WIN32
-			pthread_t client_thread;
-			pthread_create(&client_thread , NULL, ClientThreadFunc,obj);
-#else
-			DWORD ClientThreadId;
-			HANDLE client_thread = CreateThread( 0, 0, ClientThreadFunc, obj, 0, &ClientThreadId );
-#endif
-		} else break;
-
-	}
-	
-	return 0;
-};
 
 TcpReceiver::TcpReceiver(int port)
 : tcp_socket	(-1)
+, current_stream	(NULL)
+, listening	(true)
+, running	(false)
 , locked	(false)
 {
 
@@ -143,7 +147,7 @@ TcpReceiver::TcpReceiver(int port)
 		return;
 	}
 	
-	ret =  listen(tcp_socket, 1);
+	ret =  listen(tcp_socket, SOMAXCONN);
 	if (ret < 0) {
 		std::cerr << "could not start listening to TUIO/TCP socket" << std::endl;
 #ifdef WIN32
@@ -160,6 +164,9 @@ TcpReceiver::TcpReceiver(int port)
 
 TcpReceiver::TcpReceiver(const char *host, int port)
 : tcp_socket	(-1)
+, current_stream	(NULL)
+, listening	(false)
+, running	(false)
 , locked		(false)
 {
 
@@ -194,13 +201,120 @@ TcpReceiver::TcpReceiver(const char *host, int port)
 		tcp_socket=-1;
 		return;
 	} else {
-		tcp_client_list.push_back(tcp_socket);
+		addClient(tcp_socket);
 		std::cout << "listening to TUIO/TCP messages from " << host << ":" << port << std::endl;
 	}
 }
 
 TcpReceiver::~TcpReceiver() {	
-	
+	disconnect();
+	for (std::map<SocketHandle,TcpStream*>::iterator iter = tcp_stream_map.begin(); iter!=tcp_stream_map.end(); iter++) {
+		if (iter->first==tcp_socket) tcp_socket = -1;
+		closeClient(iter->second);
+	}
+	tcp_stream_map.clear();
+
+#ifdef WIN32
+	if ((int)tcp_socket>=0) closesocket(tcp_socket);
+#else
+	if (tcp_socket>=0) close(tcp_socket);
+#endif
+}
+
+void TcpReceiver::runEventLoop() {
+
+	while (running) {
+		int events = poller.wait(-1);
+		for (int i=0;i<events;i++) {
+			SocketHandle socket = poller.getSocket(i);
+			if (listening && (socket==tcp_socket)) {
+				acceptClient();
+				continue;
+			}
+
+			std::map<SocketHandle,TcpStream*>::iterator iter = tcp_stream_map.find(socket);
+			if (iter==tcp_stream_map.end()) continue;
+
+			current_stream = iter->second;
+			int bytes = current_stream->receive(this);
+			current_stream = NULL;
+			if ((bytes<0) && TCP_WOULD_BLOCK) continue;
+			if (bytes<=0) {
+				std::cout << "closed TUIO/TCP connection" << std::endl;
+				closeClient(iter->second);
+				tcp_stream_map.erase(iter);
+			}
+		}
+	}
+
+	// close all connections once the loop was stopped
+	for (std::map<SocketHandle,TcpStream*>::iterator iter = tcp_stream_map.begin(); iter!=tcp_stream_map.end(); iter++)
+		closeClient(iter->second);
+	tcp_stream_map.clear();
+	if (listening) {
+		poller.removeSocket(tcp_socket);
+#ifdef WIN32
+		closesocket(tcp_socket);
+#else
+		close(tcp_socket);
+#endif
+	}
+	tcp_socket = -1;
+}
+
+bool TcpReceiver::replyPacket( const char *data, int size, const IpEndpointName& remoteEndpoint ) {
+	if ((current_stream==NULL) || (size<=0)) return false;
+
+	// the small reply is sent in a single write, and dropped if the socket buffer is full
+	char packet[TUIO_PING_SIZE+4];
+	if (size>TUIO_PING_SIZE) return false;
+	packet[0] = (char)((size>>24) & 255);
+	packet[1] = (char)((size>>16) & 255);
+	packet[2] = (char)((size>>8) & 255);
+	packet[3] = (char)(size & 255);
+	memcpy(&packet[4], data, size);
+#ifdef MSG_NOSIGNAL
+	return (send(current_stream->getSocket(), packet, size+4, MSG_NOSIGNAL)==size+4);
+#else
+	return (send(current_stream->getSocket(), packet, size+4, 0)==size+4);
+#endif
+}
+
+void TcpReceiver::acceptClient() {
+
+	struct sockaddr_in client_addr;
+	socklen_t len = sizeof(client_addr);
+
+#ifdef WIN32
+	SOCKET tcp_client = accept(tcp_socket, (struct sockaddr*)&client_addr, &len);
+	if (tcp_client==INVALID_SOCKET) return;
+#else
+	int tcp_client = accept(tcp_socket, (struct sockaddr*)&client_addr, &len);
+	if (tcp_client<0) return;
+#endif
+
+	std::cout << "listening to TUIO/TCP messages from " << inet_ntoa(client_addr.sin_addr) << "@" << client_addr.sin_port << std::endl;
+	addClient(tcp_client);
+}
+
+void TcpReceiver::addClient(SocketHandle tcp_client) {
+	SocketPoller::setNonBlocking(tcp_client);
+#ifdef SO_TIMESTAMPNS
+	int timestamps = 1;
+	setsockopt(tcp_client, SOL_SOCKET, SO_TIMESTAMPNS, &timestamps, sizeof(timestamps));
+#endif
+	tcp_stream_map[tcp_client] = new TcpStream(tcp_client);
+	poller.addSocket(tcp_client);
+}
+
+void TcpReceiver::closeClient(TcpStream *stream) {
+	poller.removeSocket(stream->getSocket());
+#ifdef WIN32
+	closesocket(stream->getSocket());
+#else
+	close(stream->getSocket());
+#endif
+	delete stream;
 }
 
 void TcpReceiver::connect(bool lk) {
@@ -208,54 +322,36 @@ void TcpReceiver::connect(bool lk) {
 	if (connected) return;
 	if ((int)tcp_socket<0) return;
 	locked = lk;
-	
-	if (tcp_client_list.size()>0) {
-		if (!locked) {
-#ifndef WIN32
-			pthread_create(&server_thread , NULL, ClientThreadFunc, this);
-#else
-			server_thread = CreateThread( 0, 0, ClientThreadFunc, this, 0, &ServerThreadId );
-#endif
-		} else ClientThreadFunc(this);		
-	} else {
-		if (!locked) {
+
+	if (listening) poller.addSocket(tcp_socket);
+	running = true;
+	connected = true;
+
+	if (!locked) {
 #ifndef WIN32
-			pthread_create(&server_thread , NULL, ServerThreadFunc, this);
+		pthread_create(&server_thread , NULL, ServerThreadFunc, this);
 #else
-			server_thread = CreateThread( 0, 0, ServerThreadFunc, this, 0, &ServerThreadId );
+		server_thread = CreateThread( 0, 0, ServerThreadFunc, this, 0, &ServerThreadId );
 #endif
-		} else ServerThreadFunc(this);
-	}
-
-	connected = true;
+	} else runEventLoop();
 }
 
 void TcpReceiver::disconnect() {
 	
 	if (!connected) return;
-	if ((int)tcp_socket<0) return;
 
-#ifdef WIN32
-	for (std::list<SOCKET>::iterator client = tcp_client_list.begin(); client!=tcp_client_list.end(); client++)
-		closesocket((*client));
-	closesocket(tcp_socket);
-	if( server_thread ) CloseHandle( server_thread );
-#else
-	for (std::list<int>::iterator client = tcp_client_list.begin(); client!=tcp_client_list.end(); client++)
-		close((*client));
-	close(tcp_socket);
-	server_thread = 0;
-#endif	
-	
-	tcp_client_list.clear();
+	running = false;
+	poller.wakeup();
+
 	if (!locked) {
 #ifdef WIN32
+		WaitForSingleObject(server_thread, INFINITE);
 		if( server_thread ) CloseHandle( server_thread );
+#else
+		pthread_join(server_thread, NULL);
 #endif
 		server_thread = 0;
 	} else locked = false;
 
 	connected = false;
 }
-
-
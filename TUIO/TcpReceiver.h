@@ -20,7 +20,9 @@
 #define INCLUDED_TCPRECEIVER_H
 
 #include "OscReceiver.h"
+#include "SocketPoller.h"
 #define MAX_TCP_SIZE 65536
+#define TCP_STREAM_BUFFER_SIZE (2*(MAX_TCP_SIZE+4))
 
 #ifdef WIN32
 #include <winsock.h>
@@ -36,10 +38,58 @@ typedef int socklen_t;
 #include <unistd.h>
 #endif
 
+#include <map>
+
 namespace TUIO {
+
+	/**
+	 * The TcpStream reassembles the length-prefixed OSC packets of a single TCP connection.
+	 * All complete packets of a read are passed in place to the PacketListener,
+	 * while a trailing partial packet is carried over to the next read.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL TcpStream {
+
+	public:
+
+		/**
+		 * This constructor creates a TcpStream for the provided connected socket
+		 *
+		 * @param  socket  the connected socket
+		 */
+		TcpStream(SocketHandle socket);
+
+		/**
+		 * The destructor releases the stream buffer, but does not close the socket
+		 */
+		~TcpStream();
+
+		/**
+		 * Reads the available data from the socket and processes all complete OSC packets
+		 *
+		 * @param  listener  the PacketListener receiving the OSC packets
+		 * @return the number of bytes read, zero if the connection was closed or the stream is corrupt, or -1 on error
+		 */
+		int receive(PacketListener *listener);
+
+		/**
+		 * Returns the socket of this TcpStream
+		 *
+		 * @return the connected socket
+		 */
+		SocketHandle getSocket() { return socket; };
+
+	private:
+		SocketHandle socket;
+		char *buffer;
+		unsigned int data_size;
+	};
 	
 	/**
 	 * The TcpReceiver provides the OscReceiver functionality for the TCP transport method 
+	 * The listening socket and all incoming connections are served by a single event loop with non-blocking reads.
 	 *
 	 * @author Martin Kaltenbrunner
 	 * @version 1.1.6
@@ -64,7 +114,7 @@ namespace TUIO {
 		TcpReceiver (const char *host, int port);
 		
 		/**
-		 * The destructor is doing nothing in particular. 
+		 * The destructor disconnects the TcpReceiver and closes its sockets
 		 */
 		virtual ~TcpReceiver();
 		
@@ -80,16 +130,41 @@ namespace TUIO {
 		 */
 		void disconnect();
 
+		/**
+		 * This method runs the event loop until the TcpReceiver is disconnected,
+		 * it is only public to be accessible from the thread function
+		 */
+		void runEventLoop();
+
+		/**
+		 * Sends the provided OSC packet to the connection of the packet that is currently processed,
+		 * replies outside of the receive callback are not supported
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @param  remoteEndpoint  the source of the received OSC packet, which is not used
+		 * @return true if the packet was sent
+		 */
+		bool replyPacket( const char *data, int size, const IpEndpointName &remoteEndpoint );
+
 #ifndef WIN32
 		int tcp_socket;
-		std::list<int> tcp_client_list;
 #else
 		SOCKET tcp_socket;
-		std::list<SOCKET> tcp_client_list;
 #endif
 		
 	private:
 
+		void acceptClient();
+		void addClient(SocketHandle tcp_client);
+		void closeClient(TcpStream *stream);
+
+		std::map<SocketHandle,TcpStream*> tcp_stream_map;
+		TcpStream *current_stream;
+		SocketPoller poller;
+		bool listening;
+		bool running;
+
 #ifndef WIN32
 		pthread_t server_thread;
 #else
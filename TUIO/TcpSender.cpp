@@ -17,83 +17,42 @@
 */
 
 #include "TcpSender.h"
+#include "TuioClock.h"
+#include <errno.h>
 using namespace TUIO;
 
 #ifdef  WIN32
-static DWORD WINAPI ClientThreadFunc( LPVOID obj )
+static DWORD WINAPI ServerThreadFunc( LPVOID obj )
 #else
-static void* ClientThreadFunc( void* obj )
+static void* ServerThreadFunc( void* obj )
 #endif
 {
 	TcpSender *sender = static_cast<TcpSender*>(obj);
-	char buf[16];
-			
-#ifdef WIN32
-	SOCKET client = sender->tcp_client_list.back();
-#else
-	int client = sender->tcp_client_list.back();
-#endif
-	
-	size_t connected = 1;
-	while (connected) {
-		connected = recv(client, buf, sizeof(buf),0);
-	}
-		
-	sender->tcp_client_list.remove(client);
-	std::cout << sender->tuio_type() << " connection closed"<< std::endl;
-	if (sender->tcp_client_list.size()==0) sender->connected=false;
-	//std::cout << sender->tcp_client_list.size() << " clients left"<< std::endl;	
-
+	sender->runEventLoop();
 	return 0;
 };
 
-#ifdef  WIN32
-static DWORD WINAPI ServerThreadFunc( LPVOID obj )
-#else
-static void* ServerThreadFunc( void* obj )
-#endif
-{
-	TcpSender *sender = static_cast<TcpSender*>(obj);
-	struct sockaddr_in client_addr;
-	socklen_t len = sizeof(client_addr);
-	
-	std::cout << sender->tuio_type() << " socket created on port " << sender->port_no << std::endl;
-	while (sender->tcp_socket) {
 #ifdef WIN32
-		SOCKET tcp_client = -1;
+#define TCP_WOULD_BLOCK (WSAGetLastError()==WSAEWOULDBLOCK)
 #else
-		int tcp_client = -1;
-#endif
-		
-		tcp_client = accept(sender->tcp_socket, (struct sockaddr*)&client_addr, &len);
-#ifdef WIN32
-		 //win32 workaround on exit
-		if (!client_addr.sin_addr.S_un.S_addr && !client_addr.sin_port) return 0;
-		if ((client_addr.sin_addr.S_un.S_addr==3435973836) && (client_addr.sin_port==52428)) return 0;
+#define TCP_WOULD_BLOCK ((errno==EAGAIN) || (errno==EWOULDBLOCK) || (errno==EINTR))
 #endif
 
-		if (tcp_client>0) { 
-			std::cout << sender->tuio_type() << " client connected from " << inet_ntoa(client_addr.sin_addr) << "@" << client_addr.sin_port << std::endl;
-			sender->tcp_client_list.push_back(tcp_client);
-			sender->connected=true;
-			sender->newClient(tcp_client);
-			//std::cout << sender->tcp_client_list.size() << " clients connected"<< std::endl;	
-#ifdef WIN32
-			DWORD ClientThreadId;
-			HANDLE client_thread = CreateThread( 0, 0, ClientThreadFunc, obj, 0, &ClientThreadId );
-#else
-			pthread_t client_thread;
-			pthread_create(&client_thread , NULL, ClientThreadFunc,obj);
-#endif
-		} else break;
-	}
-	
-	return 0;
-};
-
 TcpSender::TcpSender()
 	:connected (false)
+	,queue_limit (TCP_QUEUE_LIMIT)
+	,slow_policy (TCP_SLOW_CLIENT_DISCONNECT)
+	,handshake (false)
+	,keyframes (false)
+	,keyframe_valid (false)
+	,listening (false)
+	,running (false)
 {
+#ifdef WIN32
+	clientMutex = CreateMutex(NULL,FALSE,NULL);
+#else
+	pthread_mutex_init(&clientMutex,NULL);
+#endif
 	local = true;
 	buffer_size = MAX_TCP_SIZE;
 	
@@ -118,22 +77,27 @@ TcpSender::TcpSender()
 		return;
 	} else {
 		std::cout << tuio_type() << " connection opened to 127.0.0.1:3333" << std::endl;
-		tcp_client_list.push_back(tcp_socket);
-		connected = true;
-		
-#ifdef WIN32
-		HANDLE server_thread = CreateThread( 0, 0, ClientThreadFunc, this, 0, &ServerThreadId );
-#else
-		pthread_create(&server_thread , NULL, ClientThreadFunc,this);
-#endif
-
+		addClient(tcp_socket);
+		startEventLoop(false);
 	}
 
 }
 
 TcpSender::TcpSender(const char *host, int port) 
 	:connected (false)
-{	
+	,queue_limit (TCP_QUEUE_LIMIT)
+	,slow_policy (TCP_SLOW_CLIENT_DISCONNECT)
+	,handshake (false)
+	,keyframes (false)
+	,keyframe_valid (false)
+	,listening (false)
+	,running (false)
+{
+#ifdef WIN32
+	clientMutex = CreateMutex(NULL,FALSE,NULL);
+#else
+	pthread_mutex_init(&clientMutex,NULL);
+#endif
 	if ((strcmp(host,"127.0.0.1")==0) || (strcmp(host,"localhost")==0)) {
 		local = true;
 	} else local = false;
@@ -173,21 +137,44 @@ TcpSender::TcpSender(const char *host, int port)
 		throw std::exception();
 	} else {
 		std::cout << tuio_type() << " connection opened to " << host << ":"<< port << std::endl;
-		tcp_client_list.push_back(tcp_socket);
-		connected = true;
-		
-#ifdef WIN32
-		HANDLE server_thread = CreateThread( 0, 0, ClientThreadFunc, this, 0, &ServerThreadId );
-#else
-		pthread_create(&server_thread , NULL, ClientThreadFunc,this);
-#endif
-
+		addClient(tcp_socket);
+		startEventLoop(false);
 	}
 }
 
 TcpSender::TcpSender(int port)
 	:connected (false)
+	,queue_limit (TCP_QUEUE_LIMIT)
+	,slow_policy (TCP_SLOW_CLIENT_DISCONNECT)
+	,handshake (false)
+	,keyframes (false)
+	,keyframe_valid (false)
+	,listening (false)
+	,running (false)
 {
+	openServer(port);
+}
+
+TcpSender::TcpSender(int port, bool client_handshake)
+	:connected (false)
+	,queue_limit (TCP_QUEUE_LIMIT)
+	,slow_policy (TCP_SLOW_CLIENT_DISCONNECT)
+	,handshake (client_handshake)
+	,keyframes (false)
+	,keyframe_valid (false)
+	,listening (false)
+	,running (false)
+{
+	openServer(port);
+}
+
+void TcpSender::openServer(int port) {
+
+#ifdef WIN32
+	clientMutex = CreateMutex(NULL,FALSE,NULL);
+#else
+	pthread_mutex_init(&clientMutex,NULL);
+#endif
 	local = false;
 	buffer_size = MAX_TCP_SIZE;
 	port_no = port;
@@ -223,7 +210,7 @@ TcpSender::TcpSender(int port)
 		throw std::exception();
 	}
 	
-	ret =  listen(tcp_socket, 1);
+	ret =  listen(tcp_socket, SOMAXCONN);
 	if (ret < 0) {
 		std::cerr << "could not start listening to TUIO/TCP socket" << std::endl;
 #ifdef WIN32
@@ -233,70 +220,450 @@ TcpSender::TcpSender(int port)
 #endif
 		throw std::exception();
 	}
-				
+
+	std::cout << tuio_type() << " socket created on port " << port_no << std::endl;
+	startEventLoop(true);
+}
+
+void TcpSender::startEventLoop(bool listen) {
+
+	listening = listen;
+	if (listening) poller.addSocket(tcp_socket);
+	running = true;
+
 #ifdef WIN32
-	DWORD ServerThreadId;
 	server_thread = CreateThread( 0, 0, ServerThreadFunc, this, 0, &ServerThreadId );
 #else
 	pthread_create(&server_thread , NULL, ServerThreadFunc, this);
 #endif
-	
 }
 
-bool TcpSender::isConnected() {
-	return connected;
+void TcpSender::runEventLoop() {
+
+	while (running) {
+		int events = poller.wait(-1);
+		for (int i=0;i<events;i++) {
+			SocketHandle socket = poller.getSocket(i);
+			if (listening && (socket==tcp_socket)) {
+				acceptClient();
+				continue;
+			}
+
+			lockClientList();
+			std::map<SocketHandle,TcpClient*>::iterator iter = tcp_client_map.find(socket);
+			if (iter!=tcp_client_map.end()) {
+				TcpClient *client = iter->second;
+				if (poller.isReadable(i)) readClient(client);
+				if (poller.isWritable(i) && !client->closing) flushClient(client);
+			}
+			unlockClientList();
+		}
+		closeClients();
+	}
 }
 
+void TcpSender::acceptClient() {
 
-TcpSender::~TcpSender() {
+	struct sockaddr_in client_addr;
+	socklen_t len = sizeof(client_addr);
+
+#ifdef WIN32
+	SOCKET tcp_client = accept(tcp_socket, (struct sockaddr*)&client_addr, &len);
+	if (tcp_client==INVALID_SOCKET) return;
+#else
+	int tcp_client = accept(tcp_socket, (struct sockaddr*)&client_addr, &len);
+	if (tcp_client<0) return;
+#endif
+
+	std::cout << tuio_type() << " client connected from " << inet_ntoa(client_addr.sin_addr) << "@" << client_addr.sin_port << std::endl;
+	newClient((int)tcp_client);
+	addClient(tcp_client);
+}
+
+void TcpSender::addClient(SocketHandle tcp_client) {
+
+	int optval = 1;
+	setsockopt(tcp_client, IPPROTO_TCP, TCP_NODELAY, (const char *)&optval, sizeof(int));
+#ifdef SO_NOSIGPIPE
+	setsockopt(tcp_client, SOL_SOCKET, SO_NOSIGPIPE, (const void *)&optval, sizeof(int));
+#endif
+	SocketPoller::setNonBlocking(tcp_client);
+	poller.addSocket(tcp_client);
+
+	TcpClient *client = new TcpClient();
+	client->socket = tcp_client;
+	client->queue_offset = 0;
+	client->queue_size = 0;
+	client->skipping = false;
+	client->closing = false;
+	client->ready = false;
+	client->resync = false;
+	client->format = 0;
+
+	lockClientList();
+	tcp_client_map[tcp_client] = client;
+	if (!handshake) readyClient(client);
+	connected = true;
+	unlockClientList();
+}
+
+void TcpSender::readyClient(TcpClient *client) {
+	client->ready = true;
+	if (keyframes) resyncClient(client);
+}
+
+void TcpSender::resyncClient(TcpClient *client) {
+
+	// without a current keyframe the client is held back until the TuioServer provides the next one
+	if (!keyframe_valid) {
+		client->resync = true;
+		return;
+	}
+
+	TcpFrame frame;
+	for (unsigned int i=0;i<keyframe.size();i++) {
+		encodeFrame(client->format, keyframe[i].data(), (unsigned int)keyframe[i].size(), frame);
+		writeClient(client, frame.header, frame.header_size, frame.data, frame.data_size);
+	}
+	client->resync = false;
+}
+
+void TcpSender::readClient(TcpClient *client) {
+
+	// TUIO clients only send clock synchronization requests, otherwise we just need to detect closed connections
+	char buf[1024];
+	for (;;) {
+		int bytes = recv(client->socket, buf, sizeof(buf), 0);
+		if (bytes>0) {
+			client->input.append(buf, bytes);
+			continue;
+		}
+		if ((bytes<0) && TCP_WOULD_BLOCK) break;
+		client->closing = true;
+		return;
+	}
+
+	processInput(client);
+}
+
+void TcpSender::processInput(TcpClient *client) {
+	processPings(client);
+}
+
+void TcpSender::processPings(TcpClient *client) {
+
+	osc::int64 receive_time = TuioClock::getSystemTime();
+	char pong[TUIO_PING_SIZE];
+
+	while (client->input.size()>=4) {
+		const unsigned char *header = (const unsigned char*)client->input.data();
+		unsigned int size = ((unsigned int)header[0]<<24) | ((unsigned int)header[1]<<16) | ((unsigned int)header[2]<<8) | (unsigned int)header[3];
+
+		// anything else than a length-prefixed ping is discarded
+		if (size>TUIO_PING_SIZE) {
+			client->input.clear();
+			return;
+		}
+		if (client->input.size()<4+size) return;
+
+		unsigned int pong_size = TuioClock::answerPing(client->input.data()+4, size, receive_time, pong, sizeof(pong));
+		if (pong_size>0) replyClient(client, pong, pong_size);
+		client->input.erase(0, 4+size);
+	}
+}
+
+void TcpSender::replyClient(TcpClient *client, const char *data, unsigned int size) {
+
+	char header[16];
+	unsigned int header_size = packetHeader(header, size);
+	writeClient(client, header, header_size, data, size);
+}
+
+void TcpSender::writeClient(TcpClient *client, const char *header, unsigned int header_size, const char *data, unsigned int size) {
+
+	if (client->queue.empty()) {
+		int sent = writePacket(client->socket, header, header_size, data, size);
+		if ((unsigned int)sent==header_size+size) return;
+		if (sent<0) {
+			if (!TCP_WOULD_BLOCK) {
+				client->closing = true;
+				return;
+			}
+			sent = 0;
+		}
+		queuePacket(client, header, header_size, data, size, sent);
+	} else queuePacket(client, header, header_size, data, size, 0);
+}
+
+void TcpSender::flushClient(TcpClient *client) {
+
+	while (!client->queue.empty()) {
+		std::string &packet = client->queue.front();
+		unsigned int remaining = (unsigned int)packet.size()-client->queue_offset;
+		int sent = writePacket(client->socket, NULL, 0, packet.data()+client->queue_offset, remaining);
+		if (sent<0) {
+			if (!TCP_WOULD_BLOCK) client->closing = true;
+			return;
+		}
+
+		client->queue_size -= sent;
+		if ((unsigned int)sent<remaining) {
+			client->queue_offset += sent;
+			return;
+		}
+
+		client->queue.pop_front();
+		client->queue_offset = 0;
+	}
+
+	poller.setWritable(client->socket, false);
+
+	// a client that skipped packets needs the full state again
+	if (client->skipping) {
+		client->skipping = false;
+		if (keyframes) resyncClient(client);
+	}
+}
+
+void TcpSender::closeClients() {
+
+	lockClientList();
+	std::map<SocketHandle,TcpClient*>::iterator iter = tcp_client_map.begin();
+	while (iter!=tcp_client_map.end()) {
+		TcpClient *client = iter->second;
+		if (!client->closing) {
+			iter++;
+			continue;
+		}
+
+		poller.removeSocket(client->socket);
+#ifdef WIN32
+		closesocket(client->socket);
+#else
+		close(client->socket);
+#endif
+		if (client->socket==tcp_socket) tcp_socket = -1;
+		delete client;
+		tcp_client_map.erase(iter++);
+		std::cout << tuio_type() << " connection closed"<< std::endl;
+	}
+	connected = !tcp_client_map.empty();
+	unlockClientList();
+}
+
+void TcpSender::queuePacket(TcpClient *client, const char *header, unsigned int header_size, const char *data, unsigned int data_size, unsigned int offset) {
+
+	std::string packet;
+	packet.reserve(header_size+data_size-offset);
+	if (offset<header_size) {
+		packet.append(header+offset, header_size-offset);
+		packet.append(data, data_size);
+	} else packet.append(data+offset-header_size, data_size+header_size-offset);
+
+	if (client->queue.empty()) poller.setWritable(client->socket, true);
+	client->queue_size += (unsigned int)packet.size();
+	client->queue.push_back(packet);
+}
+
+int TcpSender::writePacket(SocketHandle socket, const char *header, unsigned int header_size, const char *data, unsigned int data_size) {
 #ifdef WIN32
+	if (header_size>0) {
+		memcpy(&data_buffer[0], header, header_size);
+		memcpy(&data_buffer[header_size], data, data_size);
+		return send(socket, data_buffer, header_size+data_size, 0);
+	} else return send(socket, data, data_size, 0);
+#else
+	struct iovec iov[2];
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
 
-	for (std::list<SOCKET>::iterator client = tcp_client_list.begin(); client!=tcp_client_list.end(); client++) {
-		closesocket((*client));
+	int count = 0;
+	if (header_size>0) {
+		iov[count].iov_base = (void*)header;
+		iov[count].iov_len = header_size;
+		count++;
 	}
-	closesocket(tcp_socket);
+	iov[count].iov_base = (void*)data;
+	iov[count].iov_len = data_size;
+	count++;
+
+	msg.msg_iov = iov;
+	msg.msg_iovlen = count;
+#ifdef MSG_NOSIGNAL
+	return (int)sendmsg(socket, &msg, MSG_NOSIGNAL);
+#else
+	return (int)sendmsg(socket, &msg, 0);
+#endif
+#endif
+}
 
-	if( server_thread ) CloseHandle( server_thread );
+void TcpSender::lockClientList() {
+#ifdef WIN32
+	WaitForSingleObject(clientMutex, INFINITE);
+#else
+	pthread_mutex_lock(&clientMutex);
+#endif
+}
 
+void TcpSender::unlockClientList() {
+#ifdef WIN32
+	ReleaseMutex(clientMutex);
 #else
-		for (std::list<int>::iterator client = tcp_client_list.begin(); client!=tcp_client_list.end(); client++) {
-		close((*client));
+	pthread_mutex_unlock(&clientMutex);
+#endif
+}
+
+int TcpSender::getClientCount() {
+	lockClientList();
+	int count = (int)tcp_client_map.size();
+	unlockClientList();
+	return count;
+}
+
+bool TcpSender::isConnected() {
+	return connected;
+}
+
+void TcpSender::invalidateKeyframe() {
+	lockClientList();
+	keyframes = true;
+	keyframe_valid = false;
+	unlockClientList();
+}
+
+bool TcpSender::requestsKeyframe() {
+
+	bool request = false;
+	lockClientList();
+	if (!keyframe_valid) {
+		for (std::map<SocketHandle,TcpClient*>::iterator iter = tcp_client_map.begin(); iter!=tcp_client_map.end(); iter++) {
+			if (iter->second->resync && !iter->second->closing) {
+				request = true;
+				break;
+			}
+		}
 	}
-	close(tcp_socket);
-	tcp_socket = 0;
-	server_thread = 0;
-#endif		
+	unlockClientList();
+	return request;
 }
 
+void TcpSender::setKeyframe(const std::vector<std::string> &packets) {
 
-bool TcpSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
-	if (!connected) return false; 
-	if ( bundle->Size() > buffer_size ) return false;
-	if ( bundle->Size() == 0 ) return false;
-	
-#ifdef OSC_HOST_LITTLE_ENDIAN             
-	data_size[0] =  bundle->Size()>>24;
-	data_size[1] = (bundle->Size()>>16) & 255;
-	data_size[2] = (bundle->Size()>>8) & 255;
-	data_size[3] = (bundle->Size()) & 255;
+	bool closing = false;
+	lockClientList();
+	keyframe = packets;
+	keyframe_valid = true;
+	for (std::map<SocketHandle,TcpClient*>::iterator iter = tcp_client_map.begin(); iter!=tcp_client_map.end(); iter++) {
+		TcpClient *client = iter->second;
+		if (!client->resync || client->closing) continue;
+		resyncClient(client);
+		if (client->closing) closing = true;
+	}
+	unlockClientList();
+
+	if (closing) poller.wakeup();
+}
+
+void TcpSender::stopEventLoop() {
+
+	if (!running) return;
+	running = false;
+	poller.wakeup();
+#ifdef WIN32
+	WaitForSingleObject(server_thread, INFINITE);
+	CloseHandle(server_thread);
 #else
-	*((int32_t*)data_size) = bundle->Size();
+	pthread_join(server_thread, NULL);
 #endif
+}
+
+TcpSender::~TcpSender() {
 
+	stopEventLoop();
+
+	for (std::map<SocketHandle,TcpClient*>::iterator iter = tcp_client_map.begin(); iter!=tcp_client_map.end(); iter++) {
 #ifdef WIN32
-	std::list<SOCKET>::iterator client;
+		if (iter->first!=tcp_socket) closesocket(iter->first);
 #else
-	std::list<int>::iterator client;
+		if (iter->first!=tcp_socket) close(iter->first);
 #endif
-	
-	for (client = tcp_client_list.begin(); client!=tcp_client_list.end(); client++) {
-		//send((*client), data_size, 4,0);
-		//send((*client), bundle->Data(), bundle->Size(),0);
-		memcpy(&data_buffer[0], &data_size, 4);
-		memcpy(&data_buffer[4], bundle->Data(), bundle->Size());
-		send((*client),data_buffer, 4+bundle->Size(),0);
+		delete iter->second;
+	}
+	tcp_client_map.clear();
+
+#ifdef WIN32
+	if ((int)tcp_socket>=0) closesocket(tcp_socket);
+	CloseHandle(clientMutex);
+#else
+	if (tcp_socket>=0) close(tcp_socket);
+	pthread_mutex_destroy(&clientMutex);
+#endif
+	tcp_socket = -1;
+}
+
+unsigned int TcpSender::packetHeader(char *header, unsigned int size) {
+	header[0] = (size>>24) & 255;
+	header[1] = (size>>16) & 255;
+	header[2] = (size>>8) & 255;
+	header[3] = size & 255;
+	return 4;
+}
+
+void TcpSender::encodeFrame(int format, const char *data, unsigned int size, TcpFrame &frame) {
+	frame.header_size = packetHeader(frame.header, size);
+	frame.data = data;
+	frame.data_size = size;
+}
+
+bool TcpSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
+	return sendOscData( bundle->Data(), (unsigned int)bundle->Size() );
+}
+
+bool TcpSender::sendOscData (const char *data, unsigned int size) {
+	if (!connected) return false; 
+	if ( size > buffer_size ) return false;
+	if ( size == 0 ) return false;
+
+	// each frame format is only encoded once the first client requires it
+	TcpFrame frames[TCP_FRAME_FORMATS];
+	for (int i=0;i<TCP_FRAME_FORMATS;i++) frames[i].data = NULL;
+	bool closing = false;
+
+	lockClientList();
+	for (std::map<SocketHandle,TcpClient*>::iterator iter = tcp_client_map.begin(); iter!=tcp_client_map.end(); iter++) {
+		TcpClient *client = iter->second;
+		if (client->closing || !client->ready || client->resync) continue;
+
+		TcpFrame &frame = frames[client->format];
+		if (frame.data==NULL) encodeFrame(client->format, data, size, frame);
+		const char *header = frame.header;
+		unsigned int header_size = frame.header_size;
+		unsigned int data_size = frame.data_size;
+		unsigned int packet_size = header_size+data_size;
+
+		if (client->queue.empty()) {
+			int sent = writePacket(client->socket, header, header_size, frame.data, data_size);
+			if ((unsigned int)sent==packet_size) continue;
+			if (sent<0) {
+				if (!TCP_WOULD_BLOCK) {
+					client->closing = closing = true;
+					continue;
+				}
+				sent = 0;
+			}
+			// a partially written packet always needs to be completed
+			queuePacket(client, header, header_size, frame.data, data_size, sent);
+		} else if (client->skipping || (client->queue_size+packet_size>queue_limit)) {
+			if (slow_policy==TCP_SLOW_CLIENT_SKIP) client->skipping = true;
+			else {
+				std::cout << tuio_type() << " client too slow" << std::endl;
+				client->closing = closing = true;
+			}
+		} else queuePacket(client, header, header_size, frame.data, data_size, 0);
 	}
+	unlockClientList();
 
+	if (closing) poller.wakeup();
 	return true;
 }
 
@@ -20,6 +20,7 @@
 #define INCLUDED_TCPSENDER_H
 
 #include "OscSender.h"
+#include "SocketPoller.h"
 
 #ifdef WIN32
 #include <winsock.h>
@@ -31,17 +32,32 @@ typedef int socklen_t;
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netdb.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #endif
 
-#include <list>
+#include <map>
+#include <deque>
+#include <string>
+#include <vector>
 #define MAX_TCP_SIZE 65536
+#define TCP_QUEUE_LIMIT 1048576
+
+#define TCP_SLOW_CLIENT_DISCONNECT 0
+#define TCP_SLOW_CLIENT_SKIP 1
+
+// the number of alternative frame encodings a client can select, such as compressed WebSocket frames
+#define TCP_FRAME_FORMATS 2
 
 namespace TUIO {
 	
 	/**
 	 * The TcpSender implements the TCP transport method for OSC
+	 * All connections are served by a single event loop thread with non-blocking sockets.
+	 * Each packet is written directly to all clients, data that could not be written immediately
+	 * is queued per client and flushed as soon as the client socket becomes writable again.
+	 * When used by a TuioServer, each new client first receives the cached keyframe with the full scene state.
 	 *
 	 * @author Martin Kaltenbrunner
 	 * @version 1.1.6
@@ -84,6 +100,15 @@ namespace TUIO {
 		
 		bool sendOscPacket (osc::OutboundPacketStream *bundle);
 
+		/**
+		 * This method delivers an already encoded OSC packet
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @return true if the data was delivered successfully
+		 */
+		bool sendOscData (const char *data, unsigned int size);
+
 		/**
 		 * This method returns the connection state
 		 *
@@ -92,33 +117,214 @@ namespace TUIO {
 		bool isConnected ();
 
 		/**
-		 * This method is called whenever a new client connects
+		 * This method marks the cached keyframe as outdated,
+		 * new clients then wait until the TuioServer provided the next keyframe
+		 */
+		void invalidateKeyframe ();
+
+		/**
+		 * This method returns true if a client is waiting for an outdated keyframe
+		 *
+		 * @return true if a new keyframe is required
+		 */
+		bool requestsKeyframe ();
+
+		/**
+		 * This method caches the provided keyframe and delivers it to all waiting clients
+		 *
+		 * @param  packets  the encoded keyframe packets
+		 */
+		void setKeyframe (const std::vector<std::string> &packets);
+
+		/**
+		 * This method is called whenever a new client connects,
+		 * before the client socket is switched to non-blocking mode
 		 *
 		 * @param tcp_client the socket handle of the new client
 		 */
 		virtual void newClient( int tcp_client );
 
+		/**
+		 * This method defines the maximum amount of data in bytes,
+		 * which can be queued for a client that does not keep up with the packet rate
+		 *
+		 * @param  limit  the maximum queue size in bytes, defaults to TCP_QUEUE_LIMIT
+		 */
+		void setQueueLimit(unsigned int limit) { queue_limit = limit; };
+
+		/**
+		 * This method returns the maximum amount of data in bytes,
+		 * which can be queued for a slow client
+		 *
+		 * @return the maximum queue size in bytes
+		 */
+		unsigned int getQueueLimit() { return queue_limit; };
+
+		/**
+		 * This method defines how clients are handled once their queue exceeds the queue limit.
+		 * With TCP_SLOW_CLIENT_DISCONNECT (default) the connection is closed,
+		 * with TCP_SLOW_CLIENT_SKIP any further packets are dropped for this client until its queue drained,
+		 * after which it receives the current keyframe again if available.
+		 *
+		 * @param  policy  TCP_SLOW_CLIENT_DISCONNECT or TCP_SLOW_CLIENT_SKIP
+		 */
+		void setSlowClientPolicy(int policy) { slow_policy = policy; };
+
+		/**
+		 * This method returns the number of currently connected clients
+		 *
+		 * @return the number of connected clients
+		 */
+		int getClientCount();
+
+		/**
+		 * This method runs the event loop until the TcpSender is destroyed,
+		 * it is only public to be accessible from the thread function
+		 */
+		void runEventLoop();
+
 		int port_no;
 		
 #ifdef WIN32
 		SOCKET tcp_socket;
-		std::list<SOCKET> tcp_client_list;
 #else
 		int tcp_socket;
-		std::list<int> tcp_client_list;
 #endif
 		bool connected;
 		const char* tuio_type() { return "TUIO/TCP"; }
 
 	protected:
-		char data_size[4];
-		char data_buffer[MAX_TCP_SIZE+4];
-		
+
+		/**
+		 * This constructor creates a TcpSender that listens to the provided port,
+		 * its clients only receive packets once a protocol handshake in processInput() set their ready flag
+		 *
+		 * @param  port	the incoming TCP port number
+		 * @param  client_handshake  clients need to complete a handshake if set to true
+		 */
+		TcpSender(int port, bool client_handshake);
+
+		struct TcpClient {
+			SocketHandle socket;
+			std::deque<std::string> queue;
+			unsigned int queue_offset;
+			unsigned int queue_size;
+			bool skipping;
+			bool closing;
+			bool ready;
+			bool resync;
+			int format;
+			std::string input;
+		};
+
+		struct TcpFrame {
+			char header[16];
+			unsigned int header_size;
+			const char *data;
+			unsigned int data_size;
+		};
+
+		/**
+		 * This method writes the framing header for a packet of the provided size.
+		 * The default implementation writes the 4-byte big-endian length prefix of OSC over TCP.
+		 *
+		 * @param  header  the header buffer of at least 16 bytes
+		 * @param  size  the packet size in bytes
+		 * @return the header size in bytes
+		 */
+		virtual unsigned int packetHeader(char *header, unsigned int size);
+
+		/**
+		 * This method encodes a packet for all clients that selected the provided frame format.
+		 * It is called at most once per packet and format, the default implementation
+		 * only adds the packetHeader() to the unmodified packet data.
+		 *
+		 * @param  format  the frame format below TCP_FRAME_FORMATS
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @param  frame  the frame to encode, its data needs to remain valid until the next call
+		 */
+		virtual void encodeFrame(int format, const char *data, unsigned int size, TcpFrame &frame);
+
+		/**
+		 * This method processes the data received from a client, which has been appended to its input buffer.
+		 * The default implementation answers the length-prefixed clock synchronization requests.
+		 * It is called from the event loop thread with the client list locked.
+		 *
+		 * @param  client  the client that received data
+		 */
+		virtual void processInput(TcpClient *client);
+
+		/**
+		 * This method writes a framed reply to a single client
+		 *
+		 * @param  client  the receiving client
+		 * @param  data  the reply data
+		 * @param  size  the reply size
+		 */
+		void replyClient(TcpClient *client, const char *data, unsigned int size);
+
+		/**
+		 * This method writes the provided header and data to a single client,
+		 * any data that could not be written immediately is queued
+		 *
+		 * @param  client  the receiving client
+		 * @param  header  the header data, or NULL
+		 * @param  header_size  the header size
+		 * @param  data  the data to write
+		 * @param  size  the data size
+		 */
+		void writeClient(TcpClient *client, const char *header, unsigned int header_size, const char *data, unsigned int size);
+
+		/**
+		 * This method starts the delivery of packets to a client, which completed its handshake.
+		 * It is called with the client list locked.
+		 *
+		 * @param  client  the client that is ready
+		 */
+		void readyClient(TcpClient *client);
+
+		/**
+		 * This method stops and joins the event loop thread, subclasses need to call it
+		 * in their destructor before they release any resources used by processInput() or encodeFrame()
+		 */
+		void stopEventLoop();
+
+	private:
+
+		void openServer(int port);
+		void startEventLoop(bool listen);
+		void acceptClient();
+		void addClient(SocketHandle tcp_client);
+		void readClient(TcpClient *client);
+		void processPings(TcpClient *client);
+		void flushClient(TcpClient *client);
+		void resyncClient(TcpClient *client);
+		void closeClients();
+		void queuePacket(TcpClient *client, const char *header, unsigned int header_size, const char *data, unsigned int data_size, unsigned int offset);
+		int writePacket(SocketHandle socket, const char *header, unsigned int header_size, const char *data, unsigned int data_size);
+
+		void lockClientList();
+		void unlockClientList();
+
+		std::map<SocketHandle,TcpClient*> tcp_client_map;
+		SocketPoller poller;
+		unsigned int queue_limit;
+		int slow_policy;
+		bool handshake;
+		bool keyframes;
+		bool keyframe_valid;
+		std::vector<std::string> keyframe;
+		bool listening;
+		bool running;
 
 #ifdef WIN32
+		char data_buffer[MAX_TCP_SIZE+16];
+		HANDLE clientMutex;
 		HANDLE server_thread;
 		DWORD ServerThreadId;
 #else
+		pthread_mutex_t clientMutex;
 		pthread_t server_thread;
 #endif
 		
@@ -24,34 +24,58 @@ using namespace osc;
 
 
 TuioClient::TuioClient()
-: currentFrame	(-1)
-, source_id		(0)
+: source_id		(0)
 , source_name	(NULL)
 , source_addr	(NULL)
 , local_receiver(true)
+, latency_statistics(false)
+, parse_time	(0)
+, commit_time	(0)
+, packet_time	(0)
+, bundle_timetag	(1)
+, clock_sync	(false)
+, clock_interval	(1000)
+, jitterBuffer	(NULL)
+, jitter_running	(false)
 {
 	receiver = new UdpReceiver();
 	initialize();
 }
 
 TuioClient::TuioClient(int port)
-: currentFrame	(-1)
-, source_id		(0)
+: source_id		(0)
 , source_name	(NULL)
 , source_addr	(NULL)
 , local_receiver(true)
+, latency_statistics(false)
+, parse_time	(0)
+, commit_time	(0)
+, packet_time	(0)
+, bundle_timetag	(1)
+, clock_sync	(false)
+, clock_interval	(1000)
+, jitterBuffer	(NULL)
+, jitter_running	(false)
 {
 	receiver = new UdpReceiver(port);
 	initialize();
 }
 
 TuioClient::TuioClient(OscReceiver *osc)
-: currentFrame	(-1)
-, source_id		(0)
+: source_id		(0)
 , source_name	(NULL)
 , source_addr	(NULL)
 , receiver		(osc)
 , local_receiver(false)
+, latency_statistics(false)
+, parse_time	(0)
+, commit_time	(0)
+, packet_time	(0)
+, bundle_timetag	(1)
+, clock_sync	(false)
+, clock_interval	(1000)
+, jitterBuffer	(NULL)
+, jitter_running	(false)
 {
 	initialize();
 }
@@ -64,6 +88,7 @@ void TuioClient::initialize()	{
 
 TuioClient::~TuioClient() {
 	if (local_receiver) delete receiver;
+	if (jitterBuffer) delete jitterBuffer;
 }
 
 void TuioClient::processOSC( const ReceivedMessage& msg ) {
@@ -102,26 +127,49 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 			} else if (strcmp(cmd,"set")==0) {	
 				int32 s_id, c_id;
 				float xpos, ypos, angle, xspeed, yspeed, rspeed, maccel, raccel;
-				args >> s_id >> c_id >> xpos >> ypos >> angle >> xspeed >> yspeed >> rspeed >> maccel >> raccel;
+				if (strcmp(msg.TypeTags(),QUANTIZED_OBJ_TYPETAGS)==0) {
+					int32 pos, rot, vel;
+					args >> s_id >> c_id >> pos >> rot >> vel >> maccel >> raccel;
+					xpos = dequantizeUnit(quantizedHigh(pos));
+					ypos = dequantizeUnit(quantizedLow(pos));
+					angle = dequantizeAngle(quantizedHigh(rot));
+					rspeed = dequantizeSpeed(quantizedLow(rot));
+					xspeed = dequantizeSpeed(quantizedHigh(vel));
+					yspeed = dequantizeSpeed(quantizedLow(vel));
+				} else args >> s_id >> c_id >> xpos >> ypos >> angle >> xspeed >> yspeed >> rspeed >> maccel >> raccel;
+				processObjectSet(s_id,c_id,xpos,ypos,angle,xspeed,yspeed,rspeed,maccel,raccel);
 
-				lockObjectList();
-				std::list<TuioObject*>::iterator tobj;
-				for (tobj=objectList.begin(); tobj!= objectList.end(); tobj++)
-					if((*tobj)->getSessionID()==(long)s_id) break;
+			} else if (strcmp(cmd,"pset")==0) {
 
-				if (tobj == objectList.end()) {
-					
-					TuioObject *addObject = new TuioObject((long)s_id,(int)c_id,xpos,ypos,angle);
-					frameObjects.push_back(addObject);
-
-				} else if ( ((*tobj)->getX()!=xpos) || ((*tobj)->getY()!=ypos) || ((*tobj)->getAngle()!=angle) || ((*tobj)->getXSpeed()!=xspeed) || ((*tobj)->getYSpeed()!=yspeed) || ((*tobj)->getRotationSpeed()!=rspeed) || ((*tobj)->getMotionAccel()!=maccel) || ((*tobj)->getRotationAccel()!=raccel) ) {
-
-					TuioObject *updateObject = new TuioObject((long)s_id,(*tobj)->getSymbolID(),xpos,ypos,angle);
-					updateObject->update(xpos,ypos,angle,xspeed,yspeed,rspeed,maccel,raccel);
-					frameObjects.push_back(updateObject);
+				int32 format;
+				Blob records;
+				args >> format >> records;
 
+				unsigned int record_size = PACKED_OBJ_RECORD_SIZE;
+				if (format==PACKED_FIXED16) record_size -= PACKED_FIXED16_SAVING;
+				else if (format!=PACKED_FLOAT32) record_size = 0;
+				
+				const char *record = (const char*)records.data;
+				for (unsigned int i=0;(record_size>0) && (i+record_size<=(unsigned int)records.size);i+=record_size) {
+					int32 s_id, c_id;
+					float xpos, ypos, angle, xspeed, yspeed, rspeed, maccel, raccel;
+					record = unpackInt32(record,s_id);
+					record = unpackInt32(record,c_id);
+					if (format==PACKED_FIXED16) {
+						record = unpackFixed16(record,xpos);
+						record = unpackFixed16(record,ypos);
+					} else {
+						record = unpackFloat32(record,xpos);
+						record = unpackFloat32(record,ypos);
+					}
+					record = unpackFloat32(record,angle);
+					record = unpackFloat32(record,xspeed);
+					record = unpackFloat32(record,yspeed);
+					record = unpackFloat32(record,rspeed);
+					record = unpackFloat32(record,maccel);
+					record = unpackFloat32(record,raccel);
+					processObjectSet(s_id,c_id,xpos,ypos,angle,xspeed,yspeed,rspeed,maccel,raccel);
 				}
-				unlockObjectList();
 
 			} else if (strcmp(cmd,"alive")==0) {
 
@@ -136,16 +184,11 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 
 				int32 fseq;
 				args >> fseq;
-				bool lateFrame = false;
-				if (fseq>0) {
-					if (fseq>currentFrame) currentTime = TuioTime::getSessionTime();
-					if ((fseq>=currentFrame) || ((currentFrame-fseq)>100)) currentFrame = fseq;
-					else lateFrame = true;
-				} else if ((TuioTime::getSessionTime().getTotalMilliseconds()-currentTime.getTotalMilliseconds())>100) {
-					currentTime = TuioTime::getSessionTime();
-				}
+				bool lateFrame = isLateFrame(fseq);
 			
 				if (!lateFrame) {
+					if (latency_statistics) commitLatency();
+					if (clock_sync) requestClockSync();
 					
 					lockObjectList();
 					//find the removed objects first
@@ -226,6 +269,8 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 					for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
 						(*listener)->refresh(currentTime);
 					
+					if (latency_statistics) dispatchLatency();
+					
 				} else {
 					for (std::list<TuioObject*>::iterator iter=frameObjects.begin(); iter != frameObjects.end(); iter++) {
 						TuioObject *tobj = (*iter);
@@ -234,6 +279,8 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 				}
 				
 				frameObjects.clear();
+				// the next bundle belongs to the default source unless it carries its own source message
+				source_id = 0;
 			}
 		} else if( strcmp( msg.AddressPattern(), "/tuio/2Dcur" ) == 0 ) {
 			const char* cmd;
@@ -267,26 +314,43 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 
 				int32 s_id;
 				float xpos, ypos, xspeed, yspeed, maccel;				
-				args >> s_id >> xpos >> ypos >> xspeed >> yspeed >> maccel;
+				if (strcmp(msg.TypeTags(),QUANTIZED_CUR_TYPETAGS)==0) {
+					int32 pos, vel;
+					args >> s_id >> pos >> vel >> maccel;
+					xpos = dequantizeUnit(quantizedHigh(pos));
+					ypos = dequantizeUnit(quantizedLow(pos));
+					xspeed = dequantizeSpeed(quantizedHigh(vel));
+					yspeed = dequantizeSpeed(quantizedLow(vel));
+				} else args >> s_id >> xpos >> ypos >> xspeed >> yspeed >> maccel;
+				processCursorSet(s_id,xpos,ypos,xspeed,yspeed,maccel);
 				
-				lockCursorList();
-				std::list<TuioCursor*>::iterator tcur;
-				for (tcur=cursorList.begin(); tcur!= cursorList.end(); tcur++)
-					if (((*tcur)->getSessionID()==(long)s_id) && ((*tcur)->getTuioSourceID()==source_id)) break;
+			} else if (strcmp(cmd,"pset")==0) {
 				
-				if (tcur==cursorList.end()) {
-									
-					TuioCursor *addCursor = new TuioCursor((long)s_id,-1,xpos,ypos);
-					frameCursors.push_back(addCursor);
-
-				} else if ( ((*tcur)->getX()!=xpos) || ((*tcur)->getY()!=ypos) || ((*tcur)->getXSpeed()!=xspeed) || ((*tcur)->getYSpeed()!=yspeed) || ((*tcur)->getMotionAccel()!=maccel) ) {
-
-					TuioCursor *updateCursor = new TuioCursor((long)s_id,(*tcur)->getCursorID(),xpos,ypos);
-					updateCursor->update(xpos,ypos,xspeed,yspeed,maccel);
-					frameCursors.push_back(updateCursor);
-
+				int32 format;
+				Blob records;
+				args >> format >> records;
+				
+				unsigned int record_size = PACKED_CUR_RECORD_SIZE;
+				if (format==PACKED_FIXED16) record_size -= PACKED_FIXED16_SAVING;
+				else if (format!=PACKED_FLOAT32) record_size = 0;
+				
+				const char *record = (const char*)records.data;
+				for (unsigned int i=0;(record_size>0) && (i+record_size<=(unsigned int)records.size);i+=record_size) {
+					int32 s_id;
+					float xpos, ypos, xspeed, yspeed, maccel;
+					record = unpackInt32(record,s_id);
+					if (format==PACKED_FIXED16) {
+						record = unpackFixed16(record,xpos);
+						record = unpackFixed16(record,ypos);
+					} else {
+						record = unpackFloat32(record,xpos);
+						record = unpackFloat32(record,ypos);
+					}
+					record = unpackFloat32(record,xspeed);
+					record = unpackFloat32(record,yspeed);
+					record = unpackFloat32(record,maccel);
+					processCursorSet(s_id,xpos,ypos,xspeed,yspeed,maccel);
 				}
-				unlockCursorList();
 				
 			} else if (strcmp(cmd,"alive")==0) {
 				
@@ -300,16 +364,11 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 			} else if( strcmp( cmd, "fseq" ) == 0 ) {
 				int32 fseq;
 				args >> fseq;
-				bool lateFrame = false;
-				if (fseq>0) {
-					if (fseq>currentFrame) currentTime = TuioTime::getSessionTime();
-					if ((fseq>=currentFrame) || ((currentFrame-fseq)>100)) currentFrame = fseq;
-					else lateFrame = true;
-				}  else if ((TuioTime::getSessionTime().getTotalMilliseconds()-currentTime.getTotalMilliseconds())>100) {
-					currentTime = TuioTime::getSessionTime();
-				}
+				bool lateFrame = isLateFrame(fseq);
 			
 				if (!lateFrame) {
+					if (latency_statistics) commitLatency();
+					if (clock_sync) requestClockSync();
 					
 					lockCursorList();
 					// find the removed cursors first
@@ -455,6 +514,8 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 					for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
 						(*listener)->refresh(currentTime);
 					
+					if (latency_statistics) dispatchLatency();
+					
 				} else {
 					for (std::list<TuioCursor*>::iterator iter=frameCursors.begin(); iter != frameCursors.end(); iter++) {
 						TuioCursor *tcur = (*iter);
@@ -463,6 +524,8 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 				}
 				
 				frameCursors.clear();
+				// the next bundle belongs to the default source unless it carries its own source message
+				source_id = 0;
 			}
 		} else if( strcmp( msg.AddressPattern(), "/tuio/2Dblb" ) == 0 ){
 			const char* cmd;
@@ -496,25 +559,53 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 				
 				int32 s_id;
 				float xpos, ypos, angle, width, height, area, xspeed, yspeed, rspeed, maccel, raccel;				
-				args >> s_id >> xpos >> ypos >> angle >> width >> height >> area >> xspeed >> yspeed >> rspeed >> maccel >> raccel;
+				if (strcmp(msg.TypeTags(),QUANTIZED_BLB_TYPETAGS)==0) {
+					int32 pos, rot, size, vel;
+					args >> s_id >> pos >> rot >> size >> vel >> area >> maccel >> raccel;
+					xpos = dequantizeUnit(quantizedHigh(pos));
+					ypos = dequantizeUnit(quantizedLow(pos));
+					angle = dequantizeAngle(quantizedHigh(rot));
+					rspeed = dequantizeSpeed(quantizedLow(rot));
+					width = dequantizeUnit(quantizedHigh(size));
+					height = dequantizeUnit(quantizedLow(size));
+					xspeed = dequantizeSpeed(quantizedHigh(vel));
+					yspeed = dequantizeSpeed(quantizedLow(vel));
+				} else args >> s_id >> xpos >> ypos >> angle >> width >> height >> area >> xspeed >> yspeed >> rspeed >> maccel >> raccel;
+				processBlobSet(s_id,xpos,ypos,angle,width,height,area,xspeed,yspeed,rspeed,maccel,raccel);
 				
-				lockBlobList();
-				std::list<TuioBlob*>::iterator tblb;
-				for (tblb=blobList.begin(); tblb!= blobList.end(); tblb++)
-					if((*tblb)->getSessionID()==(long)s_id) break;
+			} else if (strcmp(cmd,"pset")==0) {
 				
-				if (tblb==blobList.end()) {
-					
-					TuioBlob *addBlob = new TuioBlob((long)s_id,-1,xpos,ypos,angle,width,height,area);
-					frameBlobs.push_back(addBlob);
-					
-				} else if ( ((*tblb)->getX()!=xpos) || ((*tblb)->getY()!=ypos) || ((*tblb)->getAngle()!=angle) || ((*tblb)->getWidth()!=width) || ((*tblb)->getHeight()!=height) || ((*tblb)->getArea()!=area) || ((*tblb)->getXSpeed()!=xspeed) || ((*tblb)->getYSpeed()!=yspeed) || ((*tblb)->getMotionAccel()!=maccel) ) {
-					
-					TuioBlob *updateBlob = new TuioBlob((long)s_id,(*tblb)->getBlobID(),xpos,ypos,angle,width,height,area);
-					updateBlob->update(xpos,ypos,angle,width,height,area,xspeed,yspeed,rspeed,maccel,raccel);
-					frameBlobs.push_back(updateBlob);
+				int32 format;
+				Blob records;
+				args >> format >> records;
+				
+				unsigned int record_size = PACKED_BLB_RECORD_SIZE;
+				if (format==PACKED_FIXED16) record_size -= PACKED_FIXED16_SAVING;
+				else if (format!=PACKED_FLOAT32) record_size = 0;
+				
+				const char *record = (const char*)records.data;
+				for (unsigned int i=0;(record_size>0) && (i+record_size<=(unsigned int)records.size);i+=record_size) {
+					int32 s_id;
+					float xpos, ypos, angle, width, height, area, xspeed, yspeed, rspeed, maccel, raccel;
+					record = unpackInt32(record,s_id);
+					if (format==PACKED_FIXED16) {
+						record = unpackFixed16(record,xpos);
+						record = unpackFixed16(record,ypos);
+					} else {
+						record = unpackFloat32(record,xpos);
+						record = unpackFloat32(record,ypos);
+					}
+					record = unpackFloat32(record,angle);
+					record = unpackFloat32(record,width);
+					record = unpackFloat32(record,height);
+					record = unpackFloat32(record,area);
+					record = unpackFloat32(record,xspeed);
+					record = unpackFloat32(record,yspeed);
+					record = unpackFloat32(record,rspeed);
+					record = unpackFloat32(record,maccel);
+					record = unpackFloat32(record,raccel);
+					processBlobSet(s_id,xpos,ypos,angle,width,height,area,xspeed,yspeed,rspeed,maccel,raccel);
 				}
-				unlockBlobList();
 				
 			} else if (strcmp(cmd,"alive")==0) {
 				
@@ -529,16 +620,11 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 				
 				int32 fseq;
 				args >> fseq;
-				bool lateFrame = false;
-				if (fseq>0) {
-					if (fseq>currentFrame) currentTime = TuioTime::getSessionTime();
-					if ((fseq>=currentFrame) || ((currentFrame-fseq)>100)) currentFrame = fseq;
-					else lateFrame = true;
-				}  else if ((TuioTime::getSessionTime().getTotalMilliseconds()-currentTime.getTotalMilliseconds())>100) {
-					currentTime = TuioTime::getSessionTime();
-				}
+				bool lateFrame = isLateFrame(fseq);
 				
 				if (!lateFrame) {
+					if (latency_statistics) commitLatency();
+					if (clock_sync) requestClockSync();
 					
 					lockBlobList();
 					// find the removed blobs first
@@ -682,6 +768,8 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 					for (std::list<TuioListener*>::iterator listener=listenerList.begin(); listener != listenerList.end(); listener++)
 						(*listener)->refresh(currentTime);
 					
+					if (latency_statistics) dispatchLatency();
+					
 				} else {
 					for (std::list<TuioBlob*>::iterator iter=frameBlobs.begin(); iter != frameBlobs.end(); iter++) {
 						TuioBlob *tblb = (*iter);
@@ -690,13 +778,285 @@ void TuioClient::processOSC( const ReceivedMessage& msg ) {
 				}
 				
 				frameBlobs.clear();
+				// the next bundle belongs to the default source unless it carries its own source message
+				source_id = 0;
 			}
+		} else if( strcmp( msg.AddressPattern(), TUIO_PONG ) == 0 ) {
+			processClockSync(msg);
 		}
 	} catch( Exception& e ){
 		std::cerr << "error parsing TUIO message: "<< msg.AddressPattern() <<  " - " << e.what() << std::endl;
 	}
 }
 
+bool TuioClient::isLateFrame(int32 fseq) {
+
+	// the frame sequence is tracked per source, since concurrent sources are not synchronized
+	std::map<int,int32>::iterator iter = currentFrame.find(source_id);
+	if (iter==currentFrame.end()) iter = currentFrame.insert(std::pair<int,int32>(source_id,-1)).first;
+	int32 &sourceFrame = iter->second;
+
+	bool lateFrame = false;
+	if (fseq>0) {
+		if (fseq>sourceFrame) currentTime = TuioTime::getSessionTime();
+		if ((fseq>=sourceFrame) || ((sourceFrame-fseq)>100)) sourceFrame = fseq;
+		else lateFrame = true;
+	} else if ((TuioTime::getSessionTime().getTotalMilliseconds()-currentTime.getTotalMilliseconds())>100) {
+		currentTime = TuioTime::getSessionTime();
+	}
+	return lateFrame;
+}
+
+void TuioClient::enableLatencyStatistics(bool enable) {
+	latency_statistics = enable;
+}
+
+bool TuioClient::isLatencyStatisticsEnabled() {
+	return latency_statistics;
+}
+
+LatencyHistogram* TuioClient::getLatencyHistogram(int stage) {
+	if ((stage<0) || (stage>=TUIO_LATENCY_STAGES)) return NULL;
+	return &latencyHistogram[stage];
+}
+
+void TuioClient::resetLatencyStatistics() {
+	for (int i=0;i<TUIO_LATENCY_STAGES;i++) latencyHistogram[i].reset();
+}
+
+void TuioClient::setReceiveTime(int64 receive_time) {
+	// the kernel timestamps follow the system clock, which excludes the artificial clock skew
+	packet_time = (receive_time>0) ? receive_time+TuioClock::getClockSkew() : 0;
+	if (!latency_statistics) return;
+	parse_time = TuioClock::getSystemTime();
+	if (packet_time>0) latencyHistogram[TUIO_LATENCY_RECEIVE].record(parse_time-packet_time);
+}
+
+void TuioClient::setTimeTag(uint64 timetag) {
+	bundle_timetag = timetag;
+}
+
+void TuioClient::setRemoteEndpoint(const IpEndpointName &endpoint) {
+	packet_endpoint = endpoint;
+}
+
+void TuioClient::commitLatency() {
+	commit_time = TuioClock::getSystemTime();
+	if (parse_time>0) latencyHistogram[TUIO_LATENCY_DECODE].record(commit_time-parse_time);
+
+	// the frame time of the source is only comparable once its clock offset is known
+	if (bundle_timetag<=1) return;
+	std::map<int,ClockSync>::iterator clock = clockList.find(source_id);
+	if ((clock==clockList.end()) || (clock->second.samples==0)) return;
+	latencyHistogram[TUIO_LATENCY_FRAME].record(commit_time-(TuioClock::getTime(bundle_timetag)-clock->second.offset));
+}
+
+void TuioClient::dispatchLatency() {
+	latencyHistogram[TUIO_LATENCY_DISPATCH].record(TuioClock::getSystemTime()-commit_time);
+}
+
+void TuioClient::enableClockSync(bool enable, int interval) {
+	clock_sync = enable;
+	if (interval>0) clock_interval = interval;
+}
+
+bool TuioClient::isClockSyncEnabled() {
+	return clock_sync;
+}
+
+bool TuioClient::hasClockOffset(int src_id) {
+	std::map<int,ClockSync>::iterator clock = clockList.find(src_id);
+	return ((clock!=clockList.end()) && (clock->second.samples>0));
+}
+
+int64 TuioClient::getClockOffset(int src_id) {
+	std::map<int,ClockSync>::iterator clock = clockList.find(src_id);
+	if (clock==clockList.end()) return 0;
+	return clock->second.offset;
+}
+
+int64 TuioClient::getRoundTripDelay(int src_id) {
+	std::map<int,ClockSync>::iterator clock = clockList.find(src_id);
+	if (clock==clockList.end()) return 0;
+	return clock->second.delay;
+}
+
+void TuioClient::requestClockSync() {
+
+	std::map<int,ClockSync>::iterator clock = clockList.find(source_id);
+	if (clock==clockList.end()) {
+		ClockSync sync;
+		memset(&sync, 0, sizeof(ClockSync));
+		clock = clockList.insert(std::pair<int,ClockSync>(source_id,sync)).first;
+	}
+
+	int64 now = TuioClock::getSystemTime();
+	if ((clock->second.ping_time>0) && ((now-clock->second.ping_time)<(int64)clock_interval*1000000)) return;
+	clock->second.ping_time = now;
+
+	char buffer[TUIO_PING_SIZE];
+	OutboundPacketStream ping(buffer, TUIO_PING_SIZE);
+	ping << BeginMessage(TUIO_PING) << (int32)source_id << TimeTag(TuioClock::getTimeTag(now)) << EndMessage;
+	receiver->replyPacket(ping.Data(), (int)ping.Size(), packet_endpoint);
+}
+
+void TuioClient::processClockSync( const ReceivedMessage& msg ) {
+
+	int64 t4 = (packet_time>0) ? packet_time : TuioClock::getSystemTime();
+
+	int32 src_id;
+	TimeTag t1, t2, t3;
+	ReceivedMessageArgumentStream args = msg.ArgumentStream();
+	args >> src_id >> t1 >> t2 >> t3;
+
+	std::map<int,ClockSync>::iterator clock = clockList.find(src_id);
+	if (clock==clockList.end()) return;
+	ClockSync &sync = clock->second;
+
+	int64 send_time = TuioClock::getTime(t1);
+	int64 server_receive = TuioClock::getTime(t2);
+	int64 server_send = TuioClock::getTime(t3);
+
+	int64 delay = (t4-send_time)-(server_send-server_receive);
+	if (delay<0) return;
+	int index = sync.count % TUIO_CLOCK_SAMPLES;
+	sync.sample_offset[index] = ((server_receive-send_time)+(server_send-t4))/2;
+	sync.sample_delay[index] = delay;
+	sync.count++;
+	if (sync.samples<TUIO_CLOCK_SAMPLES) sync.samples++;
+
+	// the sample with the shortest round trip suffers the least from asymmetric queuing delays
+	int best = 0;
+	for (int i=1;i<sync.samples;i++)
+		if (sync.sample_delay[i]<sync.sample_delay[best]) best = i;
+	sync.offset = sync.sample_offset[best];
+	sync.delay = sync.sample_delay[best];
+}
+
+#ifndef WIN32
+static void* JitterThreadFunc( void* obj )
+#else
+static DWORD WINAPI JitterThreadFunc( LPVOID obj )
+#endif
+{
+	static_cast<TuioClient*>(obj)->runJitterBuffer();
+	return 0;
+};
+
+void TuioClient::enableJitterBuffer(bool enable, int max_delay) {
+	if (jitter_running || isConnected()) {
+		std::cerr << "the jitter buffer needs to be configured before the TuioClient is connected" << std::endl;
+		return;
+	}
+
+	if (jitterBuffer) delete jitterBuffer;
+	jitterBuffer = enable ? new JitterBuffer(max_delay) : NULL;
+}
+
+bool TuioClient::bufferPacket(const char *data, int size, const IpEndpointName &endpoint, int64 receive_time) {
+	if (jitterBuffer==NULL) return false;
+	jitterBuffer->addPacket(data, size, endpoint, receive_time);
+	return true;
+}
+
+void TuioClient::runJitterBuffer() {
+	JitterPacket *packet;
+	while ((packet = jitterBuffer->getPacket())!=NULL) {
+		setReceiveTime(packet->receive_time);
+		setRemoteEndpoint(packet->endpoint);
+		processPacket(packet->data.data(), (int)packet->data.size());
+		jitterBuffer->freePacket(packet);
+	}
+}
+
+void TuioClient::processPacket(const char *data, int size) {
+	try {
+		ReceivedPacket p(data, size);
+		if (p.IsBundle()) {
+			ReceivedBundle bundle(p);
+			setTimeTag(bundle.TimeTag());
+			processBundle(bundle);
+		} else {
+			setTimeTag(1);
+			processOSC(ReceivedMessage(p));
+		}
+	} catch (MalformedBundleException& e) {
+		std::cerr << "malformed OSC bundle: " << e.what() << std::endl;
+	}
+}
+
+void TuioClient::processBundle(const ReceivedBundle& bundle) {
+	for (ReceivedBundle::const_iterator i = bundle.ElementsBegin(); i != bundle.ElementsEnd(); ++i) {
+		if (i->IsBundle()) processBundle(ReceivedBundle(*i));
+		else processOSC(ReceivedMessage(*i));
+	}
+}
+
+void TuioClient::processObjectSet(int32 s_id, int32 c_id, float xpos, float ypos, float angle, float xspeed, float yspeed, float rspeed, float maccel, float raccel) {
+
+	lockObjectList();
+	std::list<TuioObject*>::iterator tobj;
+	for (tobj=objectList.begin(); tobj!= objectList.end(); tobj++)
+		if((*tobj)->getSessionID()==(long)s_id) break;
+
+	if (tobj == objectList.end()) {
+		
+		TuioObject *addObject = new TuioObject((long)s_id,(int)c_id,xpos,ypos,angle);
+		frameObjects.push_back(addObject);
+
+	} else if ( ((*tobj)->getX()!=xpos) || ((*tobj)->getY()!=ypos) || ((*tobj)->getAngle()!=angle) || ((*tobj)->getXSpeed()!=xspeed) || ((*tobj)->getYSpeed()!=yspeed) || ((*tobj)->getRotationSpeed()!=rspeed) || ((*tobj)->getMotionAccel()!=maccel) || ((*tobj)->getRotationAccel()!=raccel) ) {
+
+		TuioObject *updateObject = new TuioObject((long)s_id,(*tobj)->getSymbolID(),xpos,ypos,angle);
+		updateObject->update(xpos,ypos,angle,xspeed,yspeed,rspeed,maccel,raccel);
+		frameObjects.push_back(updateObject);
+
+	}
+	unlockObjectList();
+}
+
+void TuioClient::processCursorSet(int32 s_id, float xpos, float ypos, float xspeed, float yspeed, float maccel) {
+
+	lockCursorList();
+	std::list<TuioCursor*>::iterator tcur;
+	for (tcur=cursorList.begin(); tcur!= cursorList.end(); tcur++)
+		if (((*tcur)->getSessionID()==(long)s_id) && ((*tcur)->getTuioSourceID()==source_id)) break;
+	
+	if (tcur==cursorList.end()) {
+						
+		TuioCursor *addCursor = new TuioCursor((long)s_id,-1,xpos,ypos);
+		frameCursors.push_back(addCursor);
+
+	} else if ( ((*tcur)->getX()!=xpos) || ((*tcur)->getY()!=ypos) || ((*tcur)->getXSpeed()!=xspeed) || ((*tcur)->getYSpeed()!=yspeed) || ((*tcur)->getMotionAccel()!=maccel) ) {
+
+		TuioCursor *updateCursor = new TuioCursor((long)s_id,(*tcur)->getCursorID(),xpos,ypos);
+		updateCursor->update(xpos,ypos,xspeed,yspeed,maccel);
+		frameCursors.push_back(updateCursor);
+
+	}
+	unlockCursorList();
+}
+
+void TuioClient::processBlobSet(int32 s_id, float xpos, float ypos, float angle, float width, float height, float area, float xspeed, float yspeed, float rspeed, float maccel, float raccel) {
+
+	lockBlobList();
+	std::list<TuioBlob*>::iterator tblb;
+	for (tblb=blobList.begin(); tblb!= blobList.end(); tblb++)
+		if((*tblb)->getSessionID()==(long)s_id) break;
+	
+	if (tblb==blobList.end()) {
+		
+		TuioBlob *addBlob = new TuioBlob((long)s_id,-1,xpos,ypos,angle,width,height,area);
+		frameBlobs.push_back(addBlob);
+		
+	} else if ( ((*tblb)->getX()!=xpos) || ((*tblb)->getY()!=ypos) || ((*tblb)->getAngle()!=angle) || ((*tblb)->getWidth()!=width) || ((*tblb)->getHeight()!=height) || ((*tblb)->getArea()!=area) || ((*tblb)->getXSpeed()!=xspeed) || ((*tblb)->getYSpeed()!=yspeed) || ((*tblb)->getMotionAccel()!=maccel) ) {
+		
+		TuioBlob *updateBlob = new TuioBlob((long)s_id,(*tblb)->getBlobID(),xpos,ypos,angle,width,height,area);
+		updateBlob->update(xpos,ypos,angle,width,height,area,xspeed,yspeed,rspeed,maccel,raccel);
+		frameBlobs.push_back(updateBlob);
+	}
+	unlockBlobList();
+}
+
 bool TuioClient::isConnected() {	
 	return receiver->isConnected();
 }
@@ -705,6 +1065,16 @@ void TuioClient::connect(bool lock) {
 			
 	TuioTime::initSession();
 	currentTime.reset();
+
+	if (jitterBuffer && !jitter_running) {
+		jitter_running = true;
+		jitterBuffer->start();
+#ifndef WIN32
+		pthread_create(&jitter_thread, NULL, JitterThreadFunc, this);
+#else
+		jitter_thread = CreateThread(0, 0, JitterThreadFunc, this, 0, NULL);
+#endif
+	}
 	
 	receiver->connect(lock);
 	
@@ -716,6 +1086,17 @@ void TuioClient::connect(bool lock) {
 void TuioClient::disconnect() {
 	
 	receiver->disconnect();
+
+	if (jitter_running) {
+		jitter_running = false;
+		jitterBuffer->stop();
+#ifndef WIN32
+		pthread_join(jitter_thread, NULL);
+#else
+		WaitForSingleObject(jitter_thread, INFINITE);
+		CloseHandle(jitter_thread);
+#endif
+	}
 	
 	aliveObjectList.clear();
 	aliveCursorList.clear();
@@ -21,6 +21,11 @@
 
 #include "TuioDispatcher.h"
 #include "OscReceiver.h"
+#include "PackedProfile.h"
+#include "LatencyHistogram.h"
+#include "TuioClock.h"
+#include "JitterBuffer.h"
+#include "osc/OscOutboundPacketStream.h"
 #include "osc/OscReceivedElements.h"
 
 #include <iostream>
@@ -30,6 +35,14 @@
 #include <string>
 #include <cstring>
 
+#define TUIO_LATENCY_RECEIVE 0
+#define TUIO_LATENCY_DECODE 1
+#define TUIO_LATENCY_DISPATCH 2
+#define TUIO_LATENCY_FRAME 3
+#define TUIO_LATENCY_STAGES 4
+
+#define TUIO_CLOCK_SAMPLES 8
+
 namespace TUIO {
 	
 	class OscReceiver; // Forward declaration
@@ -267,12 +280,172 @@ namespace TUIO {
 		 * @return  an active TuioBlob corresponding to the provided Session ID or NULL
 		 */
 		TuioBlob* getTuioBlob(int src_id, long s_id);
+
+		/**
+		 * Enables or disables the latency statistics, which are recorded for each frame into four histograms:
+		 * TUIO_LATENCY_RECEIVE from the kernel receive time to the start of parsing the packet,
+		 * TUIO_LATENCY_DECODE from the start of parsing to the fseq message that commits the frame,
+		 * TUIO_LATENCY_DISPATCH from the frame commit until all TuioListener callbacks have returned and
+		 * TUIO_LATENCY_FRAME from the frame time of the TuioServer until the frame commit.
+		 * The receive stage is only available for transports providing kernel receive timestamps,
+		 * while the frame stage requires bundle time tags and the clock synchronization.
+		 *
+		 * @param  enable  enables the latency statistics if set to true
+		 */
+		void enableLatencyStatistics(bool enable);
+
+		/**
+		 * Returns true if the latency statistics are enabled
+		 *
+		 * @return  true if the latency statistics are enabled
+		 */
+		bool isLatencyStatisticsEnabled();
+
+		/**
+		 * Returns the LatencyHistogram of the provided processing stage,
+		 * which can be queried from any thread while the TuioClient is running
+		 *
+		 * @param  stage  TUIO_LATENCY_RECEIVE, TUIO_LATENCY_DECODE, TUIO_LATENCY_DISPATCH or TUIO_LATENCY_FRAME
+		 * @return  the LatencyHistogram of the processing stage or NULL
+		 */
+		LatencyHistogram* getLatencyHistogram(int stage);
+
+		/**
+		 * Removes all recorded values from the latency histograms
+		 */
+		void resetLatencyStatistics();
+
+		/**
+		 * Called by the OscReceiver before the messages of a packet are processed
+		 *
+		 * @param  receive_time  the kernel receive time in nanoseconds since the epoch, or 0 if unknown
+		 */
+		void setReceiveTime(osc::int64 receive_time);
+
+		/**
+		 * Called by the OscReceiver before the messages of a packet are processed
+		 *
+		 * @param  timetag  the OSC time tag of the bundle, or 1 for immediate bundles and single messages
+		 */
+		void setTimeTag(osc::uint64 timetag);
+
+		/**
+		 * Called by the OscReceiver before the messages of a packet are processed
+		 *
+		 * @param  endpoint  the origin of the packet, which receives the clock synchronization requests
+		 */
+		void setRemoteEndpoint(const IpEndpointName &endpoint);
+
+		/**
+		 * Enables or disables the JitterBuffer, which holds the received frames of each source for an
+		 * adaptive delay and releases them in fseq and time tag order from a separate thread.
+		 * This needs to be configured before the TuioClient is connected. Over TCP the clock
+		 * synchronization is not available while the JitterBuffer is enabled.
+		 *
+		 * @param  enable  enables the JitterBuffer if set to true
+		 * @param  max_delay  the maximum delay in milliseconds
+		 */
+		void enableJitterBuffer(bool enable, int max_delay=100);
+
+		/**
+		 * Returns true if the JitterBuffer is enabled
+		 *
+		 * @return  true if the JitterBuffer is enabled
+		 */
+		bool isJitterBufferEnabled() { return (jitterBuffer!=NULL); };
+
+		/**
+		 * Returns the JitterBuffer, which provides its current depth and delay along with the late and dropped frame counts
+		 *
+		 * @return  the JitterBuffer or NULL if it is not enabled
+		 */
+		JitterBuffer* getJitterBuffer() { return jitterBuffer; };
+
+		/**
+		 * Called by the OscReceiver for each received packet, which is copied into the JitterBuffer if it is enabled
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @param  endpoint  the origin of the packet
+		 * @param  receive_time  the kernel receive time in nanoseconds since the epoch, or 0 if unknown
+		 * @return  true if the packet was buffered
+		 */
+		bool bufferPacket(const char *data, int size, const IpEndpointName &endpoint, osc::int64 receive_time);
+
+		/**
+		 * This method processes the released frames until the JitterBuffer is stopped,
+		 * it is only public to be accessible from the thread function
+		 */
+		void runJitterBuffer();
+
+		/**
+		 * Enables or disables the clock synchronization with the TUIO sources. The TuioClient then
+		 * periodically sends a ping to each source, which is answered by TuioServers with enabled time tags.
+		 * The clock offset of each source is estimated from the exchange with the shortest round trip
+		 * among the latest samples. The transport needs to support replies to the source.
+		 *
+		 * @param  enable  enables the clock synchronization if set to true
+		 * @param  interval  the ping interval in milliseconds
+		 */
+		void enableClockSync(bool enable, int interval=1000);
+
+		/**
+		 * Returns true if the clock synchronization is enabled
+		 *
+		 * @return  true if the clock synchronization is enabled
+		 */
+		bool isClockSyncEnabled();
+
+		/**
+		 * Returns true if the clock offset of the provided TUIO source has been estimated
+		 *
+		 * @param  src_id  the source ID of the corresponding TUIO source
+		 * @return  true if the clock offset is known
+		 */
+		bool hasClockOffset(int src_id=0);
+
+		/**
+		 * Returns the estimated clock offset of the provided TUIO source
+		 *
+		 * @param  src_id  the source ID of the corresponding TUIO source
+		 * @return  the source clock minus the local clock in nanoseconds
+		 */
+		osc::int64 getClockOffset(int src_id=0);
+
+		/**
+		 * Returns the round-trip delay of the clock synchronization sample used for the offset estimate
+		 *
+		 * @param  src_id  the source ID of the corresponding TUIO source
+		 * @return  the round-trip delay in nanoseconds
+		 */
+		osc::int64 getRoundTripDelay(int src_id=0);
 		
 		void processOSC( const osc::ReceivedMessage& message);
 		
 	private:
 		void initialize();
 		
+		void processObjectSet(osc::int32 s_id, osc::int32 c_id, float xpos, float ypos, float angle, float xspeed, float yspeed, float rspeed, float maccel, float raccel);
+		void processCursorSet(osc::int32 s_id, float xpos, float ypos, float xspeed, float yspeed, float maccel);
+		void processBlobSet(osc::int32 s_id, float xpos, float ypos, float angle, float width, float height, float area, float xspeed, float yspeed, float rspeed, float maccel, float raccel);
+		bool isLateFrame(osc::int32 fseq);
+		void commitLatency();
+		void dispatchLatency();
+		void processPacket(const char *data, int size);
+		void processBundle(const osc::ReceivedBundle& bundle);
+		void requestClockSync();
+		void processClockSync( const osc::ReceivedMessage& message);
+
+		struct ClockSync {
+			osc::int64 ping_time;
+			osc::int64 offset;
+			osc::int64 delay;
+			osc::int64 sample_offset[TUIO_CLOCK_SAMPLES];
+			osc::int64 sample_delay[TUIO_CLOCK_SAMPLES];
+			int samples;
+			int count;
+		};
+		
 		std::list<TuioObject*> frameObjects;
 		std::list<long> aliveObjectList;
 		std::list<TuioCursor*> frameCursors;
@@ -280,7 +453,7 @@ namespace TUIO {
 		std::list<TuioBlob*> frameBlobs;
 		std::list<long> aliveBlobList;
 		
-		osc::int32 currentFrame;
+		std::map<int,osc::int32> currentFrame;
 		TuioTime currentTime;
 			
 		std::list<TuioCursor*> freeCursorList, freeCursorBuffer;
@@ -296,6 +469,26 @@ namespace TUIO {
 		
 		OscReceiver *receiver;
 		bool local_receiver;
+
+		bool latency_statistics;
+		LatencyHistogram latencyHistogram[TUIO_LATENCY_STAGES];
+		osc::int64 parse_time;
+		osc::int64 commit_time;
+		osc::int64 packet_time;
+		osc::uint64 bundle_timetag;
+
+		bool clock_sync;
+		int clock_interval;
+		std::map<int,ClockSync> clockList;
+		IpEndpointName packet_endpoint;
+
+		JitterBuffer *jitterBuffer;
+		bool jitter_running;
+#ifndef WIN32
+		pthread_t jitter_thread;
+#else
+		HANDLE jitter_thread;
+#endif
 	};
 };
 #endif /* INCLUDED_TUIOCLIENT_H */
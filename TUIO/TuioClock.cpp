@@ -0,0 +1,102 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "TuioClock.h"
+#include "osc/OscReceivedElements.h"
+#include "osc/OscOutboundPacketStream.h"
+#include <cstring>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <time.h>
+#endif
+
+// seconds between the NTP epoch 1900 and the unix epoch 1970
+#define NTP_UNIX_OFFSET 2208988800LL
+
+using namespace TUIO;
+
+osc::int64 TuioClock::clock_skew = 0;
+
+osc::int64 TuioClock::getSystemTime() {
+#ifdef WIN32
+	// FILETIME counts 100ns intervals since 1601
+	FILETIME ft;
+	GetSystemTimeAsFileTime(&ft);
+	osc::int64 time = ((osc::int64)ft.dwHighDateTime<<32) | ft.dwLowDateTime;
+	return (time-116444736000000000LL)*100 + clock_skew;
+#elif defined(CLOCK_REALTIME)
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	return (osc::int64)ts.tv_sec*1000000000 + ts.tv_nsec + clock_skew;
+#else
+	struct timeval tv;
+	gettimeofday(&tv,NULL);
+	return (osc::int64)tv.tv_sec*1000000000 + (osc::int64)tv.tv_usec*1000 + clock_skew;
+#endif
+}
+
+void TuioClock::setClockSkew(osc::int64 skew) {
+	clock_skew = skew;
+}
+
+osc::int64 TuioClock::getClockSkew() {
+	return clock_skew;
+}
+
+osc::uint64 TuioClock::getTimeTag(osc::int64 time) {
+	osc::int64 seconds = time/1000000000;
+	osc::int64 nanoseconds = time%1000000000;
+	if (nanoseconds<0) {
+		seconds--;
+		nanoseconds += 1000000000;
+	}
+	osc::uint64 fraction = ((osc::uint64)nanoseconds<<32)/1000000000;
+	return ((osc::uint64)(seconds+NTP_UNIX_OFFSET)<<32) | fraction;
+}
+
+osc::int64 TuioClock::getTime(osc::uint64 timetag) {
+	osc::int64 seconds = (osc::int64)(timetag>>32) - NTP_UNIX_OFFSET;
+	osc::int64 nanoseconds = (osc::int64)(((timetag & 0xFFFFFFFFULL)*1000000000)>>32);
+	return seconds*1000000000 + nanoseconds;
+}
+
+unsigned int TuioClock::answerPing(const char *data, unsigned int size, osc::int64 receive_time, char *buffer, unsigned int buffer_size) {
+
+	try {
+		osc::ReceivedPacket packet(data, (int)size);
+		if (packet.IsBundle()) return 0;
+
+		osc::ReceivedMessage message(packet);
+		if (strcmp(message.AddressPattern(), TUIO_PING)!=0) return 0;
+
+		osc::int32 source;
+		osc::TimeTag transmit_time(0);
+		osc::ReceivedMessageArgumentStream args = message.ArgumentStream();
+		args >> source >> transmit_time;
+
+		osc::OutboundPacketStream pong(buffer, buffer_size);
+		pong << osc::BeginMessage(TUIO_PONG) << source << transmit_time;
+		pong << osc::TimeTag(getTimeTag(receive_time)) << osc::TimeTag(getTimeTag(getSystemTime())) << osc::EndMessage;
+		return (unsigned int)pong.Size();
+	} catch (osc::Exception &e) {
+		return 0;
+	}
+}
@@ -0,0 +1,111 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIOCLOCK_H
+#define INCLUDED_TUIOCLOCK_H
+
+#include "LibExport.h"
+#include "osc/OscTypes.h"
+
+/*
+ The clock synchronization uses an NTP-style exchange of two OSC messages:
+
+ /tuio/ping source t1
+ /tuio/pong source t1 t2 t3
+
+ The TuioClient sends a ping with the local id of a TUIO source and its transmit time t1
+ back to that source. The TuioServer answers with a pong, which echoes the ping arguments
+ and adds its receive time t2 and transmit time t3. With the local receive time t4 of the
+ pong, the clock offset of the source is ((t2-t1)+(t3-t4))/2 and the round-trip delay
+ is (t4-t1)-(t3-t2). All times are OSC time tags.
+*/
+
+#define TUIO_PING "/tuio/ping"
+#define TUIO_PONG "/tuio/pong"
+#define TUIO_PING_SIZE 64
+
+namespace TUIO {
+
+	/**
+	 * The TuioClock provides the nanosecond system time used for bundle time tags,
+	 * kernel receive timestamps and latency measurements, along with the conversion
+	 * to and from OSC time tags and the server side of the clock synchronization.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL TuioClock {
+
+	public:
+
+		/**
+		 * Returns the current system time including the artificial clock skew
+		 *
+		 * @return the system time in nanoseconds since the epoch
+		 */
+		static osc::int64 getSystemTime();
+
+		/**
+		 * Adds an artificial skew to the system time of this process,
+		 * which allows to test the clock synchronization on a single machine
+		 *
+		 * @param  skew  the clock skew in nanoseconds
+		 */
+		static void setClockSkew(osc::int64 skew);
+
+		/**
+		 * Returns the artificial clock skew of this process
+		 *
+		 * @return the clock skew in nanoseconds
+		 */
+		static osc::int64 getClockSkew();
+
+		/**
+		 * Converts the provided system time into an OSC time tag
+		 *
+		 * @param  time  the system time in nanoseconds since the epoch
+		 * @return the corresponding OSC time tag
+		 */
+		static osc::uint64 getTimeTag(osc::int64 time);
+
+		/**
+		 * Converts the provided OSC time tag into a system time
+		 *
+		 * @param  timetag  the OSC time tag
+		 * @return the system time in nanoseconds since the epoch
+		 */
+		static osc::int64 getTime(osc::uint64 timetag);
+
+		/**
+		 * Creates the pong reply for the provided OSC packet if it contains a ping message
+		 *
+		 * @param  data  the received OSC packet
+		 * @param  size  the size of the received OSC packet
+		 * @param  receive_time  the system time when the packet was received
+		 * @param  buffer  the buffer for the pong message
+		 * @param  buffer_size  the size of the buffer, at least TUIO_PING_SIZE
+		 * @return the size of the pong message, or 0 if the packet is not a ping
+		 */
+		static unsigned int answerPing(const char *data, unsigned int size, osc::int64 receive_time, char *buffer, unsigned int buffer_size);
+
+	private:
+
+		static osc::int64 clock_skew;
+	};
+}
+#endif /* INCLUDED_TUIOCLOCK_H */
@@ -0,0 +1,166 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "TuioPlayer.h"
+#include "TuioClock.h"
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+// the longest sleep between two packets, so that seek and disconnect take effect promptly
+#define TUIO_PLAYER_SLEEP 10000000LL
+
+using namespace TUIO;
+using namespace osc;
+
+#ifndef  WIN32
+static void* PlayerThreadFunc( void* obj )
+#else
+static DWORD WINAPI PlayerThreadFunc( LPVOID obj )
+#endif
+{
+	TuioPlayer *player = static_cast<TuioPlayer*>(obj);
+	player->runPlayback();
+	return 0;
+};
+
+TuioPlayer::TuioPlayer(const char *path)
+: speed		(1.0)
+, seek_index	(-1)
+, rebase	(true)
+, running	(false)
+, playing	(false)
+, player_thread	(0)
+, locked	(false)
+{
+	if (!recording.open(path)) {
+		std::cerr << "could not open TUIO recording " << path << std::endl;
+	} else if (!recording.isComplete()) {
+		std::cerr << "recovered incomplete TUIO recording " << path << std::endl;
+	}
+}
+
+TuioPlayer::~TuioPlayer() {
+	disconnect();
+}
+
+void TuioPlayer::connect(bool lk) {
+
+	if (connected) return;
+	if (!recording.isOpen()) return;
+	locked = lk;
+
+	running = true;
+	playing = true;
+	connected = true;
+
+	if (!locked) {
+#ifndef WIN32
+		pthread_create(&player_thread , NULL, PlayerThreadFunc, this);
+#else
+		player_thread = CreateThread( 0, 0, PlayerThreadFunc, this, 0, &PlayerThreadId );
+#endif
+	} else runPlayback();
+}
+
+void TuioPlayer::disconnect() {
+
+	if (!connected) return;
+	running = false;
+
+	if (!locked) {
+#ifdef WIN32
+		WaitForSingleObject(player_thread, INFINITE);
+		if( player_thread ) CloseHandle( player_thread );
+#else
+		pthread_join(player_thread, NULL);
+#endif
+		player_thread = 0;
+	} else locked = false;
+
+	connected = false;
+}
+
+void TuioPlayer::setSpeed(double s) {
+	if (s<0.0) s = 0.0;
+	speed = s;
+	rebase = true;
+}
+
+void TuioPlayer::seek(int64 position) {
+	seek_index = recording.findPacket(recording.getStartTime()+position);
+	rebase = true;
+}
+
+void TuioPlayer::addOscSender(OscSender *sender) {
+	senderList.push_back(sender);
+}
+
+void TuioPlayer::runPlayback() {
+
+	long count = recording.getPacketCount();
+	long index = 0;
+	int64 base_time = 0;
+	int64 base_wall = 0;
+	IpEndpointName endpoint;
+
+	while (running) {
+
+		if (seek_index>=0) {
+			index = seek_index;
+			seek_index = -1;
+		}
+		if (index>=count) break;
+
+		const char *data;
+		int size;
+		int64 time = recording.getPacket(index, &data, &size);
+
+		// the schedule restarts from the current packet after a seek or speed change
+		if (rebase) {
+			rebase = false;
+			base_time = time;
+			base_wall = TuioClock::getSystemTime();
+		}
+
+		double s = speed;
+		if (s>0.0) {
+			int64 due = base_wall + (int64)((double)(time-base_time)/s);
+			while (running && !rebase && (seek_index<0)) {
+				int64 wait = due - TuioClock::getSystemTime();
+				if (wait<=0) break;
+				if (wait>TUIO_PLAYER_SLEEP) wait = TUIO_PLAYER_SLEEP;
+#ifdef WIN32
+				Sleep((DWORD)(wait/1000000));
+#else
+				usleep((useconds_t)(wait/1000));
+#endif
+			}
+			if (!running) break;
+			if (seek_index>=0) continue;
+		}
+
+		ProcessPacket(data, size, endpoint, 0);
+		for (std::list<OscSender*>::iterator sender=senderList.begin(); sender!=senderList.end(); sender++)
+			(*sender)->sendOscData(data, (unsigned int)size);
+		index++;
+	}
+
+	playing = false;
+}
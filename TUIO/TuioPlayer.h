@@ -0,0 +1,133 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIOPLAYER_H
+#define INCLUDED_TUIOPLAYER_H
+
+#include "OscReceiver.h"
+#include "OscSender.h"
+#include "TuioRecording.h"
+#include <list>
+
+namespace TUIO {
+
+	/**
+	 * The TuioPlayer replays a TuioRecording into the attached TuioClients, as if its packets were received again,
+	 * and optionally onto OscSenders such as the UdpSender or TcpSender. The packets are delivered at their
+	 * recorded cadence, scaled by the playback speed, or as fast as possible.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL TuioPlayer: public OscReceiver {
+
+	public:
+
+		/**
+		 * This constructor creates a TuioPlayer for the provided recording file
+		 *
+		 * @param  path  the recording file
+		 */
+		TuioPlayer(const char *path);
+
+		/**
+		 * The destructor stops the playback
+		 */
+		virtual ~TuioPlayer();
+
+		/**
+		 * The TuioPlayer starts the playback from the current position
+		 *
+		 * @param  lock  running in the background if set to false (default)
+		 */
+		void connect(bool lock=false);
+
+		/**
+		 * The TuioPlayer stops the playback
+		 */
+		void disconnect();
+
+		/**
+		 * Returns true until the end of the recording was reached or the playback was stopped
+		 *
+		 * @return true while playing
+		 */
+		bool isPlaying() { return playing; };
+
+		/**
+		 * Sets the playback speed relative to the recorded cadence
+		 *
+		 * @param  speed  the speed factor, or zero to replay as fast as possible
+		 */
+		void setSpeed(double speed);
+
+		/**
+		 * Returns the playback speed
+		 *
+		 * @return the speed factor, or zero if replaying as fast as possible
+		 */
+		double getSpeed() { return speed; };
+
+		/**
+		 * Continues the playback with the first packet at or after the provided position
+		 *
+		 * @param  position  the position in nanoseconds from the start of the recording
+		 */
+		void seek(osc::int64 position);
+
+		/**
+		 * Additionally delivers all replayed packets to the provided OscSender
+		 *
+		 * @param  sender  the OscSender to add
+		 */
+		void addOscSender(OscSender *sender);
+
+		/**
+		 * Returns the replayed TuioRecording
+		 *
+		 * @return the TuioRecording
+		 */
+		TuioRecording* getRecording() { return &recording; };
+
+		/**
+		 * This method replays the recording until the end or until the TuioPlayer is disconnected,
+		 * it is only public to be accessible from the thread function
+		 */
+		void runPlayback();
+
+	private:
+		TuioRecording recording;
+		std::list<OscSender*> senderList;
+
+		volatile double speed;
+		volatile long seek_index;
+		volatile bool rebase;
+		volatile bool running;
+		bool playing;
+
+#ifndef WIN32
+		pthread_t player_thread;
+#else
+		HANDLE player_thread;
+		DWORD PlayerThreadId;
+#endif
+
+		bool locked;
+	};
+}
+#endif /* INCLUDED_TUIOPLAYER_H */
@@ -0,0 +1,184 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "TuioRecorder.h"
+#include "TuioClock.h"
+#include <iostream>
+#include <cstring>
+
+// the index is also written after this period, so that an interrupted recording loses little
+#define TUIO_RECORD_INDEX_PERIOD 1000000000LL
+
+using namespace TUIO;
+using namespace osc;
+
+TuioRecorder::TuioRecorder()
+: file	(NULL)
+, file_offset	(0)
+, index_offset	(-1)
+, index_time	(0)
+, packet_count	(0)
+{
+#ifdef WIN32
+	recordMutex = CreateMutex(NULL,FALSE,NULL);
+#else
+	pthread_mutex_init(&recordMutex,NULL);
+#endif
+}
+
+TuioRecorder::~TuioRecorder() {
+	close();
+#ifdef WIN32
+	CloseHandle(recordMutex);
+#else
+	pthread_mutex_destroy(&recordMutex);
+#endif
+}
+
+bool TuioRecorder::open(const char *path) {
+
+	close();
+
+	FILE *output = fopen(path, "wb");
+	if (output==NULL) {
+		std::cerr << "could not create TUIO recording " << path << std::endl;
+		return false;
+	}
+
+	int64 start = TuioClock::getSystemTime();
+	char header[TUIO_RECORD_HEADER_SIZE];
+	memset(header, 0, TUIO_RECORD_HEADER_SIZE);
+	memcpy(header, TUIO_RECORD_MAGIC, 8);
+	packInt32(header+8, TUIO_RECORD_VERSION);
+	packInt32(header+12, TUIO_RECORD_INTERVAL);
+	packInt64(header+16, start);
+	fwrite(header, 1, TUIO_RECORD_HEADER_SIZE, output);
+
+#ifdef WIN32
+	WaitForSingleObject(recordMutex, INFINITE);
+#else
+	pthread_mutex_lock(&recordMutex);
+#endif
+	file = output;
+	file_offset = TUIO_RECORD_HEADER_SIZE;
+	index_offset = -1;
+	index_time = start;
+	packet_count = 0;
+	indexBuffer.clear();
+#ifdef WIN32
+	ReleaseMutex(recordMutex);
+#else
+	pthread_mutex_unlock(&recordMutex);
+#endif
+	return true;
+}
+
+void TuioRecorder::close() {
+
+#ifdef WIN32
+	WaitForSingleObject(recordMutex, INFINITE);
+#else
+	pthread_mutex_lock(&recordMutex);
+#endif
+	if (file!=NULL) {
+		int64 now = TuioClock::getSystemTime();
+		if (!indexBuffer.empty()) writeIndex(now);
+
+		char trailer[8];
+		packInt64(trailer, index_offset);
+		writeRecord(now, TUIO_RECORD_TRAILER, trailer, 8);
+		fclose(file);
+		file = NULL;
+	}
+#ifdef WIN32
+	ReleaseMutex(recordMutex);
+#else
+	pthread_mutex_unlock(&recordMutex);
+#endif
+}
+
+void TuioRecorder::ProcessPacket( const char *data, int size, const IpEndpointName &remoteEndpoint ) {
+	ProcessPacket(data, size, remoteEndpoint, 0);
+}
+
+void TuioRecorder::ProcessPacket( const char *data, int size, const IpEndpointName &remoteEndpoint, int64 receiveTime ) {
+
+	if ((file==NULL) || (size<=0)) return;
+
+	// kernel timestamps do not include the artificial clock skew
+	if (receiveTime>0) receiveTime += TuioClock::getClockSkew();
+	else receiveTime = TuioClock::getSystemTime();
+
+#ifdef WIN32
+	WaitForSingleObject(recordMutex, INFINITE);
+#else
+	pthread_mutex_lock(&recordMutex);
+#endif
+	if (file!=NULL) {
+		char entry[TUIO_RECORD_ENTRY_SIZE];
+		packInt64(entry, receiveTime);
+		packInt64(entry+8, file_offset);
+		indexBuffer.insert(indexBuffer.end(), entry, entry+TUIO_RECORD_ENTRY_SIZE);
+
+		writeRecord(receiveTime, TUIO_RECORD_PACKET, data, (unsigned int)size);
+		packet_count++;
+
+		if ((indexBuffer.size()>=TUIO_RECORD_INTERVAL*TUIO_RECORD_ENTRY_SIZE) || (receiveTime-index_time>=TUIO_RECORD_INDEX_PERIOD)) writeIndex(receiveTime);
+	}
+#ifdef WIN32
+	ReleaseMutex(recordMutex);
+#else
+	pthread_mutex_unlock(&recordMutex);
+#endif
+}
+
+void TuioRecorder::writeRecord(int64 time, int type, const char *data, unsigned int size) {
+
+	char header[16];
+	packInt64(header, time);
+	packInt32(header+8, type);
+	packInt32(header+12, (int32)size);
+	fwrite(header, 1, 16, file);
+	fwrite(data, 1, size, file);
+
+	unsigned int padding = recordPadding(size);
+	if (padding>0) {
+		char zero[8] = {0,0,0,0,0,0,0,0};
+		fwrite(zero, 1, padding, file);
+	}
+
+	file_offset += 16+size+padding;
+}
+
+void TuioRecorder::writeIndex(int64 time) {
+
+	unsigned int count = (unsigned int)(indexBuffer.size()/TUIO_RECORD_ENTRY_SIZE);
+	char header[16];
+	packInt64(header, index_offset);
+	packInt32(header+8, (int32)count);
+	packInt32(header+12, 0);
+	indexBuffer.insert(indexBuffer.begin(), header, header+16);
+
+	int64 offset = file_offset;
+	writeRecord(time, TUIO_RECORD_INDEX, &indexBuffer[0], (unsigned int)indexBuffer.size());
+	fflush(file);
+
+	index_offset = offset;
+	index_time = time;
+	indexBuffer.clear();
+}
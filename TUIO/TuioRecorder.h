@@ -0,0 +1,122 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIORECORDER_H
+#define INCLUDED_TUIORECORDER_H
+
+#include "LibExport.h"
+#include "TuioRecording.h"
+#include "ip/PacketListener.h"
+#include "ip/IpEndpointName.h"
+
+#include <cstdio>
+#include <vector>
+
+#ifndef WIN32
+#include <pthread.h>
+#endif
+
+namespace TUIO {
+
+	/**
+	 * The TuioRecorder writes every OSC packet it receives along with its receive time into a TuioRecording file.
+	 * It is attached to an OscReceiver with addPacketTap(), and can therefore record any TUIO transport
+	 * alongside the TuioClient. The recording can be replayed with the TuioPlayer.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL TuioRecorder: public PacketListener {
+
+	public:
+
+		/**
+		 * The default constructor creates a TuioRecorder without an open file
+		 */
+		TuioRecorder();
+
+		/**
+		 * The destructor closes the recording file
+		 */
+		virtual ~TuioRecorder();
+
+		/**
+		 * Creates or truncates the provided recording file and starts recording
+		 *
+		 * @param  path  the recording file
+		 * @return true if the file was created
+		 */
+		bool open(const char *path);
+
+		/**
+		 * Writes the final index and trailer and closes the recording file
+		 */
+		void close();
+
+		/**
+		 * Returns true if a recording file is open
+		 *
+		 * @return true if a recording file is open
+		 */
+		bool isRecording() { return (file!=NULL); };
+
+		/**
+		 * Returns the number of packets recorded into the current file
+		 *
+		 * @return the number of recorded packets
+		 */
+		long getPacketCount() { return packet_count; };
+
+		/**
+		 * Records the provided OSC packet with the current system time
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @param  remoteEndpoint  the source of the OSC packet, which is not recorded
+		 */
+		void ProcessPacket( const char *data, int size, const IpEndpointName &remoteEndpoint );
+
+		/**
+		 * Records the provided OSC packet with its kernel receive time, or the current system time if it is not available
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @param  remoteEndpoint  the source of the OSC packet, which is not recorded
+		 * @param  receiveTime  the kernel receive time in nanoseconds since the epoch, or zero
+		 */
+		void ProcessPacket( const char *data, int size, const IpEndpointName &remoteEndpoint, osc::int64 receiveTime );
+
+	private:
+		void writeRecord(osc::int64 time, int type, const char *data, unsigned int size);
+		void writeIndex(osc::int64 time);
+
+		FILE *file;
+		osc::int64 file_offset;
+		osc::int64 index_offset;
+		osc::int64 index_time;
+		long packet_count;
+		std::vector<char> indexBuffer;
+
+#ifdef WIN32
+		HANDLE recordMutex;
+#else
+		pthread_mutex_t recordMutex;
+#endif
+	};
+}
+#endif /* INCLUDED_TUIORECORDER_H */
@@ -0,0 +1,221 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "TuioRecording.h"
+#include <cstring>
+#include <algorithm>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace TUIO;
+using namespace osc;
+
+TuioRecording::TuioRecording()
+: buffer	(NULL)
+, file_size	(0)
+, complete	(false)
+#ifdef WIN32
+, file_handle	(INVALID_HANDLE_VALUE)
+, mapping_handle	(NULL)
+#endif
+{
+}
+
+TuioRecording::~TuioRecording() {
+	close();
+}
+
+bool TuioRecording::open(const char *path) {
+
+	close();
+
+#ifdef WIN32
+	file_handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file_handle==INVALID_HANDLE_VALUE) return false;
+	LARGE_INTEGER size;
+	GetFileSizeEx(file_handle, &size);
+	file_size = (int64)size.QuadPart;
+	if (file_size>=TUIO_RECORD_HEADER_SIZE) {
+		mapping_handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping_handle!=NULL) buffer = (const char*)MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+	}
+#else
+	int fd = ::open(path, O_RDONLY);
+	if (fd<0) return false;
+	struct stat info;
+	if (fstat(fd, &info)==0) file_size = (int64)info.st_size;
+	if (file_size>=TUIO_RECORD_HEADER_SIZE) {
+		void *map = mmap(NULL, (size_t)file_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (map!=MAP_FAILED) buffer = (const char*)map;
+	}
+	::close(fd);
+#endif
+
+	if (buffer==NULL) {
+		close();
+		return false;
+	}
+
+	int32 version;
+	unpackInt32(buffer+8, version);
+	if ((memcmp(buffer, TUIO_RECORD_MAGIC, 8)!=0) || (version!=TUIO_RECORD_VERSION)) {
+		close();
+		return false;
+	}
+
+	complete = readIndex();
+	if (!complete) scanRecords();
+	return true;
+}
+
+void TuioRecording::close() {
+#ifdef WIN32
+	if (buffer!=NULL) UnmapViewOfFile(buffer);
+	if (mapping_handle!=NULL) CloseHandle(mapping_handle);
+	if (file_handle!=INVALID_HANDLE_VALUE) CloseHandle(file_handle);
+	mapping_handle = NULL;
+	file_handle = INVALID_HANDLE_VALUE;
+#else
+	if (buffer!=NULL) munmap((void*)buffer, (size_t)file_size);
+#endif
+	buffer = NULL;
+	file_size = 0;
+	complete = false;
+	timeList.clear();
+	offsetList.clear();
+}
+
+bool TuioRecording::readIndex() {
+
+	// the trailer is the last record of a properly closed recording
+	int64 trailer = file_size-24;
+	if (trailer<TUIO_RECORD_HEADER_SIZE) return false;
+	int32 type, size;
+	unpackInt32(buffer+trailer+8, type);
+	unpackInt32(buffer+trailer+12, size);
+	if ((type!=TUIO_RECORD_TRAILER) || (size!=8)) return false;
+
+	// walk the index chain backwards, then add the blocks in file order
+	std::vector<int64> indexList;
+	int64 index;
+	unpackInt64(buffer+trailer+16, index);
+	while (index>=0) {
+		if ((index<TUIO_RECORD_HEADER_SIZE) || (index+32>trailer)) return false;
+		unpackInt32(buffer+index+8, type);
+		if (type!=TUIO_RECORD_INDEX) return false;
+		indexList.push_back(index);
+		int64 previous;
+		unpackInt64(buffer+index+16, previous);
+		if (previous>=index) return false;
+		index = previous;
+	}
+
+	for (int i=(int)indexList.size()-1;i>=0;i--) {
+		const char *block = buffer+indexList[i];
+		int32 count;
+		unpackInt32(block+24, count);
+		if ((count<0) || (indexList[i]+32+(int64)count*TUIO_RECORD_ENTRY_SIZE>trailer)) {
+			timeList.clear();
+			offsetList.clear();
+			return false;
+		}
+
+		const char *entry = block+32;
+		for (int j=0;j<count;j++) {
+			int64 time, offset;
+			entry = unpackInt64(entry, time);
+			entry = unpackInt64(entry, offset);
+
+			// a damaged entry must not point outside the packets, the recording is then recovered from the packets
+			int32 length = -1;
+			if ((offset>=TUIO_RECORD_HEADER_SIZE) && (offset+16<=trailer)) {
+				unpackInt32(buffer+offset+8, type);
+				unpackInt32(buffer+offset+12, length);
+			}
+			if ((length<0) || (type!=TUIO_RECORD_PACKET) || (offset+16+length>trailer)) {
+				timeList.clear();
+				offsetList.clear();
+				return false;
+			}
+			addPacket(time, offset);
+		}
+	}
+
+	return true;
+}
+
+void TuioRecording::scanRecords() {
+
+	timeList.clear();
+	offsetList.clear();
+
+	int64 offset = TUIO_RECORD_HEADER_SIZE;
+	while (offset+16<=file_size) {
+		int64 time;
+		int32 type, size;
+		unpackInt64(buffer+offset, time);
+		unpackInt32(buffer+offset+8, type);
+		unpackInt32(buffer+offset+12, size);
+
+		// a truncated record ends the recovered recording
+		if ((size<0) || (offset+16+size>file_size)) break;
+		if (type==TUIO_RECORD_PACKET) addPacket(time, offset);
+		offset += 16+size+recordPadding((unsigned int)size);
+	}
+}
+
+void TuioRecording::addPacket(int64 time, int64 offset) {
+	// the search requires monotonic times, although concurrent receive threads may interleave slightly
+	if (!timeList.empty() && (time<timeList.back())) time = timeList.back();
+	timeList.push_back(time);
+	offsetList.push_back(offset);
+}
+
+int64 TuioRecording::getStartTime() {
+	if (timeList.empty()) return 0;
+	return timeList.front();
+}
+
+int64 TuioRecording::getEndTime() {
+	if (timeList.empty()) return 0;
+	return timeList.back();
+}
+
+int64 TuioRecording::getPacket(long index, const char **data, int *size) {
+	if ((index<0) || (index>=(long)offsetList.size())) {
+		*data = NULL;
+		*size = 0;
+		return 0;
+	}
+
+	const char *record = buffer+offsetList[index];
+	int32 length;
+	unpackInt32(record+12, length);
+	*data = record+16;
+	*size = (int)length;
+	return timeList[index];
+}
+
+long TuioRecording::findPacket(int64 time) {
+	return (long)(std::lower_bound(timeList.begin(), timeList.end(), time)-timeList.begin());
+}
@@ -0,0 +1,184 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIORECORDING_H
+#define INCLUDED_TUIORECORDING_H
+
+#include "LibExport.h"
+#include "PackedProfile.h"
+#include "osc/OscTypes.h"
+#include <vector>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+/*
+ A TUIO recording is an append-only file of raw OSC packets with their receive times.
+ All values are stored in network byte order, and every record is aligned to 8 bytes:
+
+ header:  "TUIOREC\0" version(int32) interval(int32) start(int64) reserved(int64)
+ record:  time(int64) type(int32) size(int32) payload[size] padding
+
+ A TUIO_RECORD_PACKET record carries a single OSC packet. After every TUIO_RECORD_INTERVAL
+ packets, and when the recording is closed, a TUIO_RECORD_INDEX record lists the time
+ and file offset of the packets since the previous index:
+
+ index:   previous(int64) count(int32) reserved(int32) { time(int64) offset(int64) } * count
+
+ A properly closed recording ends with a TUIO_RECORD_TRAILER record, which contains the
+ offset of the last index. The chain of index records then allows to load the packet
+ index without scanning the file, while an incomplete recording, or an index entry
+ pointing outside the packets, is recovered by scanning all record headers.
+ All times are nanoseconds since the epoch.
+*/
+
+#define TUIO_RECORD_MAGIC "TUIOREC"
+#define TUIO_RECORD_VERSION 1
+#define TUIO_RECORD_HEADER_SIZE 32
+#define TUIO_RECORD_ENTRY_SIZE 16
+#define TUIO_RECORD_INTERVAL 1024
+#define TUIO_RECORD_PACKET 1
+#define TUIO_RECORD_INDEX 2
+#define TUIO_RECORD_TRAILER 3
+
+namespace TUIO {
+
+	inline char* packInt64(char *dst, osc::int64 value) {
+		dst = packInt32(dst, (osc::int32)(value>>32));
+		return packInt32(dst, (osc::int32)(value & 0xFFFFFFFF));
+	}
+
+	inline const char* unpackInt64(const char *src, osc::int64 &value) {
+		osc::int32 high, low;
+		src = unpackInt32(src, high);
+		src = unpackInt32(src, low);
+		value = ((osc::int64)high<<32) | (osc::int64)(osc::uint32)low;
+		return src;
+	}
+
+	inline unsigned int recordPadding(unsigned int size) {
+		return (8-(size & 7)) & 7;
+	}
+
+	/**
+	 * The TuioRecording maps a recorded TUIO session into memory and provides random access
+	 * to its packets, including a binary search for the first packet at a given time.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL TuioRecording {
+
+	public:
+
+		/**
+		 * The default constructor creates an empty TuioRecording
+		 */
+		TuioRecording();
+
+		/**
+		 * The destructor unmaps the recording file
+		 */
+		~TuioRecording();
+
+		/**
+		 * Maps the provided recording file and loads its packet index
+		 *
+		 * @param  path  the recording file
+		 * @return true if the file is a valid recording
+		 */
+		bool open(const char *path);
+
+		/**
+		 * Unmaps the recording file
+		 */
+		void close();
+
+		/**
+		 * Returns true if a recording file is mapped
+		 *
+		 * @return true if a recording file is mapped
+		 */
+		bool isOpen() { return (buffer!=NULL); };
+
+		/**
+		 * Returns true if the recording was closed properly, otherwise its index was recovered from the packets
+		 *
+		 * @return true if the recording ends with a trailer
+		 */
+		bool isComplete() { return complete; };
+
+		/**
+		 * Returns the number of recorded packets
+		 *
+		 * @return the number of packets
+		 */
+		long getPacketCount() { return (long)offsetList.size(); };
+
+		/**
+		 * Returns the receive time of the first packet
+		 *
+		 * @return the start time in nanoseconds since the epoch
+		 */
+		osc::int64 getStartTime();
+
+		/**
+		 * Returns the receive time of the last packet
+		 *
+		 * @return the end time in nanoseconds since the epoch
+		 */
+		osc::int64 getEndTime();
+
+		/**
+		 * Provides the packet at the given index, which points directly into the mapped file
+		 *
+		 * @param  index  the packet index
+		 * @param  data  receives the OSC packet data
+		 * @param  size  receives the OSC packet size
+		 * @return the receive time of the packet in nanoseconds since the epoch
+		 */
+		osc::int64 getPacket(long index, const char **data, int *size);
+
+		/**
+		 * Finds the first packet that was received at or after the given time
+		 *
+		 * @param  time  the time in nanoseconds since the epoch
+		 * @return the packet index, or the packet count if no packet follows
+		 */
+		long findPacket(osc::int64 time);
+
+	private:
+		bool readIndex();
+		void scanRecords();
+		void addPacket(osc::int64 time, osc::int64 offset);
+
+		const char *buffer;
+		osc::int64 file_size;
+		bool complete;
+
+		std::vector<osc::int64> timeList;
+		std::vector<osc::int64> offsetList;
+
+#ifdef WIN32
+		HANDLE file_handle;
+		HANDLE mapping_handle;
+#endif
+	};
+}
+#endif /* INCLUDED_TUIORECORDING_H */
@@ -0,0 +1,195 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "TuioScenePublisher.h"
+#include "TuioClock.h"
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+using namespace TUIO;
+
+TuioScenePublisher::TuioScenePublisher(TuioDispatcher *src, const char *shm_name, unsigned int max_entities)
+	:source		(src)
+	,header		(NULL)
+	,mapping_size	(0)
+	,publish_count	(0)
+{
+	snprintf(name, sizeof(name), "%s", shm_name);
+	if (max_entities<1) max_entities = 1;
+	mapping_size = sceneSegmentSize(max_entities, max_entities, max_entities);
+
+	void *mapping = NULL;
+#ifdef WIN32
+	char mapping_name[80];
+	snprintf(mapping_name, sizeof(mapping_name), "Local\\%s", (name[0]=='/') ? name+1 : name);
+	mapping_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, mapping_size, mapping_name);
+	if (mapping_handle!=NULL) mapping = MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, mapping_size);
+#else
+	int fd = shm_open(name, O_CREAT | O_RDWR, 0666);
+	if (fd>=0) {
+		struct stat info;
+		if ((fstat(fd, &info)==0) && (info.st_size!=(off_t)mapping_size)) {
+			if (ftruncate(fd, mapping_size)<0) {
+				::close(fd);
+				fd = -1;
+			}
+		}
+	}
+	if (fd>=0) {
+		mapping = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (mapping==MAP_FAILED) mapping = NULL;
+		::close(fd);
+	}
+#endif
+
+	if (mapping==NULL) {
+		std::cout << "could not create TUIO scene segment " << name << std::endl;
+		throw std::exception();
+	}
+
+	header = (SceneHeader*)mapping;
+	if ((header->magic!=TUIO_SCENE_MAGIC) || (header->version!=TUIO_SCENE_VERSION) || (header->max_cursors!=max_entities) || (header->max_objects!=max_entities) || (header->max_blobs!=max_entities)) {
+		memset(header, 0, TUIO_SCENE_HEADER_SIZE);
+		header->version = TUIO_SCENE_VERSION;
+		header->max_cursors = max_entities;
+		header->max_objects = max_entities;
+		header->max_blobs = max_entities;
+		header->publish_time = TuioClock::getSystemTime();
+		SHM_BARRIER();
+		header->magic = TUIO_SCENE_MAGIC;
+	} else if (header->sequence & 1) {
+		// a previous publisher stopped in the middle of a frame
+		header->sequence++;
+	}
+	header->closed = 0;
+	SHM_BARRIER();
+
+	std::cout << "TUIO scene state to " << name << std::endl;
+}
+
+TuioScenePublisher::~TuioScenePublisher() {
+
+	if (header==NULL) return;
+	header->closed = 1;
+	SHM_BARRIER();
+
+#ifdef WIN32
+	UnmapViewOfFile(header);
+	CloseHandle(mapping_handle);
+#else
+	munmap(header, mapping_size);
+	shm_unlink(name);
+#endif
+}
+
+void TuioScenePublisher::publish(std::list<TuioCursor*> &cursorList, std::list<TuioObject*> &objectList, std::list<TuioBlob*> &blobList, long frame_id, TuioTime frame_time) {
+
+	if (header==NULL) return;
+
+	// an odd sequence tells the readers that the frame is being written
+	header->sequence++;
+	SHM_BARRIER();
+
+	unsigned int truncated = 0;
+	unsigned int count = 0;
+	SceneCursor *cursors = sceneCursors(header);
+	for (std::list<TuioCursor*>::iterator iter = cursorList.begin(); iter!=cursorList.end(); iter++) {
+		if (count==header->max_cursors) { truncated = 1; break; }
+		TuioCursor *tcur = (*iter);
+		SceneCursor *record = &cursors[count++];
+		record->session_id = (osc::int32)tcur->getSessionID();
+		record->cursor_id = tcur->getCursorID();
+		record->x = tcur->getX();
+		record->y = tcur->getY();
+		record->x_speed = tcur->getXSpeed();
+		record->y_speed = tcur->getYSpeed();
+		record->motion_accel = tcur->getMotionAccel();
+		record->state = tcur->getTuioState();
+	}
+	header->cursor_count = count;
+
+	count = 0;
+	SceneObject *objects = sceneObjects(header);
+	for (std::list<TuioObject*>::iterator iter = objectList.begin(); iter!=objectList.end(); iter++) {
+		if (count==header->max_objects) { truncated = 1; break; }
+		TuioObject *tobj = (*iter);
+		SceneObject *record = &objects[count++];
+		record->session_id = (osc::int32)tobj->getSessionID();
+		record->symbol_id = tobj->getSymbolID();
+		record->x = tobj->getX();
+		record->y = tobj->getY();
+		record->angle = tobj->getAngle();
+		record->x_speed = tobj->getXSpeed();
+		record->y_speed = tobj->getYSpeed();
+		record->rotation_speed = tobj->getRotationSpeed();
+		record->motion_accel = tobj->getMotionAccel();
+		record->rotation_accel = tobj->getRotationAccel();
+		record->state = tobj->getTuioState();
+		record->reserved = 0;
+	}
+	header->object_count = count;
+
+	count = 0;
+	SceneBlob *blobs = sceneBlobs(header);
+	for (std::list<TuioBlob*>::iterator iter = blobList.begin(); iter!=blobList.end(); iter++) {
+		if (count==header->max_blobs) { truncated = 1; break; }
+		TuioBlob *tblb = (*iter);
+		SceneBlob *record = &blobs[count++];
+		record->session_id = (osc::int32)tblb->getSessionID();
+		record->blob_id = tblb->getBlobID();
+		record->x = tblb->getX();
+		record->y = tblb->getY();
+		record->angle = tblb->getAngle();
+		record->width = tblb->getWidth();
+		record->height = tblb->getHeight();
+		record->area = tblb->getArea();
+		record->x_speed = tblb->getXSpeed();
+		record->y_speed = tblb->getYSpeed();
+		record->rotation_speed = tblb->getRotationSpeed();
+		record->motion_accel = tblb->getMotionAccel();
+		record->rotation_accel = tblb->getRotationAccel();
+		record->state = tblb->getTuioState();
+	}
+	header->blob_count = count;
+
+	header->frame_id = (osc::int32)frame_id;
+	header->truncated = truncated;
+	header->frame_time = (osc::int64)frame_time.getSeconds()*1000000 + frame_time.getMicroseconds();
+	header->publish_time = TuioClock::getSystemTime();
+
+	SHM_BARRIER();
+	header->sequence++;
+	publish_count++;
+}
+
+void TuioScenePublisher::refresh(TuioTime ftime) {
+
+	if (source==NULL) return;
+	// the TuioClient invokes refresh from its receiver thread, which also deletes removed entities
+	std::list<TuioCursor*> cursorList = source->getTuioCursors();
+	std::list<TuioObject*> objectList = source->getTuioObjects();
+	std::list<TuioBlob*> blobList = source->getTuioBlobs();
+	publish(cursorList, objectList, blobList, publish_count+1, ftime);
+}
@@ -0,0 +1,113 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIOSCENEPUBLISHER_H
+#define INCLUDED_TUIOSCENEPUBLISHER_H
+
+#include "TuioDispatcher.h"
+#include "SceneState.h"
+#include <list>
+
+namespace TUIO {
+
+	/**
+	 * The TuioScenePublisher writes the current state of all TuioCursors, TuioObjects and TuioBlobs
+	 * into a shared-memory segment, from which any number of TuioSceneReaders on the same host
+	 * can take consistent snapshots without sockets, OSC parsing or locks.
+	 * A TuioServer publishes each committed frame through setScenePublisher(), while a publisher
+	 * that is added as TuioListener to a TuioClient re-publishes the state of the received frames.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL TuioScenePublisher : public TuioListener {
+
+	public:
+
+		/**
+		 * This constructor creates the shared-memory segment with room for the provided number of
+		 * cursors, objects and blobs each. An existing segment of the same layout is taken over.
+		 *
+		 * @param  source  the TuioDispatcher that is re-published on refresh, or NULL for a TuioServer
+		 * @param  name  the shared-memory segment name, defaults to "/tuio_scene"
+		 * @param  max_entities  the maximum number of records per profile
+		 */
+		TuioScenePublisher(TuioDispatcher *source=NULL, const char *name=TUIO_SCENE_NAME, unsigned int max_entities=TUIO_SCENE_MAX);
+
+		/**
+		 * The destructor marks the segment as closed and removes it
+		 */
+		virtual ~TuioScenePublisher();
+
+		/**
+		 * Publishes the provided lists as the current frame
+		 *
+		 * @param  cursorList  the active TuioCursors
+		 * @param  objectList  the active TuioObjects
+		 * @param  blobList  the active TuioBlobs
+		 * @param  frame_id  the frame ID
+		 * @param  frame_time  the frame time
+		 */
+		void publish(std::list<TuioCursor*> &cursorList, std::list<TuioObject*> &objectList, std::list<TuioBlob*> &blobList, long frame_id, TuioTime frame_time);
+
+		/**
+		 * Returns true if the shared-memory segment is mapped
+		 *
+		 * @return true if the segment is mapped
+		 */
+		bool isConnected() { return (header!=NULL); };
+
+		/**
+		 * Returns the number of published frames
+		 *
+		 * @return the number of published frames
+		 */
+		long getPublishCount() { return publish_count; };
+
+		void addTuioObject(TuioObject *tobj) {};
+		void updateTuioObject(TuioObject *tobj) {};
+		void removeTuioObject(TuioObject *tobj) {};
+
+		void addTuioCursor(TuioCursor *tcur) {};
+		void updateTuioCursor(TuioCursor *tcur) {};
+		void removeTuioCursor(TuioCursor *tcur) {};
+
+		void addTuioBlob(TuioBlob *tblb) {};
+		void updateTuioBlob(TuioBlob *tblb) {};
+		void removeTuioBlob(TuioBlob *tblb) {};
+
+		/**
+		 * Re-publishes the current state of the source TuioDispatcher
+		 *
+		 * @param  ftime  the frame time
+		 */
+		void refresh(TuioTime ftime);
+
+	private:
+		TuioDispatcher *source;
+		SceneHeader *header;
+		unsigned int mapping_size;
+		long publish_count;
+		char name[64];
+
+#ifdef WIN32
+		HANDLE mapping_handle;
+#endif
+	};
+}
+#endif /* INCLUDED_TUIOSCENEPUBLISHER_H */
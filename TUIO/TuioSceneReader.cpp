@@ -0,0 +1,170 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "TuioSceneReader.h"
+#include <cstring>
+#include <cstdio>
+
+#ifndef WIN32
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
+
+using namespace TUIO;
+
+TuioSceneReader::TuioSceneReader(const char *shm_name)
+: header	(NULL)
+, mapping_size	(0)
+, cursor_count	(0)
+, object_count	(0)
+, blob_count	(0)
+, frame_id	(0)
+, frame_time	(0)
+, publish_time	(0)
+, truncated	(false)
+, retry_count	(0)
+{
+	snprintf(name, sizeof(name), "%s", shm_name);
+#ifdef WIN32
+	mapping_handle = NULL;
+#endif
+}
+
+TuioSceneReader::~TuioSceneReader() {
+	detach();
+}
+
+bool TuioSceneReader::attach() {
+
+	void *mapping = NULL;
+#ifdef WIN32
+	char mapping_name[80];
+	snprintf(mapping_name, sizeof(mapping_name), "Local\\%s", (name[0]=='/') ? name+1 : name);
+	mapping_handle = OpenFileMappingA(FILE_MAP_READ, FALSE, mapping_name);
+	if (mapping_handle==NULL) return false;
+	mapping = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+	if (mapping!=NULL) {
+		MEMORY_BASIC_INFORMATION info;
+		VirtualQuery(mapping, &info, sizeof(info));
+		mapping_size = (unsigned int)info.RegionSize;
+	}
+#else
+	int fd = shm_open(name, O_RDONLY, 0666);
+	if (fd<0) return false;
+	struct stat info;
+	if ((fstat(fd, &info)==0) && (info.st_size>TUIO_SCENE_HEADER_SIZE)) {
+		mapping_size = (unsigned int)info.st_size;
+		mapping = mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (mapping==MAP_FAILED) mapping = NULL;
+	}
+	::close(fd);
+#endif
+
+	if (mapping==NULL) {
+		detach();
+		return false;
+	}
+
+	header = (SceneHeader*)mapping;
+	if ((header->magic!=TUIO_SCENE_MAGIC) || (header->version!=TUIO_SCENE_VERSION) || (header->closed) || (sceneSegmentSize(header->max_cursors, header->max_objects, header->max_blobs)>mapping_size)) {
+		detach();
+		return false;
+	}
+
+	cursorBuffer.resize(header->max_cursors);
+	objectBuffer.resize(header->max_objects);
+	blobBuffer.resize(header->max_blobs);
+	return true;
+}
+
+void TuioSceneReader::detach() {
+#ifdef WIN32
+	if (header!=NULL) UnmapViewOfFile(header);
+	if (mapping_handle!=NULL) CloseHandle(mapping_handle);
+	mapping_handle = NULL;
+#else
+	if (header!=NULL) munmap(header, mapping_size);
+#endif
+	header = NULL;
+}
+
+bool TuioSceneReader::update() {
+
+	cursor_count = object_count = blob_count = 0;
+
+	if (header==NULL) {
+		if (!attach()) return false;
+	} else if (header->closed) {
+		detach();
+		return false;
+	}
+
+	for (int i=0;i<TUIO_SCENE_RETRIES;i++) {
+
+		// the publisher may have been preempted in the middle of a frame, which is not worth spinning for
+		if (i>=TUIO_SCENE_SPINS) {
+#ifdef WIN32
+			SwitchToThread();
+#else
+			sched_yield();
+#endif
+		}
+
+		osc::uint32 sequence = header->sequence;
+		SHM_BARRIER();
+		if (sequence & 1) {
+			retry_count++;
+			continue;
+		}
+
+		// the counts may be inconsistent until the sequence is checked again, therefore they are only clamped
+		unsigned int cursors = header->cursor_count;
+		unsigned int objects = header->object_count;
+		unsigned int blobs = header->blob_count;
+		if (cursors>header->max_cursors) cursors = header->max_cursors;
+		if (objects>header->max_objects) objects = header->max_objects;
+		if (blobs>header->max_blobs) blobs = header->max_blobs;
+
+		if (cursors>0) memcpy(&cursorBuffer[0], sceneCursors(header), cursors*sizeof(SceneCursor));
+		if (objects>0) memcpy(&objectBuffer[0], sceneObjects(header), objects*sizeof(SceneObject));
+		if (blobs>0) memcpy(&blobBuffer[0], sceneBlobs(header), blobs*sizeof(SceneBlob));
+		long fid = header->frame_id;
+		osc::int64 ftime = header->frame_time;
+		osc::int64 ptime = header->publish_time;
+		bool trunc = (header->truncated!=0);
+
+		SHM_BARRIER();
+		if (header->sequence!=sequence) {
+			retry_count++;
+			continue;
+		}
+
+		cursor_count = (int)cursors;
+		object_count = (int)objects;
+		blob_count = (int)blobs;
+		frame_id = fid;
+		frame_time = ftime;
+		publish_time = ptime;
+		truncated = trunc;
+		return true;
+	}
+
+	return false;
+}
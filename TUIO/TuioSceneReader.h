@@ -0,0 +1,171 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_TUIOSCENEREADER_H
+#define INCLUDED_TUIOSCENEREADER_H
+
+#include "LibExport.h"
+#include "SceneState.h"
+#include "TuioTime.h"
+#include <vector>
+
+namespace TUIO {
+
+	/**
+	 * The TuioSceneReader takes consistent snapshots of the scene state, which is published by a
+	 * TuioScenePublisher on the same host. Each call to update() copies the latest frame into a local
+	 * buffer, which remains unchanged until the next call to update(). Readers never block the
+	 * publisher, and attach to the segment again if the publisher was restarted.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL TuioSceneReader {
+
+	public:
+
+		/**
+		 * This constructor creates a TuioSceneReader for the provided segment name
+		 *
+		 * @param  name  the shared-memory segment name, defaults to "/tuio_scene"
+		 */
+		TuioSceneReader(const char *name=TUIO_SCENE_NAME);
+
+		/**
+		 * The destructor unmaps the shared-memory segment
+		 */
+		~TuioSceneReader();
+
+		/**
+		 * Takes a snapshot of the latest published frame
+		 *
+		 * @return true if a consistent snapshot was taken, otherwise the snapshot is empty
+		 */
+		bool update();
+
+		/**
+		 * Returns true if the reader is attached to a published segment
+		 *
+		 * @return true if the segment is mapped
+		 */
+		bool isAttached() { return (header!=NULL); };
+
+		/**
+		 * Returns the number of cursors within the current snapshot
+		 *
+		 * @return the number of cursors
+		 */
+		int getCursorCount() { return cursor_count; };
+
+		/**
+		 * Returns the number of objects within the current snapshot
+		 *
+		 * @return the number of objects
+		 */
+		int getObjectCount() { return object_count; };
+
+		/**
+		 * Returns the number of blobs within the current snapshot
+		 *
+		 * @return the number of blobs
+		 */
+		int getBlobCount() { return blob_count; };
+
+		/**
+		 * Returns the cursor record at the provided index of the current snapshot
+		 *
+		 * @param  index  the record index
+		 * @return the cursor record
+		 */
+		const SceneCursor& getCursor(int index) { return cursorBuffer[index]; };
+
+		/**
+		 * Returns the object record at the provided index of the current snapshot
+		 *
+		 * @param  index  the record index
+		 * @return the object record
+		 */
+		const SceneObject& getObject(int index) { return objectBuffer[index]; };
+
+		/**
+		 * Returns the blob record at the provided index of the current snapshot
+		 *
+		 * @param  index  the record index
+		 * @return the blob record
+		 */
+		const SceneBlob& getBlob(int index) { return blobBuffer[index]; };
+
+		/**
+		 * Returns the frame ID of the current snapshot
+		 *
+		 * @return the frame ID
+		 */
+		long getFrameID() { return frame_id; };
+
+		/**
+		 * Returns the frame time of the current snapshot
+		 *
+		 * @return the frame time
+		 */
+		TuioTime getFrameTime() { return TuioTime((long)(frame_time/1000000), (long)(frame_time%1000000)); };
+
+		/**
+		 * Returns the system time in nanoseconds at which the current snapshot was published,
+		 * which can be compared to TuioClock::getSystemTime() in order to determine its age
+		 *
+		 * @return the publish time in nanoseconds
+		 */
+		osc::int64 getPublishTime() { return publish_time; };
+
+		/**
+		 * Returns true if the publisher had more entities than the segment could hold
+		 *
+		 * @return true if the current snapshot is truncated
+		 */
+		bool isTruncated() { return truncated; };
+
+		/**
+		 * Returns the number of snapshot attempts that were retried due to a concurrent publish
+		 *
+		 * @return the number of retries
+		 */
+		long getRetryCount() { return retry_count; };
+
+	private:
+		bool attach();
+		void detach();
+
+		SceneHeader *header;
+		unsigned int mapping_size;
+		char name[64];
+
+		std::vector<SceneCursor> cursorBuffer;
+		std::vector<SceneObject> objectBuffer;
+		std::vector<SceneBlob> blobBuffer;
+		int cursor_count, object_count, blob_count;
+		long frame_id;
+		osc::int64 frame_time, publish_time;
+		bool truncated;
+		long retry_count;
+
+#ifdef WIN32
+		HANDLE mapping_handle;
+#endif
+	};
+}
+#endif /* INCLUDED_TUIOSCENEREADER_H */
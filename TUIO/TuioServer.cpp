@@ -18,57 +18,162 @@
 
 #include "TuioServer.h"
 #include "UdpSender.h"
+#include "TuioClock.h"
 
 using namespace TUIO;
 using namespace osc;
 
+#ifdef  WIN32
+static DWORD WINAPI EncoderThreadFunc( LPVOID obj )
+#else
+static void* EncoderThreadFunc( void* obj )
+#endif
+{
+	TuioServer *server = static_cast<TuioServer*>(obj);
+	server->runEncoderThread();
+	return 0;
+};
+
+#ifdef  WIN32
+static DWORD WINAPI WorkerThreadFunc( LPVOID obj )
+#else
+static void* WorkerThreadFunc( void* obj )
+#endif
+{
+	TuioServer *server = static_cast<TuioServer*>(obj);
+	server->runWorkerThread();
+	return 0;
+};
+
+// the object, cursor and blob profiles are the jobs of the parallel encoding
+#define PROFILE_JOBS 3
+
+static int64 frameMicros(TuioTime ttime) {
+	return (int64)ttime.getSeconds()*1000000 + (int64)ttime.getMicroseconds();
+}
+
+static int64 nextDeadline(int64 deadline, int interval, int64 now) {
+	// the deadline advances by whole intervals to keep the average rate, unless the profile was idle or fell behind
+	deadline += (int64)interval*1000;
+	if (deadline<=now) deadline = now + (int64)interval*1000;
+	return deadline;
+}
+
 TuioServer::TuioServer() 
-	:full_update			(false)
-	,periodic_update		(false)	
+	:keyframe_capture		(false)
+	,pipelined				(false)
+	,frame_pending			(false)
+	,encoding				(false)
+	,parallel				(false)
+	,job_frame				(NULL)
+	,next_job				(0)
+	,finished_jobs			(0)
+	,packed_encoding		(false)
+	,packed_fixed			(false)
+	,time_tags				(false)
+	,frame_timetag			(1)
+	,quantize_bits			(0)
+	,full_update			(false)
+	,periodic_update		(false)
 	,objectProfileEnabled	(true)
 	,cursorProfileEnabled	(true)
 	,blobProfileEnabled		(true)
 	,source_name			(NULL)
+	,scenePublisher			(NULL)
 {
 	OscSender *oscsend = new UdpSender();
 	initialize(oscsend);
 }
 
 TuioServer::TuioServer(const char *host, int port) 
-:full_update			(false)
-,periodic_update		(false)	
+:keyframe_capture		(false)
+,pipelined				(false)
+,frame_pending			(false)
+,encoding				(false)
+,parallel				(false)
+,job_frame				(NULL)
+,next_job				(0)
+,finished_jobs			(0)
+,packed_encoding		(false)
+,packed_fixed			(false)
+,time_tags				(false)
+,frame_timetag			(1)
+,quantize_bits			(0)
+,full_update			(false)
+,periodic_update		(false)
 ,objectProfileEnabled	(true)
 ,cursorProfileEnabled	(true)
 ,blobProfileEnabled		(true)
 ,source_name			(NULL)
+,scenePublisher			(NULL)
 {
 	OscSender *oscsend = new UdpSender(host,port);
 	initialize(oscsend);
 }
 
 TuioServer::TuioServer(OscSender *oscsend)
-	:full_update			(false)
-	,periodic_update		(false)	
+	:keyframe_capture		(false)
+	,pipelined				(false)
+	,frame_pending			(false)
+	,encoding				(false)
+	,parallel				(false)
+	,job_frame				(NULL)
+	,next_job				(0)
+	,finished_jobs			(0)
+	,packed_encoding		(false)
+	,packed_fixed			(false)
+	,time_tags				(false)
+	,frame_timetag			(1)
+	,quantize_bits			(0)
+	,full_update			(false)
+	,periodic_update		(false)
 	,objectProfileEnabled	(true)
 	,cursorProfileEnabled	(true)
 	,blobProfileEnabled		(true)
 	,source_name			(NULL)
+	,scenePublisher			(NULL)
 {
 	initialize(oscsend);
 }
 
 void TuioServer::initialize(OscSender *oscsend) {
 	
+#ifdef WIN32
+	pipelineMutex = CreateMutex(NULL,FALSE,NULL);
+	frameEvent = CreateEvent(NULL,FALSE,FALSE,NULL);
+	idleEvent = CreateEvent(NULL,FALSE,FALSE,NULL);
+#else
+	pthread_mutex_init(&pipelineMutex,NULL);
+	pthread_cond_init(&frameCond,NULL);
+	pthread_cond_init(&idleCond,NULL);
+#endif
+#ifdef WIN32
+	workerMutex = CreateMutex(NULL,FALSE,NULL);
+	jobEvent = CreateEvent(NULL,TRUE,FALSE,NULL);
+	doneEvent = CreateEvent(NULL,FALSE,FALSE,NULL);
+#else
+	pthread_mutex_init(&workerMutex,NULL);
+	pthread_cond_init(&jobCond,NULL);
+	pthread_cond_init(&doneCond,NULL);
+#endif
+	backFrame = &frameBuffer[0];
+	frontFrame = &frameBuffer[1];
+	
 	senderList.push_back(oscsend);
-	int size = oscsend->getBufferSize();
-	oscBuffer = new char[size];
-	oscPacket = new osc::OutboundPacketStream(oscBuffer,size);
-	fullBuffer = new char[size];
-	fullPacket = new osc::OutboundPacketStream(oscBuffer,size);
+	oscsend->invalidateKeyframe();
+	buffer_size = oscsend->getBufferSize();
+	initEncoder(&objectEncoder);
+	initEncoder(&cursorEncoder);
+	initEncoder(&blobEncoder);
 	
 	objectUpdateTime = TuioTime(currentFrameTime);
 	cursorUpdateTime = TuioTime(currentFrameTime);
 	blobUpdateTime = TuioTime(currentFrameTime);
+	periodic_interval = 1000;
+	
+	object_interval = cursor_interval = blob_interval = 0;
+	objectPending = cursorPending = blobPending = -1;
+	objectDeadline = cursorDeadline = blobDeadline = 0;
 	
 	if (cursorProfileEnabled) sendEmptyCursorBundle();
 	if (objectProfileEnabled) sendEmptyObjectBundle();
@@ -81,6 +186,9 @@ void TuioServer::initialize(OscSender *oscsend) {
 
 TuioServer::~TuioServer() {
 
+	enablePipelinedCommit(false);
+	enableParallelEncoding(false);
+	
 	initFrame(TuioTime::getSessionTime());
 	stopUntouchedMovingCursors();
 	stopUntouchedMovingObjects();
@@ -91,18 +199,42 @@ TuioServer::~TuioServer() {
 	removeUntouchedStoppedObjects();
 	removeUntouchedStoppedBlobs();
 	
-	if (cursorProfileEnabled) sendEmptyCursorBundle();
-	if (objectProfileEnabled) sendEmptyObjectBundle();
-	if (blobProfileEnabled) sendEmptyBlobBundle();
+	for (int pass=0;pass<2;pass++) {
+		packed_encoding = (pass==1);
+		if (cursorProfileEnabled) sendEmptyCursorBundle();
+		if (objectProfileEnabled) sendEmptyObjectBundle();
+		if (blobProfileEnabled) sendEmptyBlobBundle();
+	}
+	packed_encoding = false;
 	
-	delete []oscBuffer;
-	delete oscPacket;
-	delete []fullBuffer;
-	delete fullPacket;
+	releaseEncoder(&objectEncoder);
+	releaseEncoder(&cursorEncoder);
+	releaseEncoder(&blobEncoder);
 	
 	if (source_name) delete[] source_name;
+	if (scenePublisher) delete scenePublisher;
+#ifdef WIN32
+	CloseHandle(pipelineMutex);
+	CloseHandle(frameEvent);
+	CloseHandle(idleEvent);
+#else
+	pthread_mutex_destroy(&pipelineMutex);
+	pthread_cond_destroy(&frameCond);
+	pthread_cond_destroy(&idleCond);
+#endif
+#ifdef WIN32
+	CloseHandle(workerMutex);
+	CloseHandle(jobEvent);
+	CloseHandle(doneEvent);
+#else
+	pthread_mutex_destroy(&workerMutex);
+	pthread_cond_destroy(&jobCond);
+	pthread_cond_destroy(&doneCond);
+#endif
 	for (unsigned int i=0;i<senderList.size();i++)
 		delete senderList[i];
+	for (unsigned int i=0;i<packedSenderList.size();i++)
+		delete packedSenderList[i];
 }
 
 
@@ -113,28 +245,135 @@ void TuioServer::addOscSender(OscSender *sender) {
 		setSourceName(source_name);
 	}*/ 
 	
+	waitForEncoder();
+	checkBufferSize(sender);
+	senderList.push_back(sender);
+	sender->invalidateKeyframe();
+}
+
+void TuioServer::addPackedOscSender(OscSender *sender) {
+
+	waitForEncoder();
+	checkBufferSize(sender);
+	packedSenderList.push_back(sender);
+	sender->invalidateKeyframe();
+}
+
+void TuioServer::enablePackedFixedPositions(bool flag) {
+	waitForEncoder();
+	packed_fixed = flag;
+}
+
+void TuioServer::enableQuantization(int bits) {
+	if (bits<2) bits = 2;
+	else if (bits>16) bits = 16;
+	waitForEncoder();
+	quantize_bits = bits;
+}
+
+void TuioServer::disableQuantization() {
+	waitForEncoder();
+	quantize_bits = 0;
+}
+
+void TuioServer::enableTimeTags(bool flag) {
+	waitForEncoder();
+	time_tags = flag;
+}
+
+void TuioServer::setScenePublisher(TuioScenePublisher *publisher) {
+
+	if ((scenePublisher) && (scenePublisher!=publisher)) delete scenePublisher;
+	scenePublisher = publisher;
+	if (scenePublisher) scenePublisher->publish(cursorList, objectList, blobList, currentFrame, currentFrameTime);
+}
+
+void TuioServer::checkBufferSize(OscSender *sender) {
+	
 	// resize packets to smallest transport method
 	unsigned int size = sender->getBufferSize();
-	if (size<oscPacket->Capacity()) {
-		osc::OutboundPacketStream *temp = oscPacket;
-		oscPacket = new osc::OutboundPacketStream(oscBuffer,size);
-		delete temp;
-		temp = fullPacket;
-		fullPacket = new osc::OutboundPacketStream(oscBuffer,size);
-		delete temp;
-		
+	if (size<buffer_size) {
+		buffer_size = size;
+		ProfileEncoder *encoders[PROFILE_JOBS] = { &objectEncoder, &cursorEncoder, &blobEncoder };
+		for (int i=0;i<PROFILE_JOBS;i++) {
+			ProfileEncoder *encoder = encoders[i];
+			for (unsigned int j=0;j<encoder->packetList.size();j++) {
+				delete encoder->packetList[j];
+				encoder->packetList[j] = new osc::OutboundPacketStream(encoder->bufferList[j],size);
+			}
+			encoder->oscPacket = encoder->packetList[encoder->packet_count];
+		}
 	}
-	
-	senderList.push_back(sender);
 }
 
-void TuioServer::deliverOscPacket(osc::OutboundPacketStream  *packet) {
+void TuioServer::initEncoder(ProfileEncoder *encoder) {
+	char *buffer = new char[buffer_size];
+	encoder->bufferList.push_back(buffer);
+	encoder->packetList.push_back(new osc::OutboundPacketStream(buffer,buffer_size));
+	encoder->oscPacket = encoder->packetList[0];
+	encoder->packedBuffer = new char[buffer_size];
+	encoder->packed_size = 0;
+	encoder->packet_count = 0;
+	encoder->commit_count = 0;
+	encoder->deferred = false;
+}
 
-	for (unsigned int i=0;i<senderList.size();i++)
-		senderList[i]->sendOscPacket(packet);
+void TuioServer::releaseEncoder(ProfileEncoder *encoder) {
+	for (unsigned int i=0;i<encoder->packetList.size();i++) {
+		delete encoder->packetList[i];
+		delete []encoder->bufferList[i];
+	}
+	encoder->packetList.clear();
+	encoder->bufferList.clear();
+	delete []encoder->packedBuffer;
+}
+
+bool TuioServer::packetFull(ProfileEncoder *encoder, unsigned int message_size) {
+	// the message size covers the next record and the fseq message, the packed records still need the pset message around them
+	if (packed_encoding) message_size += PACKED_MESSAGE_OVERHEAD;
+	return ((encoder->oscPacket->Capacity()-encoder->oscPacket->Size()-encoder->packed_size)<message_size);
+}
+
+void TuioServer::deliverOscPacket(ProfileEncoder *encoder) {
+
+	if (encoder->deferred) {
+		// the next bundle of this profile is encoded into a separate packet, the packets are only allocated once
+		encoder->packet_count++;
+		if (encoder->packet_count==encoder->packetList.size()) {
+			char *buffer = new char[buffer_size];
+			encoder->bufferList.push_back(buffer);
+			encoder->packetList.push_back(new osc::OutboundPacketStream(buffer,buffer_size));
+		}
+		encoder->oscPacket = encoder->packetList[encoder->packet_count];
+		return;
+	}
+
+	osc::OutboundPacketStream *packet = encoder->oscPacket;
+	if (keyframe_capture) {
+		keyframe.push_back(std::string(packet->Data(), packet->Size()));
+		return;
+	}
+
+	if (packed_encoding) {
+		for (unsigned int i=0;i<packedSenderList.size();i++)
+			packedSenderList[i]->sendOscPacket(packet);
+	} else {
+		for (unsigned int i=0;i<senderList.size();i++)
+			senderList[i]->sendOscPacket(packet);
+	}
+}
+
+void TuioServer::deliverDeferredPackets(ProfileEncoder *encoder, unsigned int first, unsigned int last) {
+
+	std::vector<OscSender*> &senders = packed_encoding ? packedSenderList : senderList;
+	for (unsigned int i=first;i<last;i++) {
+		for (unsigned int j=0;j<senders.size();j++)
+			senders[j]->sendOscPacket(encoder->packetList[i]);
+	}
 }
 
 void TuioServer::setSourceName(const char *name, const char *ip) {
+	waitForEncoder();
 	if (!source_name) source_name = new char[256];
 	snprintf(source_name,256,"%s@%s",name,ip);
 }
@@ -142,6 +381,7 @@ void TuioServer::setSourceName(const char *name, const char *ip) {
 
 void TuioServer::setSourceName(const char *src) {
 	
+	waitForEncoder();
 	if (!source_name) source_name = new char[256];
 
 	/*if (senderList[0]->isLocal()) {
@@ -181,454 +421,815 @@ void TuioServer::setSourceName(const char *src) {
 
 void TuioServer::commitFrame() {
 	TuioManager::commitFrame();
+	if (scenePublisher) scenePublisher->publish(cursorList, objectList, blobList, currentFrame, currentFrameTime);
+
+	if (time_tags) {
+		// the frame time is relative to the session start, therefore its age is subtracted from the system time
+		TuioTime frameAge = TuioTime::getSessionTime() - currentFrameTime;
+		osc::int64 age = (osc::int64)frameAge.getSeconds()*1000000000 + (osc::int64)frameAge.getMicroseconds()*1000;
+		frame_timetag = TuioClock::getTimeTag(TuioClock::getSystemTime() - age);
+	}
+	
+	// the changes of each profile remain pending until its output interval has passed
+	int64 now = frameMicros(currentFrameTime);
+	if (updateObject && (objectPending<0)) objectPending = now;
+	if (updateCursor && (cursorPending<0)) cursorPending = now;
+	if (updateBlob && (blobPending<0)) blobPending = now;
+	updateObject = (objectPending>=0) && (now>=objectDeadline);
+	updateCursor = (cursorPending>=0) && (now>=cursorDeadline);
+	updateBlob = (blobPending>=0) && (now>=blobDeadline);
+	
+	// check which profiles are due for a periodic update, only the longest waiting one is refreshed in this frame
+	bool periodicObject = false;
+	bool periodicCursor = false;
+	bool periodicBlob = false;
+	if (periodic_update) {
+		int64 interval = (int64)periodic_interval*1000;
+		int64 objectAge = now-frameMicros(objectUpdateTime);
+		int64 cursorAge = now-frameMicros(cursorUpdateTime);
+		int64 blobAge = now-frameMicros(blobUpdateTime);
+		bool dueObject = (objectPending<0) && objectProfileEnabled && (now>=objectDeadline) && (objectAge>=interval);
+		bool dueCursor = (cursorPending<0) && cursorProfileEnabled && (now>=cursorDeadline) && (cursorAge>=interval);
+		bool dueBlob = (blobPending<0) && blobProfileEnabled && (now>=blobDeadline) && (blobAge>=interval);
 		
-	if(updateObject) {
-		startObjectBundle();
-		for (std::list<TuioObject*>::iterator  tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
-			
-			// start a new packet if we exceed the packet capacity
-			if ((oscPacket->Capacity()-oscPacket->Size())<OBJ_MESSAGE_SIZE) {
-				sendObjectBundle(currentFrame);
-				startObjectBundle();
-			}
-			TuioObject *tobj = (*tuioObject);
-			if  ((full_update) || (tobj->getTuioTime()==currentFrameTime)) addObjectMessage(tobj);
-		}
+		if (dueObject && (!dueCursor || objectAge>=cursorAge) && (!dueBlob || objectAge>=blobAge)) periodicObject = true;
+		else if (dueCursor && (!dueBlob || cursorAge>=blobAge)) periodicCursor = true;
+		else if (dueBlob) periodicBlob = true;
+	}
+	
+	if (updateObject || periodicObject) {
 		objectUpdateTime = TuioTime(currentFrameTime);
-		sendObjectBundle(currentFrame);
-	} else if (objectProfileEnabled && periodic_update) {
+		objectDeadline = nextDeadline(objectDeadline, object_interval, now);
+	}
+	if (updateCursor || periodicCursor) {
+		cursorUpdateTime = TuioTime(currentFrameTime);
+		cursorDeadline = nextDeadline(cursorDeadline, cursor_interval, now);
+	}
+	if (updateBlob || periodicBlob) {
+		blobUpdateTime = TuioTime(currentFrameTime);
+		blobDeadline = nextDeadline(blobDeadline, blob_interval, now);
+	}
+	
+	submitFrame(periodicObject, periodicCursor, periodicBlob, false);
+	
+	if (updateObject) objectPending = -1;
+	if (updateCursor) cursorPending = -1;
+	if (updateBlob) blobPending = -1;
+	updateObject = false;
+	updateCursor = false;
+	updateBlob = false;
+}
+
+void TuioServer::submitFrame(bool periodicObject, bool periodicCursor, bool periodicBlob, bool fullMessages) {
+	
+	FrameSnapshot *frame = NULL;
+	bool merge = false;
+	if (pipelined) {
+		// a frame that was not picked up by the encoder thread yet is taken back and combined with this one
+		lockPipeline();
+		merge = frame_pending;
+		frame_pending = false;
+		frame = backFrame;
+		unlockPipeline();
+	} else frame = backFrame;
+	
+	if (!merge) {
+		frame->updateObject = frame->updateCursor = frame->updateBlob = false;
+		frame->periodicObject = frame->periodicCursor = frame->periodicBlob = false;
+		frame->fullMessages = false;
+	}
+	
+	frame->frame = currentFrame;
+	frame->timetag = frame_timetag;
+	frame->fullUpdate = full_update;
+	if (!fullMessages) {
+		// a merged frame keeps the older changes of its profiles
+		if (updateObject && !frame->updateObject) frame->objectSince = objectPending;
+		if (updateCursor && !frame->updateCursor) frame->cursorSince = cursorPending;
+		if (updateBlob && !frame->updateBlob) frame->blobSince = blobPending;
+		frame->updateObject |= updateObject;
+		frame->updateCursor |= updateCursor;
+		frame->updateBlob |= updateBlob;
+	}
+	frame->periodicObject = (frame->periodicObject || periodicObject) && !frame->updateObject;
+	frame->periodicCursor = (frame->periodicCursor || periodicCursor) && !frame->updateCursor;
+	frame->periodicBlob = (frame->periodicBlob || periodicBlob) && !frame->updateBlob;
+	frame->fullMessages |= fullMessages;
+	captureFrame(frame);
+	
+	if (!pipelined) {
+		deliverFrame(frame);
+		return;
+	}
+	
+	lockPipeline();
+	frame_pending = true;
+#ifdef WIN32
+	SetEvent(frameEvent);
+#else
+	pthread_cond_signal(&frameCond);
+#endif
+	unlockPipeline();
+}
+
+void TuioServer::captureFrame(FrameSnapshot *frame) {
+	
+	// the inverted axes are applied to the snapshot, which is then encoded without any further transformation
+	frame->cursors.resize(cursorList.size());
+	unsigned int index = 0;
+	for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
+		TuioCursor *tcur = (*tuioCursor);
+		CursorState &state = frame->cursors[index++];
+		state.session_id = (int32)tcur->getSessionID();
+		state.x = invert_x ? 1-tcur->getX() : tcur->getX();
+		state.y = invert_y ? 1-tcur->getY() : tcur->getY();
+		state.x_speed = invert_x ? -1*tcur->getXSpeed() : tcur->getXSpeed();
+		state.y_speed = invert_y ? -1*tcur->getYSpeed() : tcur->getYSpeed();
+		state.motion_accel = tcur->getMotionAccel();
+		state.update_time = frameMicros(tcur->getTuioTime());
+	}
+	
+	frame->objects.resize(objectList.size());
+	index = 0;
+	for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
+		TuioObject *tobj = (*tuioObject);
+		ObjectState &state = frame->objects[index++];
+		state.session_id = (int32)tobj->getSessionID();
+		state.symbol_id = tobj->getSymbolID();
+		state.x = invert_x ? 1-tobj->getX() : tobj->getX();
+		state.y = invert_y ? 1-tobj->getY() : tobj->getY();
+		state.angle = invert_a ? 2.0f*(float)M_PI-tobj->getAngle() : tobj->getAngle();
+		state.x_speed = invert_x ? -1*tobj->getXSpeed() : tobj->getXSpeed();
+		state.y_speed = invert_y ? -1*tobj->getYSpeed() : tobj->getYSpeed();
+		state.rotation_speed = invert_a ? -1*tobj->getRotationSpeed() : tobj->getRotationSpeed();
+		state.motion_accel = tobj->getMotionAccel();
+		state.rotation_accel = tobj->getRotationAccel();
+		state.update_time = frameMicros(tobj->getTuioTime());
+	}
+	
+	frame->blobs.resize(blobList.size());
+	index = 0;
+	for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
+		TuioBlob *tblb = (*tuioBlob);
+		BlobState &state = frame->blobs[index++];
+		state.session_id = (int32)tblb->getSessionID();
+		state.x = invert_x ? 1-tblb->getX() : tblb->getX();
+		state.y = invert_y ? 1-tblb->getY() : tblb->getY();
+		state.angle = invert_a ? 2.0f*(float)M_PI-tblb->getAngle() : tblb->getAngle();
+		state.width = tblb->getWidth();
+		state.height = tblb->getHeight();
+		state.area = tblb->getArea();
+		state.x_speed = invert_x ? -1*tblb->getXSpeed() : tblb->getXSpeed();
+		state.y_speed = invert_y ? -1*tblb->getYSpeed() : tblb->getYSpeed();
+		state.rotation_speed = invert_a ? -1*tblb->getRotationSpeed() : tblb->getRotationSpeed();
+		state.motion_accel = tblb->getMotionAccel();
+		state.rotation_accel = tblb->getRotationAccel();
+		state.update_time = frameMicros(tblb->getTuioTime());
+	}
+}
+
+void TuioServer::deliverFrame(FrameSnapshot *frame) {
+	
+	if (time_tags) {
+		for (unsigned int i=0;i<senderList.size();i++) senderList[i]->answerPings();
+		for (unsigned int i=0;i<packedSenderList.size();i++) packedSenderList[i]->answerPings();
+	}
+	
+	// the cached keyframes are outdated before the changes are delivered
+	if (frame->updateObject || frame->updateCursor || frame->updateBlob) {
+		for (unsigned int i=0;i<senderList.size();i++) senderList[i]->invalidateKeyframe();
+		for (unsigned int i=0;i<packedSenderList.size();i++) packedSenderList[i]->invalidateKeyframe();
+	}
+	
+	// encode the regular profiles first and the packed profiles if requested
+	for (int pass=0;pass<2;pass++) {
+		packed_encoding = (pass==1);
+		if (packed_encoding && packedSenderList.empty()) break;
+		encodeFrame(frame);
+	}
+	packed_encoding = false;
+	
+	updateKeyframes(frame);
+}
+
+void TuioServer::encodeFrame(FrameSnapshot *frame) {
+	
+	int profiles = 0;
+	if (frame->updateObject || frame->periodicObject || frame->fullMessages) profiles++;
+	if (frame->updateCursor || frame->periodicCursor || frame->fullMessages) profiles++;
+	if (frame->updateBlob || frame->periodicBlob || frame->fullMessages) profiles++;
+	
+	if (!parallel || profiles<2) {
+		if (frame->updateObject || frame->periodicObject) commitObjectBundle(frame, frame->periodicObject);
+		if (frame->updateCursor || frame->periodicCursor) commitCursorBundle(frame, frame->periodicCursor);
+		if (frame->updateBlob || frame->periodicBlob) commitBlobBundle(frame, frame->periodicBlob);
+		if (frame->fullMessages) sendFullBundles(frame);
+		return;
+	}
+	
+	// the profiles are dispatched to the worker threads, while this thread also takes its share
+	lockWorkers();
+	job_frame = frame;
+	next_job = 0;
+	finished_jobs = 0;
+#ifdef WIN32
+	SetEvent(jobEvent);
+#else
+	pthread_cond_broadcast(&jobCond);
+#endif
+	encodeJobs();
+	while (finished_jobs<PROFILE_JOBS) {
+#ifdef WIN32
+		unlockWorkers();
+		WaitForSingleObject(doneEvent, INFINITE);
+		lockWorkers();
+#else
+		pthread_cond_wait(&doneCond, &workerMutex);
+#endif
+	}
+	job_frame = NULL;
+	unlockWorkers();
+	
+	// the packets are delivered in the same order as with the sequential encoding
+	deliverDeferredPackets(&objectEncoder, 0, objectEncoder.commit_count);
+	deliverDeferredPackets(&cursorEncoder, 0, cursorEncoder.commit_count);
+	deliverDeferredPackets(&blobEncoder, 0, blobEncoder.commit_count);
+	deliverDeferredPackets(&cursorEncoder, cursorEncoder.commit_count, cursorEncoder.packet_count);
+	deliverDeferredPackets(&objectEncoder, objectEncoder.commit_count, objectEncoder.packet_count);
+	deliverDeferredPackets(&blobEncoder, blobEncoder.commit_count, blobEncoder.packet_count);
+	objectEncoder.deferred = cursorEncoder.deferred = blobEncoder.deferred = false;
+}
+
+void TuioServer::encodeJobs() {
+	
+	// this is called with the worker lock, which is released while a profile is encoded
+	while ((job_frame) && (next_job<PROFILE_JOBS)) {
+		int profile = next_job++;
+#ifdef WIN32
+		if (next_job==PROFILE_JOBS) ResetEvent(jobEvent);
+#endif
+		FrameSnapshot *frame = job_frame;
+		unlockWorkers();
+		encodeProfile(profile, frame);
+		lockWorkers();
 		
-		TuioTime timeCheck = currentFrameTime - objectUpdateTime;
-		if(timeCheck.getSeconds()>=update_interval) {
-			objectUpdateTime = TuioTime(currentFrameTime);
-			startObjectBundle();
-			if  (full_update) {
-				for (std::list<TuioObject*>::iterator  tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
-					// start a new packet if we exceed the packet capacity
-					if ((oscPacket->Capacity()-oscPacket->Size())<OBJ_MESSAGE_SIZE) {
-						sendObjectBundle(currentFrame);
-						startObjectBundle();
-					}
-					addObjectMessage(*tuioObject);
-				}
-			}
-			sendObjectBundle(currentFrame);
+		finished_jobs++;
+		if (finished_jobs==PROFILE_JOBS) {
+#ifdef WIN32
+			SetEvent(doneEvent);
+#else
+			pthread_cond_signal(&doneCond);
+#endif
 		}
 	}
-	updateObject = false;
+}
+
+void TuioServer::encodeProfile(int profile, FrameSnapshot *frame) {
+	
+	ProfileEncoder *encoder = &objectEncoder;
+	if (profile==1) encoder = &cursorEncoder;
+	else if (profile==2) encoder = &blobEncoder;
+	
+	encoder->deferred = true;
+	encoder->packet_count = 0;
+	encoder->oscPacket = encoder->packetList[0];
+	
+	// the full bundles follow the regular bundles of all profiles, therefore their packets are counted separately
+	if (profile==0) {
+		if (frame->updateObject || frame->periodicObject) commitObjectBundle(frame, frame->periodicObject);
+		encoder->commit_count = encoder->packet_count;
+		if (frame->fullMessages) sendFullObjectBundle(frame);
+	} else if (profile==1) {
+		if (frame->updateCursor || frame->periodicCursor) commitCursorBundle(frame, frame->periodicCursor);
+		encoder->commit_count = encoder->packet_count;
+		if (frame->fullMessages) sendFullCursorBundle(frame);
+	} else {
+		if (frame->updateBlob || frame->periodicBlob) commitBlobBundle(frame, frame->periodicBlob);
+		encoder->commit_count = encoder->packet_count;
+		if (frame->fullMessages) sendFullBlobBundle(frame);
+	}
+}
+
+void TuioServer::enableParallelEncoding(bool flag) {
+	
+	if (flag==parallel) return;
+	waitForEncoder();
+	
+	if (flag) {
+		parallel = true;
+#ifdef WIN32
+		ResetEvent(jobEvent);
+#endif
+		for (int i=0;i<PARALLEL_ENCODER_THREADS;i++) {
+#ifdef WIN32
+			worker_thread[i] = CreateThread( 0, 0, WorkerThreadFunc, this, 0, &WorkerThreadId[i] );
+#else
+			pthread_create(&worker_thread[i] , NULL, WorkerThreadFunc, this);
+#endif
+		}
+		return;
+	}
+	
+	lockWorkers();
+	parallel = false;
+#ifdef WIN32
+	SetEvent(jobEvent);
+#else
+	pthread_cond_broadcast(&jobCond);
+#endif
+	unlockWorkers();
+	for (int i=0;i<PARALLEL_ENCODER_THREADS;i++) {
+#ifdef WIN32
+		WaitForSingleObject(worker_thread[i], INFINITE);
+		CloseHandle(worker_thread[i]);
+#else
+		pthread_join(worker_thread[i], NULL);
+#endif
+	}
+}
+
+void TuioServer::runWorkerThread() {
+	
+	lockWorkers();
+	for (;;) {
+		encodeJobs();
+		if (!parallel) break;
+		
+#ifdef WIN32
+		unlockWorkers();
+		WaitForSingleObject(jobEvent, INFINITE);
+		lockWorkers();
+#else
+		pthread_cond_wait(&jobCond, &workerMutex);
+#endif
+	}
+	unlockWorkers();
+}
+
+void TuioServer::lockWorkers() {
+#ifdef WIN32
+	WaitForSingleObject(workerMutex, INFINITE);
+#else
+	pthread_mutex_lock(&workerMutex);
+#endif
+}
 
-	if(updateCursor) {
-		startCursorBundle();
-		for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
+void TuioServer::unlockWorkers() {
+#ifdef WIN32
+	ReleaseMutex(workerMutex);
+#else
+	pthread_mutex_unlock(&workerMutex);
+#endif
+}
+
+void TuioServer::enablePipelinedCommit(bool flag) {
+	
+	if (flag==pipelined) return;
+	
+	if (flag) {
+		pipelined = true;
+#ifdef WIN32
+		encoder_thread = CreateThread( 0, 0, EncoderThreadFunc, this, 0, &EncoderThreadId );
+#else
+		pthread_create(&encoder_thread , NULL, EncoderThreadFunc, this);
+#endif
+		return;
+	}
+	
+	// the encoder thread delivers the pending frame before it stops
+	lockPipeline();
+	pipelined = false;
+#ifdef WIN32
+	SetEvent(frameEvent);
+	unlockPipeline();
+	WaitForSingleObject(encoder_thread, INFINITE);
+	CloseHandle(encoder_thread);
+#else
+	pthread_cond_signal(&frameCond);
+	unlockPipeline();
+	pthread_join(encoder_thread, NULL);
+#endif
+}
+
+void TuioServer::runEncoderThread() {
+	
+	lockPipeline();
+	for (;;) {
+		if (frame_pending) {
+			FrameSnapshot *frame = backFrame;
+			backFrame = frontFrame;
+			frontFrame = frame;
+			frame_pending = false;
+			encoding = true;
+			unlockPipeline();
 			
-			// start a new packet if we exceed the packet capacity
-			if ((oscPacket->Capacity()-oscPacket->Size())<CUR_MESSAGE_SIZE) {
-				sendCursorBundle(currentFrame);
-				startCursorBundle();
-			}
-			TuioCursor *tcur = (*tuioCursor);
-			if ((full_update) || (tcur->getTuioTime()==currentFrameTime)) addCursorMessage(tcur);				
+			deliverFrame(frame);
+			
+			lockPipeline();
+			encoding = false;
+#ifdef WIN32
+			SetEvent(idleEvent);
+#else
+			pthread_cond_broadcast(&idleCond);
+#endif
+			continue;
 		}
-		cursorUpdateTime = TuioTime(currentFrameTime);
-		sendCursorBundle(currentFrame);
-	} else if (cursorProfileEnabled && periodic_update) {
-		TuioTime timeCheck = currentFrameTime - cursorUpdateTime;
-		if(timeCheck.getSeconds()>=update_interval) {
-			cursorUpdateTime = TuioTime(currentFrameTime);
-			startCursorBundle();
-			if (full_update) {
-				for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
-					// start a new packet if we exceed the packet capacity
-					if ((oscPacket->Capacity()-oscPacket->Size())<CUR_MESSAGE_SIZE) {
-						sendCursorBundle(currentFrame);
-						startCursorBundle();
-					}
-					addCursorMessage(*tuioCursor);
-				}
+		if (!pipelined) break;
+		
+#ifdef WIN32
+		unlockPipeline();
+		WaitForSingleObject(frameEvent, INFINITE);
+		lockPipeline();
+#else
+		pthread_cond_wait(&frameCond, &pipelineMutex);
+#endif
+	}
+	unlockPipeline();
+}
+
+void TuioServer::waitForEncoder() {
+	
+	if (!pipelined) return;
+	lockPipeline();
+	while (frame_pending || encoding) {
+#ifdef WIN32
+		unlockPipeline();
+		WaitForSingleObject(idleEvent, INFINITE);
+		lockPipeline();
+#else
+		pthread_cond_wait(&idleCond, &pipelineMutex);
+#endif
+	}
+	unlockPipeline();
+}
+
+void TuioServer::lockPipeline() {
+#ifdef WIN32
+	WaitForSingleObject(pipelineMutex, INFINITE);
+#else
+	pthread_mutex_lock(&pipelineMutex);
+#endif
+}
+
+void TuioServer::unlockPipeline() {
+#ifdef WIN32
+	ReleaseMutex(pipelineMutex);
+#else
+	pthread_mutex_unlock(&pipelineMutex);
+#endif
+}
+
+void TuioServer::commitObjectBundle(FrameSnapshot *frame, bool periodic) {
+	startObjectBundle(frame);
+	if (!periodic || frame->fullUpdate) {
+		for (unsigned int i=0;i<frame->objects.size();i++) {
+			
+			// start a new packet if we exceed the packet capacity
+			if (packetFull(&objectEncoder, OBJ_MESSAGE_SIZE)) {
+				sendObjectBundle(frame->frame);
+				startObjectBundle(frame);
 			}
-			sendCursorBundle(currentFrame);
+			if ((frame->fullUpdate) || (frame->objects[i].update_time>=frame->objectSince)) addObjectMessage(frame->objects[i]);
 		}
 	}
-	updateCursor = false;
-	
-	if(updateBlob) {
-		startBlobBundle();
-		for (std::list<TuioBlob*>::iterator tuioBlob =blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
+	sendObjectBundle(frame->frame);
+}
+
+void TuioServer::commitCursorBundle(FrameSnapshot *frame, bool periodic) {
+	startCursorBundle(frame);
+	if (!periodic || frame->fullUpdate) {
+		for (unsigned int i=0;i<frame->cursors.size();i++) {
+			
 			// start a new packet if we exceed the packet capacity
-			if ((oscPacket->Capacity()-oscPacket->Size())<BLB_MESSAGE_SIZE) {
-				sendBlobBundle(currentFrame);
-				startBlobBundle();
+			if (packetFull(&cursorEncoder, CUR_MESSAGE_SIZE)) {
+				sendCursorBundle(frame->frame);
+				startCursorBundle(frame);
 			}
-			TuioBlob *tblb = (*tuioBlob);
-			if ((full_update) || (tblb->getTuioTime()==currentFrameTime)) addBlobMessage(tblb);		
+			if ((frame->fullUpdate) || (frame->cursors[i].update_time>=frame->cursorSince)) addCursorMessage(frame->cursors[i]);
 		}
-		blobUpdateTime = TuioTime(currentFrameTime);
-		sendBlobBundle(currentFrame);
-	} else if (blobProfileEnabled && periodic_update) {
-		TuioTime timeCheck = currentFrameTime - blobUpdateTime;
-		if(timeCheck.getSeconds()>=update_interval) {
-			blobUpdateTime = TuioTime(currentFrameTime);
-			startBlobBundle();
-			if (full_update) {
-				for (std::list<TuioBlob*>::iterator tuioBlob =blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
-				
-					// start a new packet if we exceed the packet capacity
-					if ((oscPacket->Capacity()-oscPacket->Size())<BLB_MESSAGE_SIZE) {
-						sendBlobBundle(currentFrame);
-						startBlobBundle();
-					}
-					addBlobMessage(*tuioBlob);
-				}
+	}
+	sendCursorBundle(frame->frame);
+}
+
+void TuioServer::commitBlobBundle(FrameSnapshot *frame, bool periodic) {
+	startBlobBundle(frame);
+	if (!periodic || frame->fullUpdate) {
+		for (unsigned int i=0;i<frame->blobs.size();i++) {
+			
+			// start a new packet if we exceed the packet capacity
+			if (packetFull(&blobEncoder, BLB_MESSAGE_SIZE)) {
+				sendBlobBundle(frame->frame);
+				startBlobBundle(frame);
 			}
-			sendBlobBundle(currentFrame);
+			if ((frame->fullUpdate) || (frame->blobs[i].update_time>=frame->blobSince)) addBlobMessage(frame->blobs[i]);
 		}
 	}
-	updateBlob = false;
+	sendBlobBundle(frame->frame);
+}
+
+void TuioServer::addPackedMessage(ProfileEncoder *encoder, const char *profile) {
+	if (encoder->packed_size==0) return;
+	
+	int format = packed_fixed ? PACKED_FIXED16 : PACKED_FLOAT32;
+	(*encoder->oscPacket) << osc::BeginMessage( profile ) << "pset" << (int32)format << osc::Blob(encoder->packedBuffer,encoder->packed_size) << osc::EndMessage;
+	encoder->packed_size = 0;
+}
+
+void TuioServer::beginBundle(ProfileEncoder *encoder, osc::uint64 timetag) {
+	if (time_tags) (*encoder->oscPacket) << osc::BeginBundle(timetag);
+	else (*encoder->oscPacket) << osc::BeginBundleImmediate;
 }
 
 void TuioServer::sendEmptyCursorBundle() {
+	osc::OutboundPacketStream *oscPacket = cursorEncoder.oscPacket;
 	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
+	beginBundle(&cursorEncoder, frame_timetag);
 	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive" << osc::EndMessage;	
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << -1 << osc::EndMessage;
 	(*oscPacket) << osc::EndBundle;
-	deliverOscPacket( oscPacket );
+	deliverOscPacket( &cursorEncoder );
 }
 
-void TuioServer::startCursorBundle() {	
+void TuioServer::startCursorBundle(FrameSnapshot *frame) {	
+	osc::OutboundPacketStream *oscPacket = cursorEncoder.oscPacket;
 	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
+	cursorEncoder.packed_size = 0;
+	beginBundle(&cursorEncoder, frame->timetag);
 	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive";
-	for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
-		/*if ((*tuioCursor)->getTuioState()!=TUIO_ADDED)*/ (*oscPacket) << (int32)((*tuioCursor)->getSessionID());
+	for (unsigned int i=0;i<frame->cursors.size();i++) {
+		(*oscPacket) << frame->cursors[i].session_id;
 	}
 	(*oscPacket) << osc::EndMessage;	
 }
 
-void TuioServer::addCursorMessage(TuioCursor *tcur) {
+void TuioServer::addCursorMessage(const CursorState &tcur) {
+	osc::OutboundPacketStream *oscPacket = cursorEncoder.oscPacket;
 	
-	//if (tcur->getTuioState()==TUIO_ADDED) return;
-
-	float xpos = tcur->getX();
-	float xvel = tcur->getXSpeed();
-	if (invert_x) {
-		xpos = 1 - xpos;
-		xvel = -1 * xvel;
+	if (packed_encoding) {
+		char *record = &cursorEncoder.packedBuffer[cursorEncoder.packed_size];
+		record = packInt32(record,tcur.session_id);
+		if (packed_fixed) {
+			record = packFixed16(record,tcur.x);
+			record = packFixed16(record,tcur.y);
+		} else {
+			record = packFloat32(record,tcur.x);
+			record = packFloat32(record,tcur.y);
+		}
+		record = packFloat32(record,tcur.x_speed);
+		record = packFloat32(record,tcur.y_speed);
+		record = packFloat32(record,tcur.motion_accel);
+		cursorEncoder.packed_size = (unsigned int)(record-cursorEncoder.packedBuffer);
+		return;
 	}
-	float ypos = tcur->getY();
-	float yvel = tcur->getYSpeed();
-	if (invert_y) {
-		ypos = 1 - ypos;
-		yvel = -1 * yvel;
+
+	if (quantize_bits>0) {
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "set" << tcur.session_id;
+		(*oscPacket) << packQuantized(quantizeUnit(tcur.x,quantize_bits),quantizeUnit(tcur.y,quantize_bits));
+		(*oscPacket) << packQuantized(quantizeSpeed(tcur.x_speed,quantize_bits),quantizeSpeed(tcur.y_speed,quantize_bits));
+		(*oscPacket) << tcur.motion_accel << osc::EndMessage;
+		return;
 	}
 
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "set";
-	(*oscPacket) << (int32)(tcur->getSessionID()) << xpos << ypos;
-	(*oscPacket) << xvel << yvel << tcur->getMotionAccel();	
+	(*oscPacket) << tcur.session_id << tcur.x << tcur.y;
+	(*oscPacket) << tcur.x_speed << tcur.y_speed << tcur.motion_accel;	
 	(*oscPacket) << osc::EndMessage;
 }
 
 void TuioServer::sendCursorBundle(long fseq) {
+	osc::OutboundPacketStream *oscPacket = cursorEncoder.oscPacket;
+	addPackedMessage(&cursorEncoder, "/tuio/2Dcur");
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << (int32)fseq << osc::EndMessage;
 	(*oscPacket) << osc::EndBundle;
-	deliverOscPacket( oscPacket );
+	deliverOscPacket( &cursorEncoder );
 }
 
 void TuioServer::sendEmptyObjectBundle() {
+	osc::OutboundPacketStream *oscPacket = objectEncoder.oscPacket;
 	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
+	beginBundle(&objectEncoder, frame_timetag);
 	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive" << osc::EndMessage;	
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << -1 << osc::EndMessage;
 	(*oscPacket) << osc::EndBundle;
-	deliverOscPacket( oscPacket );
+	deliverOscPacket( &objectEncoder );
 }
 
-void TuioServer::startObjectBundle() {
+void TuioServer::startObjectBundle(FrameSnapshot *frame) {
+	osc::OutboundPacketStream *oscPacket = objectEncoder.oscPacket;
 	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
+	objectEncoder.packed_size = 0;
+	beginBundle(&objectEncoder, frame->timetag);
 	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive";
-	for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
-		(*oscPacket) << (int32)((*tuioObject)->getSessionID());	
+	for (unsigned int i=0;i<frame->objects.size();i++) {
+		(*oscPacket) << frame->objects[i].session_id;
 	}
 	(*oscPacket) << osc::EndMessage;
 }
 
-void TuioServer::addObjectMessage(TuioObject *tobj) {
+void TuioServer::addObjectMessage(const ObjectState &tobj) {
+	osc::OutboundPacketStream *oscPacket = objectEncoder.oscPacket;
 	
-	float xpos = tobj->getX();
-	float xvel = tobj->getXSpeed();
-	if (invert_x) {
-		xpos = 1 - xpos;
-		xvel = -1 * xvel;
-	}
-	float ypos = tobj->getY();
-	float yvel = tobj->getYSpeed();
-	if (invert_y) {
-		ypos = 1 - ypos;
-		yvel = -1 * yvel;
+	if (packed_encoding) {
+		char *record = &objectEncoder.packedBuffer[objectEncoder.packed_size];
+		record = packInt32(record,tobj.session_id);
+		record = packInt32(record,tobj.symbol_id);
+		if (packed_fixed) {
+			record = packFixed16(record,tobj.x);
+			record = packFixed16(record,tobj.y);
+		} else {
+			record = packFloat32(record,tobj.x);
+			record = packFloat32(record,tobj.y);
+		}
+		record = packFloat32(record,tobj.angle);
+		record = packFloat32(record,tobj.x_speed);
+		record = packFloat32(record,tobj.y_speed);
+		record = packFloat32(record,tobj.rotation_speed);
+		record = packFloat32(record,tobj.motion_accel);
+		record = packFloat32(record,tobj.rotation_accel);
+		objectEncoder.packed_size = (unsigned int)(record-objectEncoder.packedBuffer);
+		return;
 	}
-	float angle = tobj->getAngle();
-	float rvel = tobj->getRotationSpeed();
-	if (invert_a) {
-		angle = 2.0f*(float)M_PI - angle;
-		rvel = -1 * rvel;
+	
+	if (quantize_bits>0) {
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "set" << tobj.session_id << tobj.symbol_id;
+		(*oscPacket) << packQuantized(quantizeUnit(tobj.x,quantize_bits),quantizeUnit(tobj.y,quantize_bits));
+		(*oscPacket) << packQuantized(quantizeAngle(tobj.angle,quantize_bits),quantizeSpeed(tobj.rotation_speed,quantize_bits));
+		(*oscPacket) << packQuantized(quantizeSpeed(tobj.x_speed,quantize_bits),quantizeSpeed(tobj.y_speed,quantize_bits));
+		(*oscPacket) << tobj.motion_accel << tobj.rotation_accel << osc::EndMessage;
+		return;
 	}
 	
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "set";
-	(*oscPacket) << (int32)(tobj->getSessionID()) << tobj->getSymbolID() << xpos << ypos << angle;
-	(*oscPacket) << xvel << yvel << rvel << tobj->getMotionAccel() << tobj->getRotationAccel();	
+	(*oscPacket) << tobj.session_id << tobj.symbol_id << tobj.x << tobj.y << tobj.angle;
+	(*oscPacket) << tobj.x_speed << tobj.y_speed << tobj.rotation_speed << tobj.motion_accel << tobj.rotation_accel;	
 	(*oscPacket) << osc::EndMessage;
 }
 
 void TuioServer::sendObjectBundle(long fseq) {
+	osc::OutboundPacketStream *oscPacket = objectEncoder.oscPacket;
+	addPackedMessage(&objectEncoder, "/tuio/2Dobj");
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << (int32)fseq << osc::EndMessage;
 	(*oscPacket) << osc::EndBundle;
-	deliverOscPacket( oscPacket );
+	deliverOscPacket( &objectEncoder );
 }
 
 
 void TuioServer::sendEmptyBlobBundle() {
+	osc::OutboundPacketStream *oscPacket = blobEncoder.oscPacket;
 	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
+	beginBundle(&blobEncoder, frame_timetag);
 	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive" << osc::EndMessage;	
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << -1 << osc::EndMessage;
 	(*oscPacket) << osc::EndBundle;
-	deliverOscPacket( oscPacket );
+	deliverOscPacket( &blobEncoder );
 }
 
-void TuioServer::startBlobBundle() {	
+void TuioServer::startBlobBundle(FrameSnapshot *frame) {	
+	osc::OutboundPacketStream *oscPacket = blobEncoder.oscPacket;
 	oscPacket->Clear();	
-	(*oscPacket) << osc::BeginBundleImmediate;
+	blobEncoder.packed_size = 0;
+	beginBundle(&blobEncoder, frame->timetag);
 	if (source_name) (*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive";
-	for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
-		/*if ((*tuioBlob)->getTuioState()!=TUIO_ADDED)*/ (*oscPacket) << (int32)((*tuioBlob)->getSessionID());
+	for (unsigned int i=0;i<frame->blobs.size();i++) {
+		(*oscPacket) << frame->blobs[i].session_id;
 	}
 	(*oscPacket) << osc::EndMessage;	
 }
 
-void TuioServer::addBlobMessage(TuioBlob *tblb) {
+void TuioServer::addBlobMessage(const BlobState &tblb) {
+	osc::OutboundPacketStream *oscPacket = blobEncoder.oscPacket;
 	
-	//if (tblb->getTuioState()==TUIO_ADDED) return;
-	
-	float xpos = tblb->getX();
-	float xvel = tblb->getXSpeed();
-	if (invert_x) {
-		xpos = 1 - xpos;
-		xvel = -1 * xvel;
-	}
-	float ypos = tblb->getY();
-	float yvel = tblb->getYSpeed();
-	if (invert_y) {
-		ypos = 1 - ypos;
-		yvel = -1 * yvel;
+	if (packed_encoding) {
+		char *record = &blobEncoder.packedBuffer[blobEncoder.packed_size];
+		record = packInt32(record,tblb.session_id);
+		if (packed_fixed) {
+			record = packFixed16(record,tblb.x);
+			record = packFixed16(record,tblb.y);
+		} else {
+			record = packFloat32(record,tblb.x);
+			record = packFloat32(record,tblb.y);
+		}
+		record = packFloat32(record,tblb.angle);
+		record = packFloat32(record,tblb.width);
+		record = packFloat32(record,tblb.height);
+		record = packFloat32(record,tblb.area);
+		record = packFloat32(record,tblb.x_speed);
+		record = packFloat32(record,tblb.y_speed);
+		record = packFloat32(record,tblb.rotation_speed);
+		record = packFloat32(record,tblb.motion_accel);
+		record = packFloat32(record,tblb.rotation_accel);
+		blobEncoder.packed_size = (unsigned int)(record-blobEncoder.packedBuffer);
+		return;
 	}
-	float angle = tblb->getAngle();
-	float rvel = tblb->getRotationSpeed();
-	if (invert_a) {
-		angle = 2.0f*(float)M_PI - angle;
-		rvel = -1 * rvel;
+	
+	if (quantize_bits>0) {
+		(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "set" << tblb.session_id;
+		(*oscPacket) << packQuantized(quantizeUnit(tblb.x,quantize_bits),quantizeUnit(tblb.y,quantize_bits));
+		(*oscPacket) << packQuantized(quantizeAngle(tblb.angle,quantize_bits),quantizeSpeed(tblb.rotation_speed,quantize_bits));
+		(*oscPacket) << packQuantized(quantizeUnit(tblb.width,quantize_bits),quantizeUnit(tblb.height,quantize_bits));
+		(*oscPacket) << packQuantized(quantizeSpeed(tblb.x_speed,quantize_bits),quantizeSpeed(tblb.y_speed,quantize_bits));
+		(*oscPacket) << tblb.area << tblb.motion_accel << tblb.rotation_accel << osc::EndMessage;
+		return;
 	}
 	
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "set";
-	(*oscPacket) << (int32)(tblb->getSessionID()) << xpos << ypos << angle << tblb->getWidth() << tblb->getHeight() << tblb->getArea();
-	(*oscPacket) << xvel << yvel  << rvel << tblb->getMotionAccel()  << tblb->getRotationAccel();	
+	(*oscPacket) << tblb.session_id << tblb.x << tblb.y << tblb.angle << tblb.width << tblb.height << tblb.area;
+	(*oscPacket) << tblb.x_speed << tblb.y_speed  << tblb.rotation_speed << tblb.motion_accel  << tblb.rotation_accel;	
 	(*oscPacket) << osc::EndMessage;
 }
 
 void TuioServer::sendBlobBundle(long fseq) {
+	osc::OutboundPacketStream *oscPacket = blobEncoder.oscPacket;
+	addPackedMessage(&blobEncoder, "/tuio/2Dblb");
 	(*oscPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << (int32)fseq << osc::EndMessage;
 	(*oscPacket) << osc::EndBundle;
 
-	deliverOscPacket( oscPacket );
+	deliverOscPacket( &blobEncoder );
 }
 
 void TuioServer::sendFullMessages() {
-	
-	// prepare the cursor packet
-	fullPacket->Clear();
-	(*fullPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
-	// add the cursor alive message
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive";
-	for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++)
-		(*fullPacket) << (int32)((*tuioCursor)->getSessionID());	
-	(*fullPacket) << osc::EndMessage;	
+	submitFrame(false, false, false, true);
+}
+
+void TuioServer::sendFullBundles(FrameSnapshot *frame) {
+	sendFullCursorBundle(frame);
+	sendFullObjectBundle(frame);
+	sendFullBlobBundle(frame);
+}
+
+void TuioServer::sendFullCursorBundle(FrameSnapshot *frame) {
 	
 	// add all current cursor set messages
-	for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++) {
+	startCursorBundle(frame);
+	for (unsigned int i=0;i<frame->cursors.size();i++) {
 		
 		// start a new packet if we exceed the packet capacity
-		if ((fullPacket->Capacity()-fullPacket->Size())<CUR_MESSAGE_SIZE) {
-			
-			// add the immediate fseq message and send the cursor packet
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << -1 << osc::EndMessage;
-			(*fullPacket) << osc::EndBundle;
-			deliverOscPacket( fullPacket );
-			
-			// prepare the new cursor packet
-			fullPacket->Clear();	
-			(*fullPacket) << osc::BeginBundleImmediate;
-			if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "source" << source_name << osc::EndMessage;
-			// add the cursor alive message
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "alive";
-			for (std::list<TuioCursor*>::iterator tuioCursor = cursorList.begin(); tuioCursor!=cursorList.end(); tuioCursor++)
-				(*fullPacket) << (int32)((*tuioCursor)->getSessionID());	
-			(*fullPacket) << osc::EndMessage;				
-		}
-		
-		float xpos = (*tuioCursor)->getX();
-		float xvel = (*tuioCursor)->getXSpeed();
-		if (invert_x) {
-			xpos = 1 - xpos;
-			xvel = -1 * xvel;
+		if (packetFull(&cursorEncoder, CUR_MESSAGE_SIZE)) {
+			sendCursorBundle(-1);
+			startCursorBundle(frame);
 		}
-		float ypos = (*tuioCursor)->getY();
-		float yvel = (*tuioCursor)->getYSpeed();
-		if (invert_y) {
-			ypos = 1 - ypos;
-			yvel = -1 * yvel;
-		}
-		
-		// add the actual cursor set message
-		(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "set";
-		(*fullPacket) << (int32)((*tuioCursor)->getSessionID()) << xpos << ypos;
-		(*fullPacket) << xvel << yvel <<(*tuioCursor)->getMotionAccel();	
-		(*fullPacket) << osc::EndMessage;	
-	}
-	
-	// add the immediate fseq message and send the cursor packet
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dcur") << "fseq" << -1 << osc::EndMessage;
-	(*fullPacket) << osc::EndBundle;
-	deliverOscPacket( fullPacket );
-	
-	// prepare the object packet
-	fullPacket->Clear();
-	(*fullPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
-	// add the object alive message
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive";
-	for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++)
-		(*fullPacket) << (int32)((*tuioObject)->getSessionID());	
-	(*fullPacket) << osc::EndMessage;	
+		addCursorMessage(frame->cursors[i]);
+	}
+	sendCursorBundle(-1);
+}
+
+void TuioServer::sendFullObjectBundle(FrameSnapshot *frame) {
 	
-	for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++) {
+	// add all current object set messages
+	startObjectBundle(frame);
+	for (unsigned int i=0;i<frame->objects.size();i++) {
 		
 		// start a new packet if we exceed the packet capacity
-		if ((fullPacket->Capacity()-fullPacket->Size())<OBJ_MESSAGE_SIZE) {
-			// add the immediate fseq message and send the object packet
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << -1 << osc::EndMessage;
-			(*fullPacket) << osc::EndBundle;
-			deliverOscPacket( fullPacket );
-			
-			// prepare the new object packet
-			fullPacket->Clear();	
-			(*fullPacket) << osc::BeginBundleImmediate;
-			if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "source" << source_name << osc::EndMessage;
-			// add the object alive message
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "alive";
-			for (std::list<TuioObject*>::iterator tuioObject = objectList.begin(); tuioObject!=objectList.end(); tuioObject++)
-				(*fullPacket) << (int32)((*tuioObject)->getSessionID());	
-			(*fullPacket) << osc::EndMessage;	
-		}
-		
-		float xpos = (*tuioObject)->getX();
-		float xvel = (*tuioObject)->getXSpeed();
-		if (invert_x) {
-			xpos = 1 - xpos;
-			xvel = -1 * xvel;
-		}
-		float ypos = (*tuioObject)->getY();
-		float yvel = (*tuioObject)->getYSpeed();
-		if (invert_y) {
-			ypos = 1 - ypos;
-			yvel = -1 * yvel;
-		}
-		float angle = (*tuioObject)->getAngle();
-		float rvel = (*tuioObject)->getRotationSpeed();
-		if (invert_a) {
-			angle =  2.0f*(float)M_PI - angle;
-			rvel = -1 * rvel;
+		if (packetFull(&objectEncoder, OBJ_MESSAGE_SIZE)) {
+			sendObjectBundle(-1);
+			startObjectBundle(frame);
 		}
-		
-		// add the actual object set message
-		(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "set";
-		(*fullPacket) << (int32)((*tuioObject)->getSessionID()) << (*tuioObject)->getSymbolID() << xpos << ypos << angle;
-		(*fullPacket) << xvel << yvel << rvel << (*tuioObject)->getMotionAccel() << (*tuioObject)->getRotationAccel();	
-		(*fullPacket) << osc::EndMessage;
-		
+		addObjectMessage(frame->objects[i]);
 	}
-	// add the immediate fseq message and send the object packet
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dobj") << "fseq" << -1 << osc::EndMessage;
-	(*fullPacket) << osc::EndBundle;
-	deliverOscPacket( fullPacket );
-	
-	// prepare the blob packet
-	fullPacket->Clear();
-	(*fullPacket) << osc::BeginBundleImmediate;
-	if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
-	// add the object alive message
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive";
-	for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++)
-		(*fullPacket) << (int32)((*tuioBlob)->getSessionID());	
-	(*fullPacket) << osc::EndMessage;	
+	sendObjectBundle(-1);
+}
+
+void TuioServer::sendFullBlobBundle(FrameSnapshot *frame) {
 	
-	for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++) {
+	// add all current blob set messages
+	startBlobBundle(frame);
+	for (unsigned int i=0;i<frame->blobs.size();i++) {
 		
 		// start a new packet if we exceed the packet capacity
-		if ((fullPacket->Capacity()-fullPacket->Size())<BLB_MESSAGE_SIZE) {
-			// add the immediate fseq message and send the object packet
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << -1 << osc::EndMessage;
-			(*fullPacket) << osc::EndBundle;
-			deliverOscPacket( fullPacket );
-			
-			// prepare the new blob packet
-			fullPacket->Clear();	
-			(*fullPacket) << osc::BeginBundleImmediate;
-			if (source_name) (*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "source" << source_name << osc::EndMessage;
-			// add the blob alive message
-			(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "alive";
-			for (std::list<TuioBlob*>::iterator tuioBlob = blobList.begin(); tuioBlob!=blobList.end(); tuioBlob++)
-				(*fullPacket) << (int32)((*tuioBlob)->getSessionID());	
-			(*fullPacket) << osc::EndMessage;	
+		if (packetFull(&blobEncoder, BLB_MESSAGE_SIZE)) {
+			sendBlobBundle(-1);
+			startBlobBundle(frame);
 		}
+		addBlobMessage(frame->blobs[i]);
+	}
+	sendBlobBundle(-1);
+}
+
+void TuioServer::updateKeyframes(FrameSnapshot *frame) {
+	
+	// keyframes are only encoded once a client of the current encoding is waiting for one
+	for (int pass=0;pass<2;pass++) {
+		packed_encoding = (pass==1);
+		std::vector<OscSender*> &senders = packed_encoding ? packedSenderList : senderList;
 		
-		float xpos = (*tuioBlob)->getX();
-		float xvel = (*tuioBlob)->getXSpeed();
-		if (invert_x) {
-			xpos = 1 - xpos;
-			xvel = -1 * xvel;
-		}
-		float ypos = (*tuioBlob)->getY();
-		float yvel = (*tuioBlob)->getYSpeed();
-		if (invert_y) {
-			ypos = 1 - ypos;
-			yvel = -1 * yvel;
+		bool requested = false;
+		for (unsigned int i=0;i<senders.size();i++) {
+			if (senders[i]->requestsKeyframe()) requested = true;
 		}
-		float angle = (*tuioBlob)->getAngle();
-		float rvel = (*tuioBlob)->getRotationSpeed();
-		if (invert_a) {
-			angle = 2.0f*(float)M_PI - angle;
-			rvel = -1 * rvel;
-		}		
+		if (!requested) continue;
 		
-		// add the actual blob set message
-		(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "set";
-		(*fullPacket) << (int32)((*tuioBlob)->getSessionID()) << xpos << ypos  << angle << (*tuioBlob)->getWidth() << (*tuioBlob)->getHeight() << (*tuioBlob)->getArea();
-		(*fullPacket) << xvel << yvel << rvel << (*tuioBlob)->getMotionAccel() << (*tuioBlob)->getRotationAccel();	
-		(*fullPacket) << osc::EndMessage;
+		keyframe.clear();
+		keyframe_capture = true;
+		sendFullBundles(frame);
+		keyframe_capture = false;
 		
+		for (unsigned int i=0;i<senders.size();i++) senders[i]->setKeyframe(keyframe);
 	}
-	// add the immediate fseq message and send the blob packet
-	(*fullPacket) << osc::BeginMessage( "/tuio/2Dblb") << "fseq" << -1 << osc::EndMessage;
-	(*fullPacket) << osc::EndBundle;
-	deliverOscPacket( fullPacket );
+	packed_encoding = false;
 }
-
-
-
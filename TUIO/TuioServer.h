@@ -23,15 +23,23 @@
 #include "UdpSender.h"
 #include "TcpSender.h"
 #include "WebSockSender.h"
+#include "PackedProfile.h"
+#include "TuioScenePublisher.h"
 #include <iostream>
 #include <vector>
 #include <stdio.h>
-#ifndef WIN32
+#ifdef WIN32
+#include <windows.h>
+#else
 #include <netdb.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <pthread.h>
 #endif
 
+// the worker threads of the parallel encoding, the committing thread encodes one of the three profiles itself
+#define PARALLEL_ENCODER_THREADS 2
+
 namespace TUIO {
 	/**
 	 * <p>The TuioServer class is the central TUIO protocol encoder component.
@@ -131,7 +139,18 @@ namespace TUIO {
 		 */
 		void enablePeriodicMessages(int interval=1) {
 			periodic_update =  true;
-			update_interval = interval;
+			periodic_interval = interval*1000;
+		}
+
+		/**
+		 * Enables the periodic full update with an interval of the provided milliseconds.
+		 * The periodic updates of the three profiles are staggered, so that at most one profile is refreshed per frame.
+		 *
+		 * @param	interval	update interval in milliseconds
+		 */
+		void enablePeriodicMessagesMillis(int interval) {
+			periodic_update =  true;
+			periodic_interval = interval;
 		}
 
 		/**
@@ -154,9 +173,59 @@ namespace TUIO {
 		 * @return	the periodic update interval in seconds
 		 */
 		int getUpdateInterval() {
-			return update_interval;
+			return periodic_interval/1000;
 		}
 
+		/**
+		 * Returns the periodic update interval in milliseconds.
+		 * @return	the periodic update interval in milliseconds
+		 */
+		int getUpdateIntervalMillis() {
+			return periodic_interval;
+		}
+
+		/**
+		 * Limits the output rate of the object profile to one bundle per interval of the frame time.
+		 * The changes of the frames in between are combined, so that the next bundle carries the latest state of all changed TuioObjects.
+		 *
+		 * @param	interval	the minimum interval between two object bundles in milliseconds, 0 sends every changed frame
+		 */
+		void setObjectInterval(int interval) { object_interval = interval; };
+
+		/**
+		 * Limits the output rate of the cursor profile to one bundle per interval of the frame time.
+		 * The changes of the frames in between are combined, so that the next bundle carries the latest state of all changed TuioCursors.
+		 *
+		 * @param	interval	the minimum interval between two cursor bundles in milliseconds, 0 sends every changed frame
+		 */
+		void setCursorInterval(int interval) { cursor_interval = interval; };
+
+		/**
+		 * Limits the output rate of the blob profile to one bundle per interval of the frame time.
+		 * The changes of the frames in between are combined, so that the next bundle carries the latest state of all changed TuioBlobs.
+		 *
+		 * @param	interval	the minimum interval between two blob bundles in milliseconds, 0 sends every changed frame
+		 */
+		void setBlobInterval(int interval) { blob_interval = interval; };
+
+		/**
+		 * Returns the minimum interval between two object bundles in milliseconds.
+		 * @return	the object bundle interval in milliseconds
+		 */
+		int getObjectInterval() { return object_interval; };
+
+		/**
+		 * Returns the minimum interval between two cursor bundles in milliseconds.
+		 * @return	the cursor bundle interval in milliseconds
+		 */
+		int getCursorInterval() { return cursor_interval; };
+
+		/**
+		 * Returns the minimum interval between two blob bundles in milliseconds.
+		 * @return	the blob bundle interval in milliseconds
+		 */
+		int getBlobInterval() { return blob_interval; };
+
 		/**
 		 * Commits the current frame.
 		 * Generates and sends TUIO messages of all currently active and updated TuioObjects, TuioCursors and TuioBlobs.
@@ -183,8 +252,135 @@ namespace TUIO {
 		 */
 		void setSourceName(const char *name, const char *ip);
 
+		/**
+		 * Adds an additional OscSender, which receives the regular TUIO profiles.
+		 * Connection-based senders such as the TcpSender and WebSockSender deliver a keyframe with the full
+		 * scene state to each new client, which is only encoded after a scene change once a client is waiting for it.
+		 *
+		 * @param	sender	the additional OscSender
+		 */
 		void addOscSender(OscSender *sender);
 
+		/**
+		 * Adds an additional OscSender, which receives the packed TUIO profiles.
+		 * The individual "set" messages are replaced by a single "pset" message per bundle,
+		 * which carries all attributes as a contiguous array of fixed-size records within an OSC blob.
+		 * This allows considerably larger scenes per packet, but requires a TuioClient that supports the packed profile.
+		 *
+		 * @param	sender	the additional OscSender for the packed profile
+		 */
+		void addPackedOscSender(OscSender *sender);
+
+		/**
+		 * Enables the encoding of the x and y positions as 16bit fixed-point values within the packed profile
+		 *
+		 * @param	flag	true to enable the 16bit fixed-point positions
+		 */
+		void enablePackedFixedPositions(bool flag);
+
+		/**
+		 * Returns true if the packed profile uses 16bit fixed-point positions.
+		 * @return	true if the packed profile uses 16bit fixed-point positions
+		 */
+		bool hasPackedFixedPositions() { return packed_fixed; };
+
+		/**
+		 * Enables the quantized encoding of positions, angles, sizes and speeds within the regular set messages.
+		 * The values are rounded to the given number of significant bits and transmitted as pairs of 16bit
+		 * fixed-point values, which are identified by the TuioClient through their distinct type-tag layout.
+		 *
+		 * @param	bits	the number of significant bits between 2 and 16, defaults to 16
+		 */
+		void enableQuantization(int bits=16);
+
+		/**
+		 * Disables the quantized encoding, all values are transmitted as 32bit floats
+		 */
+		void disableQuantization();
+
+		/**
+		 * Returns true if the quantized encoding is enabled.
+		 * @return	true if the quantized encoding is enabled
+		 */
+		bool quantizationEnabled() {
+			return (quantize_bits>0);
+		}
+
+		/**
+		 * Returns the number of significant bits of the quantized encoding.
+		 * @return	the number of significant bits or 0 if the quantization is disabled
+		 */
+		int getQuantizationBits() {
+			return quantize_bits;
+		}
+
+		/**
+		 * Enables OSC time tags carrying the frame time for all TUIO bundles, instead of the immediate time tag.
+		 * The TuioServer then also answers the clock synchronization requests of the TuioClients,
+		 * which allows them to relate the frame time of this source to their local clock.
+		 *
+		 * @param	flag	true to enable the bundle time tags
+		 */
+		void enableTimeTags(bool flag);
+
+		/**
+		 * Returns true if the bundles carry the frame time as OSC time tag.
+		 * @return	true if the bundle time tags are enabled
+		 */
+		bool hasTimeTags() { return time_tags; };
+
+		/**
+		 * Publishes each committed frame through the provided TuioScenePublisher, which is deleted along with this TuioServer.
+		 * Local readers can then take snapshots of the current scene state without running a TuioClient.
+		 *
+		 * @param	publisher	the TuioScenePublisher, or NULL to stop publishing
+		 */
+		void setScenePublisher(TuioScenePublisher *publisher);
+
+		/**
+		 * Enables the pipelined commit, which moves the encoding and delivery of all bundles to a dedicated encoder thread.
+		 * commitFrame() then only copies the frame state into a double-buffered snapshot and returns immediately,
+		 * a frame that is committed while the previous one is still waiting for the encoder thread is combined with it.
+		 * The OscSenders and the source name need to be configured from the same thread that commits the frames.
+		 *
+		 * @param	flag	true to enable the pipelined commit
+		 */
+		void enablePipelinedCommit(bool flag);
+
+		/**
+		 * Returns true if the frames are encoded and delivered by the encoder thread.
+		 * @return	true if the pipelined commit is enabled
+		 */
+		bool hasPipelinedCommit() { return pipelined; };
+
+		/**
+		 * This method encodes the committed frames until the pipelined commit is disabled,
+		 * it is only public to be accessible from the thread function
+		 */
+		void runEncoderThread();
+
+		/**
+		 * Enables the parallel encoding, which encodes the cursor, object and blob profiles of each frame
+		 * into separate buffers on a pool of PARALLEL_ENCODER_THREADS worker threads and the committing thread.
+		 * The encoded bundles are then delivered in the same order as with the sequential encoding.
+		 * This only pays off if several profiles carry large frames at the same time.
+		 *
+		 * @param	flag	true to enable the parallel encoding
+		 */
+		void enableParallelEncoding(bool flag);
+
+		/**
+		 * Returns true if the profiles are encoded in parallel.
+		 * @return	true if the parallel encoding is enabled
+		 */
+		bool hasParallelEncoding() { return parallel; };
+
+		/**
+		 * This method encodes the profiles of the dispatched frames until the parallel encoding is disabled,
+		 * it is only public to be accessible from the thread function
+		 */
+		void runWorkerThread();
+
 		void enableObjectProfile(bool flag) { objectProfileEnabled = flag; };
 		void enableCursorProfile(bool flag) { cursorProfileEnabled = flag; };
 		void enableBlobProfile(bool flag) { blobProfileEnabled = flag; };
@@ -195,36 +391,159 @@ namespace TUIO {
 
 	private:
 
+		struct CursorState {
+			osc::int32 session_id;
+			float x, y;
+			float x_speed, y_speed;
+			float motion_accel;
+			osc::int64 update_time;
+		};
+
+		struct ObjectState {
+			osc::int32 session_id;
+			osc::int32 symbol_id;
+			float x, y, angle;
+			float x_speed, y_speed, rotation_speed;
+			float motion_accel, rotation_accel;
+			osc::int64 update_time;
+		};
+
+		struct BlobState {
+			osc::int32 session_id;
+			float x, y, angle;
+			float width, height, area;
+			float x_speed, y_speed, rotation_speed;
+			float motion_accel, rotation_accel;
+			osc::int64 update_time;
+		};
+
+		// an immutable copy of the frame state, the entities updated since the given frame time of their profile are encoded
+		struct FrameSnapshot {
+			std::vector<CursorState> cursors;
+			std::vector<ObjectState> objects;
+			std::vector<BlobState> blobs;
+			long frame;
+			osc::int64 objectSince, cursorSince, blobSince;
+			osc::uint64 timetag;
+			bool updateObject, updateCursor, updateBlob;
+			bool periodicObject, periodicCursor, periodicBlob;
+			bool fullUpdate, fullMessages;
+		};
+
+		// the packet buffers of a single profile, deferred packets are kept until they are delivered in order
+		struct ProfileEncoder {
+			std::vector<char*> bufferList;
+			std::vector<osc::OutboundPacketStream*> packetList;
+			osc::OutboundPacketStream *oscPacket;
+			char *packedBuffer;
+			unsigned int packed_size;
+			unsigned int packet_count;
+			unsigned int commit_count;
+			bool deferred;
+		};
+
 		void initialize(OscSender *oscsend);
+		void checkBufferSize(OscSender *sender);
 
 		std::vector<OscSender*> senderList;
-		void deliverOscPacket(osc::OutboundPacketStream  *packet);
+		std::vector<OscSender*> packedSenderList;
+		void deliverOscPacket(ProfileEncoder *encoder);
+		void deliverDeferredPackets(ProfileEncoder *encoder, unsigned int first, unsigned int last);
+
+		std::vector<std::string> keyframe;
+		bool keyframe_capture;
+		void sendFullBundles(FrameSnapshot *frame);
+		void sendFullObjectBundle(FrameSnapshot *frame);
+		void sendFullCursorBundle(FrameSnapshot *frame);
+		void sendFullBlobBundle(FrameSnapshot *frame);
+		void updateKeyframes(FrameSnapshot *frame);
 
-		osc::OutboundPacketStream  *oscPacket;
-		char *oscBuffer;
-		osc::OutboundPacketStream  *fullPacket;
-		char *fullBuffer;
+		FrameSnapshot frameBuffer[2];
+		FrameSnapshot *backFrame, *frontFrame;
+		void submitFrame(bool periodicObject, bool periodicCursor, bool periodicBlob, bool fullMessages);
+		void captureFrame(FrameSnapshot *frame);
+		void deliverFrame(FrameSnapshot *frame);
+		void encodeFrame(FrameSnapshot *frame);
+		void encodeProfile(int profile, FrameSnapshot *frame);
+		void encodeJobs();
 
-		void startObjectBundle();
-		void addObjectMessage(TuioObject *tobj);
+		bool pipelined, frame_pending, encoding;
+		void waitForEncoder();
+		void lockPipeline();
+		void unlockPipeline();
+#ifdef WIN32
+		HANDLE pipelineMutex;
+		HANDLE frameEvent;
+		HANDLE idleEvent;
+		HANDLE encoder_thread;
+		DWORD EncoderThreadId;
+#else
+		pthread_mutex_t pipelineMutex;
+		pthread_cond_t frameCond;
+		pthread_cond_t idleCond;
+		pthread_t encoder_thread;
+#endif
+
+		bool parallel;
+		FrameSnapshot *job_frame;
+		int next_job, finished_jobs;
+		void lockWorkers();
+		void unlockWorkers();
+#ifdef WIN32
+		HANDLE workerMutex;
+		HANDLE jobEvent;
+		HANDLE doneEvent;
+		HANDLE worker_thread[PARALLEL_ENCODER_THREADS];
+		DWORD WorkerThreadId[PARALLEL_ENCODER_THREADS];
+#else
+		pthread_mutex_t workerMutex;
+		pthread_cond_t jobCond;
+		pthread_cond_t doneCond;
+		pthread_t worker_thread[PARALLEL_ENCODER_THREADS];
+#endif
+
+		ProfileEncoder objectEncoder, cursorEncoder, blobEncoder;
+		unsigned int buffer_size;
+		void initEncoder(ProfileEncoder *encoder);
+		void releaseEncoder(ProfileEncoder *encoder);
+		bool packetFull(ProfileEncoder *encoder, unsigned int message_size);
+
+		bool packed_encoding, packed_fixed;
+		void addPackedMessage(ProfileEncoder *encoder, const char *profile);
+
+		bool time_tags;
+		osc::uint64 frame_timetag;
+		void beginBundle(ProfileEncoder *encoder, osc::uint64 timetag);
+
+		void commitObjectBundle(FrameSnapshot *frame, bool periodic);
+		void commitCursorBundle(FrameSnapshot *frame, bool periodic);
+		void commitBlobBundle(FrameSnapshot *frame, bool periodic);
+
+		void startObjectBundle(FrameSnapshot *frame);
+		void addObjectMessage(const ObjectState &tobj);
 		void sendObjectBundle(long fseq);
 		void sendEmptyObjectBundle();
 
-		void startCursorBundle();
-		void addCursorMessage(TuioCursor *tcur);
+		void startCursorBundle(FrameSnapshot *frame);
+		void addCursorMessage(const CursorState &tcur);
 		void sendCursorBundle(long fseq);
 		void sendEmptyCursorBundle();
 
-		void startBlobBundle();
-		void addBlobMessage(TuioBlob *tblb);
+		void startBlobBundle(FrameSnapshot *frame);
+		void addBlobMessage(const BlobState &tblb);
 		void sendBlobBundle(long fseq);
 		void sendEmptyBlobBundle();
 
-		int update_interval;
+		int periodic_interval, quantize_bits;
 		bool full_update, periodic_update;
 		TuioTime objectUpdateTime, cursorUpdateTime, blobUpdateTime ;
+
+		int object_interval, cursor_interval, blob_interval;
+		osc::int64 objectPending, cursorPending, blobPending;
+		osc::int64 objectDeadline, cursorDeadline, blobDeadline;
 		bool objectProfileEnabled, cursorProfileEnabled, blobProfileEnabled;
 		char *source_name;
+		TuioScenePublisher *scenePublisher;
 	};
 }
 #endif /* INCLUDED_TuioServer_H */
@@ -27,66 +27,190 @@ static void* ClientThreadFunc( void* obj )
 static DWORD WINAPI ClientThreadFunc( LPVOID obj )
 #endif
 {
-	static_cast<UdpReceiver*>(obj)->socket->Run();
+	static_cast<SocketReceiveMultiplexer*>(obj)->Run();
 	return 0;
 };
 
-UdpReceiver::UdpReceiver(int port):locked (false) {
-	try {
-		socket = new UdpListeningReceiveSocket(IpEndpointName( IpEndpointName::ANY_ADDRESS, port ), this );
-	} catch (std::exception &e) {
-		std::cerr << "could not bind to UDP port " << port << std::endl;
-		socket = NULL;
-	}
+UdpReceiver::UdpReceiver(int port, int size, int sockets):locked (false) {
+	bindSockets(port, size, sockets, false);
+}
+
+UdpReceiver::UdpReceiver(const char *group, int port, int size, const char *address):locked (false) {
+	// the shared port allows several receivers of the same group on this host
+	bindSockets(port, size, 1, true);
+	joinMulticastGroup(group, address);
+}
+
+void UdpReceiver::bindSockets(int port, int size, int sockets, bool shared) {
 
-	if (socket!=NULL) {
-		if (!socket->IsBound()) {
+#ifndef __linux__
+	sockets = 1;
+#endif
+	if (sockets<1) sockets = 1;
+	if (size>MAX_UDP_PACKET_SIZE) size = MAX_UDP_PACKET_SIZE;
+
+	for (int i=0;i<sockets;i++) {
+		UdpSocket *socket = NULL;
+		try {
+			socket = new UdpSocket();
+			if (shared) socket->SetAllowReuse(true);
+			if (sockets>1) socket->SetEnableReusePort(true);
+			socket->Bind(IpEndpointName( IpEndpointName::ANY_ADDRESS, port ));
+		} catch (std::exception &e) {
 			delete socket;
 			socket = NULL;
-		} else std::cout << "listening to TUIO/UDP messages on port " << port << std::endl;
+		}
+
+		if ((socket==NULL) || !socket->IsBound()) {
+			delete socket;
+			if (socketList.empty()) std::cerr << "could not bind to UDP port " << port << std::endl;
+			else std::cerr << "could not bind additional socket to UDP port " << port << std::endl;
+			break;
+		}
+
+		socket->SetMaxPacketSize(size);
+		socket->SetEnableReceiveTimestamps(true);
+		SocketReceiveMultiplexer *multiplexer = new SocketReceiveMultiplexer();
+		multiplexer->AttachSocketListener(socket, this);
+		socketList.push_back(socket);
+		multiplexerList.push_back(multiplexer);
+	}
+
+	if (socketList.size()==1) std::cout << "listening to TUIO/UDP messages on port " << port << std::endl;
+	else if (socketList.size()>1) std::cout << "listening to TUIO/UDP messages on port " << port << " with " << socketList.size() << " sockets" << std::endl;
+
+#ifndef WIN32
+	pthread_mutex_init(&clientMutex,NULL);
+#else
+	clientMutex = CreateMutex(NULL,FALSE,NULL);
+#endif
+}
+
+bool UdpReceiver::joinMulticastGroup(const char *group, const char *address) {
+	return changeMembership(group, address, true);
+}
+
+bool UdpReceiver::leaveMulticastGroup(const char *group, const char *address) {
+	return changeMembership(group, address, false);
+}
+
+bool UdpReceiver::changeMembership(const char *group, const char *address, bool join) {
+
+	if (socketList.empty()) return false;
+	if (socketList.size()>1) {
+		// every socket bound to the port would receive its own copy of the group packets
+		std::cerr << "TUIO/UDP multicast requires a single receive socket" << std::endl;
+		return false;
+	}
+
+	unsigned long group_ip = GetHostByName(group);
+	if (!IS_MULTICAST_ADDRESS(group_ip)) {
+		std::cerr << "invalid TUIO/UDP multicast group " << group << std::endl;
+		return false;
 	}
+	unsigned long interface_ip = IpEndpointName::ANY_ADDRESS;
+	if (address!=NULL) interface_ip = GetHostByName(address);
+
+	bool result = join ? socketList[0]->JoinMulticastGroup(group_ip, interface_ip) : socketList[0]->LeaveMulticastGroup(group_ip, interface_ip);
+	if (!result) std::cerr << "could not " << (join ? "join" : "leave") << " TUIO/UDP multicast group " << group << std::endl;
+	else if (join) std::cout << "listening to TUIO/UDP multicast group " << group << std::endl;
+	return result;
+}
+
+void UdpReceiver::setReceiveBufferSize(int size) {
+	for (unsigned int i=0;i<socketList.size();i++)
+		socketList[i]->SetReceiveBufferSize(size);
+}
+
+int UdpReceiver::getSocketCount() {
+	return (int)socketList.size();
 }
 
 UdpReceiver::~UdpReceiver() {
-	delete socket;
+	disconnect();
+	for (unsigned int i=0;i<socketList.size();i++) {
+		multiplexerList[i]->DetachSocketListener(socketList[i], this);
+		delete multiplexerList[i];
+		delete socketList[i];
+	}
+
+#ifndef WIN32
+	pthread_mutex_destroy(&clientMutex);
+#else
+	CloseHandle(clientMutex);
+#endif
+}
+
+void UdpReceiver::lockClients() {
+#ifndef WIN32
+	pthread_mutex_lock(&clientMutex);
+#else
+	WaitForSingleObject(clientMutex, INFINITE);
+#endif
+}
+
+void UdpReceiver::unlockClients() {
+#ifndef WIN32
+	pthread_mutex_unlock(&clientMutex);
+#else
+	ReleaseMutex(clientMutex);
+#endif
+}
+
+void UdpReceiver::ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint, osc::int64 receiveTime ) {
+	if (multiplexerList.size()>1) {
+		lockClients();
+		OscReceiver::ProcessPacket(data, size, remoteEndpoint, receiveTime);
+		unlockClients();
+	} else OscReceiver::ProcessPacket(data, size, remoteEndpoint, receiveTime);
+}
+
+bool UdpReceiver::replyPacket( const char *data, int size, const IpEndpointName& remoteEndpoint ) {
+	// all sockets share the local port, so any of them reaches the source
+	if (socketList.empty() || (remoteEndpoint.port==IpEndpointName::ANY_PORT)) return false;
+	socketList[0]->SendTo(remoteEndpoint, data, size);
+	return true;
 }
 
 void UdpReceiver::connect(bool lk) {
 
 	if (connected) return;
-	if (socket==NULL) return;
+	if (multiplexerList.empty()) return;
 	locked = lk;
-	
-	if (!locked) {
+	connected = true;
+
+	// the first socket is served by the calling thread in locked mode
+	for (unsigned int i=(locked ? 1 : 0);i<multiplexerList.size();i++) {
 #ifndef WIN32
-		pthread_create(&thread , NULL, ClientThreadFunc, this);
+		pthread_t thread;
+		pthread_create(&thread , NULL, ClientThreadFunc, multiplexerList[i]);
 #else
 		DWORD threadId;
-		thread = CreateThread( 0, 0, ClientThreadFunc, this, 0, &threadId );
+		HANDLE thread = CreateThread( 0, 0, ClientThreadFunc, multiplexerList[i], 0, &threadId );
 #endif
-	} else socket->Run();
-	
-	connected = true;
+		threadList.push_back(thread);
+	}
+
+	if (locked) multiplexerList[0]->Run();
 }
 
 void UdpReceiver::disconnect() {
 	
 	if (!connected) return;
-	if (socket==NULL) {
-		connected = false;
-		locked = false;
-		return;
-	}
-	socket->Break();
-	
-	if (!locked) {
-#ifdef WIN32
-		if( thread ) CloseHandle( thread );
-#endif
-		thread = 0;
-	} else locked = false;
-
 	connected = false;
-}
 
+	for (unsigned int i=0;i<multiplexerList.size();i++)
+		multiplexerList[i]->AsynchronousBreak();
 
+	for (unsigned int i=0;i<threadList.size();i++) {
+#ifdef WIN32
+		if (GetThreadId(threadList[i])!=GetCurrentThreadId()) WaitForSingleObject(threadList[i], INFINITE);
+		CloseHandle(threadList[i]);
+#else
+		if (!pthread_equal(threadList[i], pthread_self())) pthread_join(threadList[i], NULL);
+		else pthread_detach(threadList[i]);
+#endif
+	}
+	threadList.clear();
+	locked = false;
+}
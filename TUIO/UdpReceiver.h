@@ -21,6 +21,18 @@
 
 #include "OscReceiver.h"
 #include "ip/UdpSocket.h"
+#include "ip/NetworkingUtils.h"
+#include <vector>
+
+#ifndef MAX_UDP_SIZE
+#define MAX_UDP_SIZE 4096
+#endif
+#ifndef MAX_UDP_PACKET_SIZE
+#define MAX_UDP_PACKET_SIZE 65507
+#endif
+#ifndef IS_MULTICAST_ADDRESS
+#define IS_MULTICAST_ADDRESS(ip) ((((unsigned long)(ip))>>28)==14)
+#endif
 
 namespace TUIO {
 	
@@ -34,20 +46,38 @@ namespace TUIO {
 				
 	public:
 
-		/**
-		 * The UDP socket is only public to be accessible from the thread function
-		 */ 
-		UdpListeningReceiveSocket *socket;
-		
 		/**
 		 * This constructor creates a UdpReceiver instance listening to the provided UDP port 
+		 * Larger packets than the provided size are truncated, the maximum is 65507 bytes.
+		 * With more than one socket, all sockets are bound to the same port with SO_REUSEPORT
+		 * and each socket is served by its own receive thread. The kernel distributes the
+		 * incoming packets by their source address, therefore the packets of each individual
+		 * TUIO source remain in order on a single thread. Multiple sockets are only
+		 * supported on Linux, other systems always use a single socket.
+		 * Only the reception runs in parallel: the OSC decoding and the listener callbacks
+		 * of the attached TuioClients are still serialized, since a TuioClient decodes all
+		 * bundles with a single frame state. Multiple sockets therefore avoid the overflow of
+		 * a single kernel receive buffer, but do not speed up the decoding itself.
 		 *
 		 * @param  port  the number of the UDP port to listen to, defaults to 3333
+		 * @param  size  the maximum UDP packet size, defaults to 4096
+		 * @param  sockets  the number of sockets and receive threads, defaults to 1
 		 */
-		UdpReceiver (int port=3333);
+		UdpReceiver (int port=3333, int size=MAX_UDP_SIZE, int sockets=1);
 
 		/**
-		 * The destructor is doing nothing in particular. 
+		 * This constructor creates a UdpReceiver that joins the provided IPv4 multicast group on the provided UDP port.
+		 * The port is shared, so that several receivers of the same group can run on a single host.
+		 *
+		 * @param  group  the multicast group address
+		 * @param  port  the number of the UDP port to listen to, defaults to 3333
+		 * @param  size  the maximum UDP packet size, defaults to 4096
+		 * @param  address  the local address of the network interface, or NULL for the default interface
+		 */
+		UdpReceiver (const char *group, int port=3333, int size=MAX_UDP_SIZE, const char *address=NULL);
+
+		/**
+		 * The destructor closes all sockets
 		 */
 		virtual ~UdpReceiver();
 		
@@ -62,13 +92,80 @@ namespace TUIO {
 		 * The UdpReceiver disconnects and stops receiving TUIO messages via UDP
 		 */
 		void disconnect();
+
+		/**
+		 * This method sets the size of the kernel receive buffer (SO_RCVBUF) of all sockets,
+		 * a larger buffer avoids packet loss during bursts of large packets
+		 *
+		 * @param  size  the receive buffer size in bytes
+		 */
+		void setReceiveBufferSize(int size);
+
+		/**
+		 * Returns the number of bound sockets and receive threads
+		 *
+		 * @return the number of bound sockets
+		 */
+		int getSocketCount();
+
+		/**
+		 * Joins the provided IPv4 multicast group, which is only supported with a single receive socket
+		 *
+		 * @param  group  the multicast group address
+		 * @param  address  the local address of the network interface, or NULL for the default interface
+		 * @return true if the group was joined
+		 */
+		bool joinMulticastGroup(const char *group, const char *address=NULL);
+
+		/**
+		 * Leaves the provided IPv4 multicast group
+		 *
+		 * @param  group  the multicast group address
+		 * @param  address  the local address of the network interface, or NULL for the default interface
+		 * @return true if the group was left
+		 */
+		bool leaveMulticastGroup(const char *group, const char *address=NULL);
+
+		/**
+		 * The OSC callback method where the incoming OSC data is received.
+		 * With multiple receive threads each complete packet is delivered
+		 * to the attached TuioClients atomically, since a TuioClient
+		 * keeps its frame state between the messages of a bundle.
+		 * The packets of all sockets are therefore decoded one at a time.
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @param  remoteEndpoint  the source of the OSC packet
+		 * @param  receiveTime  the kernel receive time in nanoseconds since the epoch, or 0 if unknown
+		 */
+		void ProcessPacket( const char *data, int size, const IpEndpointName &remoteEndpoint, osc::int64 receiveTime );
+
+		/**
+		 * Sends the provided OSC packet back to the source of a received packet
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @param  remoteEndpoint  the source of the received OSC packet
+		 * @return true if the packet was sent
+		 */
+		bool replyPacket( const char *data, int size, const IpEndpointName &remoteEndpoint );
 		
 	private:
 
+		void bindSockets(int port, int size, int sockets, bool shared);
+		bool changeMembership(const char *group, const char *address, bool join);
+		void lockClients();
+		void unlockClients();
+
+		std::vector<UdpSocket*> socketList;
+		std::vector<SocketReceiveMultiplexer*> multiplexerList;
+
 #ifndef WIN32
-		pthread_t thread;
+		std::vector<pthread_t> threadList;
+		pthread_mutex_t clientMutex;
 #else
-		HANDLE thread;
+		std::vector<HANDLE> threadList;
+		HANDLE clientMutex;
 #endif	
 		
 		bool locked;
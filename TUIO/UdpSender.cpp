@@ -17,14 +17,18 @@
 */
 
 #include "UdpSender.h"
+#include "TuioClock.h"
 
 using namespace TUIO;
 
 UdpSender::UdpSender() {
 	try {
 		local = true;
+		multicast = false;
 		long unsigned int ip = GetHostByName("localhost");
-		socket = new UdpTransmitSocket(IpEndpointName(ip, 3333));
+		endpoint = IpEndpointName(ip, 3333);
+		socket = new UdpTransmitSocket(endpoint);
+		socket->SetEnableReceiveTimestamps(true);
 		buffer_size = MAX_UDP_SIZE;
 		std::cout << "TUIO/UDP messages to " << "127.0.0.1@3333" << std::endl;
 	} catch (std::exception &e) { 
@@ -44,8 +48,12 @@ UdpSender::UdpSender(const char *host, int port) {
 			buffer_size = IP_MTU_SIZE;
 		}
 		long unsigned int ip = GetHostByName(host);
-		socket = new UdpTransmitSocket(IpEndpointName(ip, port));
-		std::cout << "TUIO/UDP messages to " << host << "@" << port << std::endl;
+		multicast = IS_MULTICAST_ADDRESS(ip);
+		endpoint = IpEndpointName(ip, port);
+		socket = new UdpTransmitSocket(endpoint);
+		socket->SetEnableReceiveTimestamps(true);
+		if (multicast) std::cout << "TUIO/UDP multicast messages to " << host << "@" << port << std::endl;
+		else std::cout << "TUIO/UDP messages to " << host << "@" << port << std::endl;
 	} catch (std::exception &e) { 
 		std::cout << "could not create UDP socket" << std::endl;
 		socket = NULL;
@@ -59,10 +67,15 @@ UdpSender::UdpSender(const char *host, int port, int size) {
 			local = true;
 		} else local = false;
 		long unsigned int ip = GetHostByName(host);
-		socket = new UdpTransmitSocket(IpEndpointName(ip, port));
-		if (buffer_size>MAX_UDP_SIZE) buffer_size = MAX_UDP_SIZE;
-		else if (buffer_size<MIN_UDP_SIZE) buffer_size = MIN_UDP_SIZE;
-		std::cout << "TUIO/UDP messages to " << host << "@" << port << std::endl;
+		multicast = IS_MULTICAST_ADDRESS(ip);
+		endpoint = IpEndpointName(ip, port);
+		socket = new UdpTransmitSocket(endpoint);
+		socket->SetEnableReceiveTimestamps(true);
+		if (size>MAX_UDP_PACKET_SIZE) buffer_size = MAX_UDP_PACKET_SIZE;
+		else if (size<MIN_UDP_SIZE) buffer_size = MIN_UDP_SIZE;
+		else buffer_size = size;
+		if (multicast) std::cout << "TUIO/UDP multicast messages to " << host << "@" << port << std::endl;
+		else std::cout << "TUIO/UDP messages to " << host << "@" << port << std::endl;
 	} catch (std::exception &e) { 
 		std::cout << "could not create UDP socket" << std::endl;
 		socket = NULL;
@@ -79,11 +92,59 @@ bool UdpSender::isConnected() {
 	return true;
 }
 
+void UdpSender::setSendBufferSize(int size) {
+	if (socket!=NULL) socket->SetSendBufferSize(size);
+}
+
+void UdpSender::setMulticastTTL(int ttl) {
+	if ((socket!=NULL) && multicast) socket->SetMulticastTTL(ttl);
+}
+
+void UdpSender::setMulticastLoopback(bool flag) {
+	if ((socket!=NULL) && multicast) socket->SetMulticastLoopback(flag);
+}
+
+bool UdpSender::setMulticastInterface(const char *address) {
+	if ((socket==NULL) || !multicast) return false;
+	long unsigned int ip = GetHostByName(address);
+	if (ip==0) return false;
+	socket->SetMulticastInterface(ip);
+	// the connected socket only selects the new interface when it is connected again
+	socket->Connect(endpoint);
+	std::cout << "TUIO/UDP multicast interface " << address << std::endl;
+	return true;
+}
+
+void UdpSender::answerPings() {
+	if (socket==NULL) return;
+
+	char ping[TUIO_PING_SIZE];
+	char pong[TUIO_PING_SIZE];
+	IpEndpointName remoteEndpoint;
+	osc::int64 receive_time;
+
+	for (;;) {
+		std::size_t size = socket->ReceivePending(remoteEndpoint, ping, sizeof(ping), receive_time);
+		if (size==0) return;
+
+		// the kernel timestamp does not include the artificial clock skew
+		if (receive_time>0) receive_time += TuioClock::getClockSkew();
+		else receive_time = TuioClock::getSystemTime();
+
+		unsigned int pong_size = TuioClock::answerPing(ping, (unsigned int)size, receive_time, pong, sizeof(pong));
+		if (pong_size>0) socket->Send(pong, pong_size);
+	}
+}
+
 bool UdpSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
+	return sendOscData( bundle->Data(), (unsigned int)bundle->Size() );
+}
+
+bool UdpSender::sendOscData (const char *data, unsigned int size) {
 	if (socket==NULL) return false; 
-	if ( bundle->Size() > buffer_size ) return false;
-	if ( bundle->Size() == 0 ) return false;
+	if ( size > buffer_size ) return false;
+	if ( size == 0 ) return false;
 
-	socket->Send( bundle->Data(), bundle->Size() );
+	socket->Send( data, size );
 	return true;
 }
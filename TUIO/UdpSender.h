@@ -25,6 +25,10 @@
 #define IP_MTU_SIZE 1500
 #define MAX_UDP_SIZE 4096
 #define MIN_UDP_SIZE 576
+#define MAX_UDP_PACKET_SIZE 65507
+
+// IPv4 multicast groups are within 224.0.0.0/4
+#define IS_MULTICAST_ADDRESS(ip) ((((unsigned long)(ip))>>28)==14)
 
 namespace TUIO {
 	
@@ -40,13 +44,14 @@ namespace TUIO {
 
 		/**
 		 * The default constructor creates a UdpSender that sends to the default UDP port 3333 on localhost
-		 * using the maximum packet size of 65536 bytes for single packets on the loopback device
+		 * using a packet size of 4096 bytes, which is accepted by the default receive buffer of all TUIO clients
 		 */
 		UdpSender();
 		
 		/**
 		 * This constructor creates a UdpSender that sends to the provided port on the the given host
-		 * using the default MTU size of 1500 bytes to deliver unfragmented UDP packets on a LAN
+		 * using the default MTU size of 1500 bytes to deliver unfragmented UDP packets on a LAN.
+		 * If the host is an IPv4 multicast group, each packet is sent only once to all receivers of the group.
 		 *
 		 * @param  host  the receiving host name
 		 * @param  port  the outgoing UDP port number
@@ -55,7 +60,9 @@ namespace TUIO {
 		UdpSender(const char *host, int port);		
 		/**
 		 * This constructor creates a UdpSender that sends to the provided port on the the given host
-		 * the UDP packet size can be set to a value between 576 and 65536 bytes
+		 * the UDP packet size can be set to a value between 576 and 65507 bytes.
+		 * On the loopback device the maximum size allows to deliver a complete frame in a single packet,
+		 * as long as the receiver is configured with the same packet size.
 		 *
 		 * @param  host  the receiving host name
 		 * @param  port  the outgoing UDP port number
@@ -77,17 +84,69 @@ namespace TUIO {
 		
 		bool sendOscPacket (osc::OutboundPacketStream *bundle);
 
+		/**
+		 * This method delivers an already encoded OSC packet
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @return true if the data was delivered successfully
+		 */
+		bool sendOscData (const char *data, unsigned int size);
+
 		/**
 		 * This method returns the connection state
 		 *
 		 * @return true if the connection is alive
 		 */
 		 bool isConnected ();
+
+		/**
+		 * This method sets the size of the kernel send buffer (SO_SNDBUF)
+		 *
+		 * @param  size  the send buffer size in bytes
+		 */
+		void setSendBufferSize(int size);
+
+		/**
+		 * This method answers the pending clock synchronization requests of the receivers
+		 */
+		void answerPings();
+
+		/**
+		 * Returns true if this UdpSender sends to an IPv4 multicast group
+		 *
+		 * @return true if the target is a multicast group
+		 */
+		bool isMulticast() { return multicast; };
+
+		/**
+		 * This method sets the number of router hops of the multicast packets, which defaults to 1 for the local network
+		 *
+		 * @param  ttl  the multicast time to live between 0 and 255
+		 */
+		void setMulticastTTL(int ttl);
+
+		/**
+		 * This method enables or disables the delivery of the multicast packets to the receivers on the sending host, which is enabled by default
+		 *
+		 * @param  flag  true to deliver the multicast packets to the local receivers
+		 */
+		void setMulticastLoopback(bool flag);
+
+		/**
+		 * This method selects the network interface of the multicast packets by its local address
+		 *
+		 * @param  address  the local address of the interface
+		 * @return true if the address was valid
+		 */
+		bool setMulticastInterface(const char *address);
 		
 		 const char* tuio_type() { return "TUIO/UDP"; }
 		
 	private:
 		UdpTransmitSocket *socket;
+		IpEndpointName endpoint;
+		bool multicast;
 	};
 }
 #endif /* INCLUDED_UDPSENDER_H */
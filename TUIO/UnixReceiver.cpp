@@ -0,0 +1,223 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "UnixReceiver.h"
+#include "TuioClock.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+#ifndef WIN32
+#include <errno.h>
+#endif
+
+using namespace TUIO;
+
+#ifndef  WIN32
+static void* ReceiverThreadFunc( void* obj )
+#else
+static DWORD WINAPI ReceiverThreadFunc( LPVOID obj )
+#endif
+{
+	UnixReceiver *receiver = static_cast<UnixReceiver*>(obj);
+	receiver->runEventLoop();
+	return 0;
+};
+
+UnixReceiver::UnixReceiver(const char *socket_path, bool seqpacket, int size)
+: unix_socket	(-1)
+, sequenced	(seqpacket)
+, buffer	(NULL)
+, running	(false)
+, receiver_thread	(0)
+, locked	(false)
+{
+	snprintf(path, sizeof(path), "%s", socket_path);
+	if (size>MAX_UNIX_PACKET_SIZE) size = MAX_UNIX_PACKET_SIZE;
+	buffer_size = size;
+	buffer = new char[buffer_size];
+
+#ifdef WIN32
+	std::cerr << "TUIO/UNIX is not supported on this platform" << std::endl;
+#else
+	unix_socket = socket(AF_UNIX, sequenced ? SOCK_SEQPACKET : SOCK_DGRAM, 0);
+	if (unix_socket<0) {
+		std::cerr << "could not create TUIO/UNIX socket" << std::endl;
+		return;
+	}
+
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	snprintf(address.sun_path, sizeof(address.sun_path), "%s", path);
+
+	// a socket path that was left behind by a previous receiver is replaced
+	unlink(path);
+	if ((bind(unix_socket, (struct sockaddr*)&address, sizeof(address))<0) || (sequenced && (listen(unix_socket, SOMAXCONN)<0))) {
+		std::cerr << "could not bind to TUIO/UNIX socket " << path << std::endl;
+		close(unix_socket);
+		unix_socket = -1;
+		return;
+	}
+
+	SocketPoller::setNonBlocking(unix_socket);
+	if (!sequenced) {
+		int size = buffer_size*4;
+		setsockopt(unix_socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+#ifdef SO_TIMESTAMPNS
+		int timestamps = 1;
+		setsockopt(unix_socket, SOL_SOCKET, SO_TIMESTAMPNS, &timestamps, sizeof(timestamps));
+#endif
+	}
+
+	std::cout << "listening to TUIO/UNIX messages on " << path << std::endl;
+#endif
+}
+
+UnixReceiver::~UnixReceiver() {
+	disconnect();
+#ifndef WIN32
+	while (!clientList.empty()) closeClient(clientList.back());
+	if (unix_socket>=0) {
+		close(unix_socket);
+		unlink(path);
+	}
+#endif
+	delete[] buffer;
+}
+
+int UnixReceiver::receivePackets(SocketHandle socket) {
+#ifdef WIN32
+	return -1;
+#else
+	int count = 0;
+	for (;;) {
+		struct iovec iov;
+		iov.iov_base = buffer;
+		iov.iov_len = buffer_size;
+
+		char control[64];
+		struct msghdr message;
+		memset(&message, 0, sizeof(message));
+		message.msg_iov = &iov;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+
+		int bytes = (int)recvmsg(socket, &message, 0);
+		if (bytes<0) return ((errno==EAGAIN) || (errno==EWOULDBLOCK)) ? count : -1;
+		if (bytes==0) {
+			// a closed connection, or an empty datagram
+			if (sequenced) return -1;
+			continue;
+		}
+		if (message.msg_flags & MSG_TRUNC) continue;
+
+		// the kernel receive time is used if available, local sockets are otherwise stamped right after the read
+		osc::int64 receive_time = 0;
+#ifdef SO_TIMESTAMPNS
+		for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message); cmsg!=NULL; cmsg = CMSG_NXTHDR(&message, cmsg)) {
+			if ((cmsg->cmsg_level==SOL_SOCKET) && (cmsg->cmsg_type==SCM_TIMESTAMPNS)) {
+				struct timespec ts;
+				memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+				receive_time = (osc::int64)ts.tv_sec*1000000000 + ts.tv_nsec;
+			}
+		}
+#endif
+		if (receive_time==0) receive_time = TuioClock::getSystemTime() - TuioClock::getClockSkew();
+
+		ProcessPacket(buffer, bytes, IpEndpointName(), receive_time);
+		count++;
+	}
+#endif
+}
+
+void UnixReceiver::closeClient(SocketHandle socket) {
+	poller.removeSocket(socket);
+#ifndef WIN32
+	close(socket);
+#endif
+	clientList.erase(std::remove(clientList.begin(), clientList.end(), socket), clientList.end());
+}
+
+void UnixReceiver::runEventLoop() {
+#ifndef WIN32
+	while (running) {
+		int events = poller.wait(-1);
+		for (int i=0;i<events;i++) {
+			SocketHandle socket = poller.getSocket(i);
+			if (sequenced && (socket==unix_socket)) {
+				int client = accept(unix_socket, NULL, NULL);
+				if (client<0) continue;
+				SocketPoller::setNonBlocking(client);
+				int size = buffer_size*4;
+				setsockopt(client, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+				clientList.push_back(client);
+				poller.addSocket(client);
+				std::cout << "listening to TUIO/UNIX connection on " << path << std::endl;
+				continue;
+			}
+
+			if ((receivePackets(socket)<0) && sequenced) {
+				std::cout << "closed TUIO/UNIX connection" << std::endl;
+				closeClient(socket);
+			}
+		}
+	}
+#endif
+}
+
+void UnixReceiver::connect(bool lk) {
+
+	if (connected) return;
+	if ((int)unix_socket<0) return;
+	locked = lk;
+
+	poller.addSocket(unix_socket);
+	running = true;
+	connected = true;
+
+	if (!locked) {
+#ifndef WIN32
+		pthread_create(&receiver_thread , NULL, ReceiverThreadFunc, this);
+#else
+		receiver_thread = CreateThread( 0, 0, ReceiverThreadFunc, this, 0, &ReceiverThreadId );
+#endif
+	} else runEventLoop();
+}
+
+void UnixReceiver::disconnect() {
+
+	if (!connected) return;
+
+	running = false;
+	poller.wakeup();
+
+	if (!locked) {
+#ifdef WIN32
+		WaitForSingleObject(receiver_thread, INFINITE);
+		if( receiver_thread ) CloseHandle( receiver_thread );
+#else
+		pthread_join(receiver_thread, NULL);
+#endif
+		receiver_thread = 0;
+	} else locked = false;
+
+	poller.removeSocket(unix_socket);
+	connected = false;
+}
@@ -0,0 +1,114 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_UNIXRECEIVER_H
+#define INCLUDED_UNIXRECEIVER_H
+
+#include "OscReceiver.h"
+#include "SocketPoller.h"
+#include <vector>
+
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef TUIO_UNIX_PATH
+#define TUIO_UNIX_PATH "/tmp/tuio.sock"
+#endif
+#ifndef MAX_UNIX_SIZE
+#define MAX_UNIX_SIZE 65536
+#endif
+#ifndef MAX_UNIX_PACKET_SIZE
+#define MAX_UNIX_PACKET_SIZE 262144
+#endif
+
+namespace TUIO {
+
+	/**
+	 * The UnixReceiver provides the OscReceiver functionality for the Unix domain socket transport method of the UnixSender.
+	 * It binds the socket path, which is replaced if it was left behind by a previous receiver, and removes it again when it is deleted.
+	 * The datagram socket and all sequenced packet connections are served by a single event loop with non-blocking reads.
+	 * Unix domain sockets are not available on Windows.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL UnixReceiver: public OscReceiver {
+
+	public:
+
+		/**
+		 * This constructor creates a UnixReceiver bound to the provided socket path
+		 * Larger packets than the provided size are dropped.
+		 *
+		 * @param  path  the socket path, defaults to "/tmp/tuio.sock"
+		 * @param  sequenced  accept SOCK_SEQPACKET connections instead of receiving SOCK_DGRAM packets
+		 * @param  size  the maximum packet size, defaults to 65536
+		 */
+		UnixReceiver (const char *path=TUIO_UNIX_PATH, bool sequenced=false, int size=MAX_UNIX_SIZE);
+
+		/**
+		 * The destructor disconnects the UnixReceiver, closes its sockets and removes the socket path
+		 */
+		virtual ~UnixReceiver();
+
+		/**
+		 * The UnixReceiver connects and starts receiving TUIO messages via the Unix domain socket
+		 *
+		 * @param  lock  running in the background if set to false (default)
+		 */
+		void connect(bool lock=false);
+
+		/**
+		 * The UnixReceiver disconnects and stops receiving TUIO messages
+		 */
+		void disconnect();
+
+		/**
+		 * This method runs the event loop until the UnixReceiver is disconnected,
+		 * it is only public to be accessible from the thread function
+		 */
+		void runEventLoop();
+
+	private:
+		int receivePackets(SocketHandle socket);
+		void closeClient(SocketHandle socket);
+
+		SocketHandle unix_socket;
+		std::vector<SocketHandle> clientList;
+		SocketPoller poller;
+		bool sequenced;
+		char path[108];
+		char *buffer;
+		int buffer_size;
+		volatile bool running;
+
+#ifndef WIN32
+		pthread_t receiver_thread;
+#else
+		HANDLE receiver_thread;
+		DWORD ReceiverThreadId;
+#endif
+
+		bool locked;
+	};
+}
+#endif /* INCLUDED_UNIXRECEIVER_H */
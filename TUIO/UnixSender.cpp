@@ -0,0 +1,132 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "UnixSender.h"
+#include "TuioClock.h"
+#include <cstdio>
+#include <errno.h>
+
+using namespace TUIO;
+
+UnixSender::UnixSender(const char *socket_path, bool seqpacket, int size)
+	:unix_socket	(-1)
+	,sequenced	(seqpacket)
+	,connect_time	(0)
+{
+	local = true;
+	snprintf(path, sizeof(path), "%s", socket_path);
+	if (size>MAX_UNIX_PACKET_SIZE) buffer_size = MAX_UNIX_PACKET_SIZE;
+	else if (size<MIN_UNIX_SIZE) buffer_size = MIN_UNIX_SIZE;
+	else buffer_size = size;
+
+#ifdef WIN32
+	std::cout << "TUIO/UNIX is not supported on this platform" << std::endl;
+	throw std::exception();
+#else
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	snprintf(address.sun_path, sizeof(address.sun_path), "%s", path);
+
+	if (!sequenced) {
+		unix_socket = socket(AF_UNIX, SOCK_DGRAM, 0);
+		if (unix_socket<0) {
+			std::cout << "could not create TUIO/UNIX socket" << std::endl;
+			throw std::exception();
+		}
+		// the datagram size is limited by the send buffer
+		int buffer = buffer_size*2;
+		setsockopt(unix_socket, SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+	} else connectSocket();
+
+	std::cout << "TUIO/UNIX messages to " << path << std::endl;
+#endif
+}
+
+UnixSender::~UnixSender() {
+	closeSocket();
+}
+
+bool UnixSender::connectSocket() {
+#ifdef WIN32
+	return false;
+#else
+	connect_time = TuioClock::getSystemTime();
+	unix_socket = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (unix_socket<0) return false;
+
+	int buffer = buffer_size*2;
+	setsockopt(unix_socket, SOL_SOCKET, SO_SNDBUF, &buffer, sizeof(buffer));
+#ifdef SO_NOSIGPIPE
+	int optval = 1;
+	setsockopt(unix_socket, SOL_SOCKET, SO_NOSIGPIPE, (const void *)&optval, sizeof(int));
+#endif
+
+	if (connect(unix_socket, (struct sockaddr*)&address, sizeof(address))<0) {
+		closeSocket();
+		return false;
+	}
+	return true;
+#endif
+}
+
+void UnixSender::closeSocket() {
+#ifndef WIN32
+	if (unix_socket>=0) close(unix_socket);
+#endif
+	unix_socket = -1;
+}
+
+bool UnixSender::isConnected() {
+	return (unix_socket>=0);
+}
+
+bool UnixSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
+	if ( bundle->Size() == 0 ) return false;
+	return sendOscData(bundle->Data(), (unsigned int)bundle->Size());
+}
+
+bool UnixSender::sendOscData (const char *data, unsigned int size) {
+#ifdef WIN32
+	return false;
+#else
+	if (size>buffer_size) return false;
+
+	if (!sequenced) {
+		// packets are dropped rather than blocking the sender if the receiver queue is full
+		return (sendto(unix_socket, data, size, MSG_DONTWAIT, (struct sockaddr*)&address, sizeof(address))==(int)size);
+	}
+
+	if (unix_socket<0) {
+		if (TuioClock::getSystemTime()-connect_time<(osc::int64)UNIX_RECONNECT_INTERVAL*1000000) return false;
+		if (!connectSocket()) return false;
+		std::cout << "connected TUIO/UNIX receiver at " << path << std::endl;
+	}
+
+#ifdef MSG_NOSIGNAL
+	int flags = MSG_DONTWAIT | MSG_NOSIGNAL;
+#else
+	int flags = MSG_DONTWAIT;
+#endif
+	if (send(unix_socket, data, size, flags)==(int)size) return true;
+	if ((errno!=EAGAIN) && (errno!=EWOULDBLOCK)) {
+		std::cout << "closed TUIO/UNIX connection" << std::endl;
+		closeSocket();
+	}
+	return false;
+#endif
+}
@@ -0,0 +1,107 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_UNIXSENDER_H
+#define INCLUDED_UNIXSENDER_H
+
+#include "OscSender.h"
+
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#define TUIO_UNIX_PATH "/tmp/tuio.sock"
+#define MAX_UNIX_SIZE 65536
+#define MIN_UNIX_SIZE 576
+#define MAX_UNIX_PACKET_SIZE 262144
+#define UNIX_RECONNECT_INTERVAL 1000
+
+namespace TUIO {
+
+	/**
+	 * The UnixSender implements a local transport method for OSC over Unix domain sockets,
+	 * which bypasses the IP stack for receivers on the same host. With the default datagram socket
+	 * a whole frame of up to 64kB fits into a single message, which is dropped like a UDP packet
+	 * if the UnixReceiver is not running or its queue is full. The sequenced packet socket
+	 * additionally connects to the UnixReceiver, and reconnects after the receiver was restarted.
+	 * Unix domain sockets are not available on Windows.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL UnixSender : public OscSender {
+
+	public:
+
+		/**
+		 * This constructor creates a UnixSender that sends to the socket at the provided path
+		 *
+		 * @param  path  the socket path of the UnixReceiver, defaults to "/tmp/tuio.sock"
+		 * @param  sequenced  use a connected SOCK_SEQPACKET socket instead of a SOCK_DGRAM socket
+		 * @param  size  the maximum packet size, defaults to 65536
+		 */
+		UnixSender(const char *path=TUIO_UNIX_PATH, bool sequenced=false, int size=MAX_UNIX_SIZE);
+
+		/**
+		 * The destructor closes the socket
+		 */
+		virtual ~UnixSender();
+
+		/**
+		 * This method delivers the provided OSC data
+		 *
+		 * @param *bundle  the OSC stream to deliver
+		 * @return true if the data was delivered successfully
+		 */
+		bool sendOscPacket (osc::OutboundPacketStream *bundle);
+
+		/**
+		 * This method delivers an already encoded OSC packet
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @return true if the data was delivered successfully
+		 */
+		bool sendOscData (const char *data, unsigned int size);
+
+		/**
+		 * This method returns the connection state
+		 *
+		 * @return true if the datagram socket is open, or the sequenced packet socket is connected
+		 */
+		bool isConnected ();
+
+		const char* tuio_type() { return "TUIO/UNIX"; }
+
+	private:
+		bool connectSocket();
+		void closeSocket();
+
+		int unix_socket;
+		bool sequenced;
+		char path[108];
+		osc::int64 connect_time;
+#ifndef WIN32
+		struct sockaddr_un address;
+#endif
+	};
+}
+#endif /* INCLUDED_UNIXSENDER_H */
@@ -0,0 +1,87 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2009-2017 Martin Kaltenbrunner <martin@tuio.org>
+ WebSockSender (c) 2015 Florian Echtler <floe@butterbrot.org>
+ 
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+ 
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+ 
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_WEBSOCKPROTOCOL_H
+#define INCLUDED_WEBSOCKPROTOCOL_H
+
+#include "LibExport.h"
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+#define SHA1_HASH_SIZE (160/8)
+#define WEBSOCK_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+#define WEBSOCK_OPCODE_CONTINUATION 0x0
+#define WEBSOCK_OPCODE_TEXT 0x1
+#define WEBSOCK_OPCODE_BINARY 0x2
+#define WEBSOCK_OPCODE_CLOSE 0x8
+#define WEBSOCK_OPCODE_PING 0x9
+#define WEBSOCK_OPCODE_PONG 0xA
+
+#define WEBSOCK_FIN 0x80
+#define WEBSOCK_RSV1 0x40
+
+namespace TUIO {
+
+	/**
+	 * The WebSockProtocol provides the handshake and framing functions,
+	 * which are shared by the WebSockSender and the WebSockReceiver.
+	 *
+	 * @author Florian Echtler
+	 * @version 1.1.6
+	 */
+	class LIBDECL WebSockProtocol {
+
+	public:
+
+		/**
+		 * Returns the Sec-WebSocket-Accept value for the provided Sec-WebSocket-Key
+		 *
+		 * @param  key  the Sec-WebSocket-Key of the client handshake
+		 * @return the expected Sec-WebSocket-Accept value
+		 */
+		static std::string acceptKey(const std::string &key);
+
+		/**
+		 * Writes a frame header with the shortest length encoding for the provided payload size.
+		 * If a masking key is provided, it is appended to the header and the payload needs to be masked with maskPayload().
+		 *
+		 * @param  header  the header buffer of at least 16 bytes
+		 * @param  opcode  the first header byte, which combines the FIN and RSV1 flags with the opcode
+		 * @param  size  the payload size in bytes
+		 * @param  mask  the four byte masking key of a client frame, or NULL
+		 * @return the header size in bytes
+		 */
+		static unsigned int frameHeader(char *header, unsigned char opcode, uint64_t size, const unsigned char *mask=NULL);
+
+		/**
+		 * Masks or unmasks the provided payload in place
+		 *
+		 * @param  data  the payload data
+		 * @param  size  the payload size in bytes
+		 * @param  mask  the four byte masking key
+		 */
+		static void maskPayload(char *data, size_t size, const unsigned char *mask);
+
+		static void sha1( uint8_t digest[SHA1_HASH_SIZE], const uint8_t* inbuf, size_t length );
+		static std::string base64( const uint8_t* buffer, size_t size );
+	};
+}
+#endif /* INCLUDED_WEBSOCKPROTOCOL_H */
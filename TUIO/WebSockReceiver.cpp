@@ -0,0 +1,460 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#include "WebSockReceiver.h"
+#include "TuioClock.h"
+#include <errno.h>
+#include <ctype.h>
+
+#ifdef WEBSOCK_DEFLATE
+#include <zlib.h>
+#endif
+
+using namespace TUIO;
+using namespace osc;
+
+#ifndef  WIN32
+static void* ServerThreadFunc( void* obj )
+#else
+static DWORD WINAPI ServerThreadFunc( LPVOID obj )
+#endif
+{
+	WebSockReceiver *receiver = static_cast<WebSockReceiver*>(obj);
+	receiver->runEventLoop();
+	return 0;
+};
+
+#ifdef WIN32
+#define WEBSOCK_WOULD_BLOCK (WSAGetLastError()==WSAEWOULDBLOCK)
+#else
+#define WEBSOCK_WOULD_BLOCK ((errno==EAGAIN) || (errno==EWOULDBLOCK) || (errno==EINTR))
+#endif
+
+// workaround for connect method name conflict
+static int websock_connect(SocketHandle socket, const struct sockaddr *address, socklen_t address_len) {
+	return ::connect(socket, address, address_len);
+}
+
+WebSockReceiver::WebSockReceiver(const char *host, int port, const char *path, bool deflate)
+: tcp_socket	(-1)
+, data_size	(0)
+, message_compressed	(false)
+, message_opcode	(0)
+, open	(false)
+, compression	(false)
+, inflater	(NULL)
+, running	(false)
+, locked	(false)
+{
+	buffer = new char[WEBSOCK_STREAM_BUFFER_SIZE];
+	mask_seed = (unsigned int)TuioClock::getSystemTime() | 1;
+
+#ifdef WEBSOCK_DEFLATE
+	if (deflate) {
+		z_stream *stream = new z_stream();
+		memset(stream, 0, sizeof(z_stream));
+		inflateInit2(stream, -15);
+		inflater = stream;
+	}
+#else
+	if (deflate) std::cerr << "TUIO/WEB compression is not available" << std::endl;
+#endif
+
+	tcp_socket = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (tcp_socket < 0) {
+		std::cerr << "could not create TUIO/WEB socket" << std::endl;
+		return;
+	}
+
+	struct sockaddr_in tcp_server;
+	memset( &tcp_server, 0, sizeof (tcp_server));
+	unsigned long addr = inet_addr(host);
+	if (addr != INADDR_NONE) {
+		memcpy( (char *)&tcp_server.sin_addr, &addr, sizeof(addr));
+	} else {
+		struct hostent *host_info = gethostbyname(host);
+		if (host_info == NULL) {
+			std::cerr << "unknown host name: " << host << std::endl;
+			closeSocket();
+			return;
+		}
+		memcpy( (char *)&tcp_server.sin_addr, host_info->h_addr, host_info->h_length );
+	}
+
+	tcp_server.sin_family = AF_INET;
+	tcp_server.sin_port = htons(port);
+
+	int ret = websock_connect(tcp_socket,(struct sockaddr*)&tcp_server,sizeof(tcp_server));
+	if (ret<0) {
+		std::cerr << "could not connect to TUIO/WEB server at " << host << ":"<< port << std::endl;
+		closeSocket();
+		return;
+	}
+
+	// the random key only needs to differ between connections
+	unsigned char nonce[16];
+	for (int i=0;i<16;i++) {
+		mask_seed ^= mask_seed << 13;
+		mask_seed ^= mask_seed >> 17;
+		mask_seed ^= mask_seed << 5;
+		nonce[i] = (unsigned char)(mask_seed & 0xFF);
+	}
+	key = WebSockProtocol::base64(nonce, sizeof(nonce));
+
+	char request[1024];
+	snprintf(request, sizeof(request),
+		"GET %s HTTP/1.1\r\n"
+		"Host: %s:%d\r\n"
+		"Upgrade: websocket\r\n"
+		"Connection: Upgrade\r\n"
+		"Sec-WebSocket-Key: %s\r\n"
+		"Sec-WebSocket-Version: 13\r\n"
+		"%s\r\n",
+		path, host, port, key.c_str(),
+		(inflater!=NULL) ? "Sec-WebSocket-Extensions: permessage-deflate\r\n" : "");
+
+	// the request fits into the empty socket buffer, the response is processed by the event loop
+	int length = (int)strlen(request);
+	if (send(tcp_socket, request, length, 0)!=length) {
+		std::cerr << "could not send TUIO/WEB handshake to " << host << ":"<< port << std::endl;
+		closeSocket();
+		return;
+	}
+
+	int optval = 1;
+	setsockopt(tcp_socket, IPPROTO_TCP, TCP_NODELAY, (const char *)&optval, sizeof(int));
+#ifdef SO_TIMESTAMPNS
+	setsockopt(tcp_socket, SOL_SOCKET, SO_TIMESTAMPNS, &optval, sizeof(optval));
+#endif
+	SocketPoller::setNonBlocking(tcp_socket);
+	poller.addSocket(tcp_socket);
+	std::cout << "listening to TUIO/WEB messages from " << host << ":" << port << std::endl;
+}
+
+WebSockReceiver::~WebSockReceiver() {
+	disconnect();
+	if ((int)tcp_socket>=0) closeSocket();
+	delete[] buffer;
+#ifdef WEBSOCK_DEFLATE
+	if (inflater) {
+		inflateEnd((z_stream*)inflater);
+		delete (z_stream*)inflater;
+	}
+#endif
+}
+
+void WebSockReceiver::runEventLoop() {
+
+	while (running) {
+		int events = poller.wait(-1);
+		for (int i=0;i<events;i++) {
+			if (poller.getSocket(i)!=tcp_socket) continue;
+
+			int bytes = receive();
+			if ((bytes<0) && WEBSOCK_WOULD_BLOCK) continue;
+			if (bytes<=0) {
+				std::cout << "closed TUIO/WEB connection" << std::endl;
+				closeSocket();
+			}
+		}
+	}
+}
+
+int WebSockReceiver::receive() {
+
+	// the kernel receive time of the latest segment applies to all messages completed by this read
+	osc::int64 receive_time = 0;
+#ifdef SO_TIMESTAMPNS
+	struct iovec vector;
+	vector.iov_base = buffer+data_size;
+	vector.iov_len = WEBSOCK_STREAM_BUFFER_SIZE-data_size;
+	char control[64];
+	struct msghdr msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &vector;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof(control);
+
+	int bytes = (int)recvmsg(tcp_socket, &msg, 0);
+	if (bytes<=0) return bytes;
+	for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg!=NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+		if ((cmsg->cmsg_level==SOL_SOCKET) && (cmsg->cmsg_type==SCM_TIMESTAMPNS)) {
+			struct timespec ts;
+			memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+			receive_time = (osc::int64)ts.tv_sec*1000000000 + ts.tv_nsec;
+		}
+	}
+#else
+	int bytes = recv(tcp_socket, buffer+data_size, WEBSOCK_STREAM_BUFFER_SIZE-data_size, 0);
+	if (bytes<=0) return bytes;
+#endif
+	data_size += bytes;
+
+	if (!open) {
+		// the frames are only processed after the complete handshake response
+		int status = processHandshake();
+		if (status<=0) return status;
+		if (!open) return bytes;
+	}
+
+	if (processFrames(receive_time)<0) return 0;
+	return bytes;
+}
+
+int WebSockReceiver::processHandshake() {
+
+	std::string response(buffer, data_size);
+	size_t end = response.find("\r\n\r\n");
+	if (end==std::string::npos) {
+		if (data_size<WEBSOCK_MAX_RESPONSE) return 1;
+		std::cerr << "invalid TUIO/WEB handshake response" << std::endl;
+		return 0;
+	}
+
+	if ((response.compare(0, 9, "HTTP/1.1 ")!=0) || (response.compare(9, 3, "101")!=0)) {
+		std::cerr << "TUIO/WEB handshake rejected: " << response.substr(0, response.find("\r\n")) << std::endl;
+		return 0;
+	}
+
+	// compare the relevant header fields, their names are case-insensitive
+	std::string accept;
+	size_t line = response.find("\r\n")+2;
+	while (line<end) {
+		size_t next = response.find("\r\n", line);
+		size_t colon = response.find(':', line);
+		if (colon<next) {
+			std::string name = response.substr(line, colon-line);
+			for (size_t i=0;i<name.size();i++) name[i] = (char)tolower((unsigned char)name[i]);
+			size_t value = colon+1;
+			while ((value<next) && ((response[value]==' ') || (response[value]=='\t'))) value++;
+			size_t value_end = next;
+			while ((value_end>value) && ((response[value_end-1]==' ') || (response[value_end-1]=='\t'))) value_end--;
+
+			if (name=="sec-websocket-accept") accept = response.substr(value, value_end-value);
+			else if (name=="sec-websocket-extensions") {
+				if (response.find("permessage-deflate", value)<value_end) compression = (inflater!=NULL);
+			}
+		}
+		line = next+2;
+	}
+
+	if (accept!=WebSockProtocol::acceptKey(key)) {
+		std::cerr << "invalid TUIO/WEB handshake key" << std::endl;
+		return 0;
+	}
+
+	// frames may follow the response within the same read
+	data_size -= (unsigned int)end+4;
+	if (data_size>0) memmove(buffer, &buffer[end+4], data_size);
+	open = true;
+	return 1;
+}
+
+int WebSockReceiver::processFrames(osc::int64 receive_time) {
+
+	unsigned int offset = 0;
+	while (data_size-offset>=2) {
+		unsigned char *frame = (unsigned char*)&buffer[offset];
+		unsigned int available = data_size-offset;
+		unsigned char opcode = frame[0] & 0x0F;
+		bool fin = (frame[0] & WEBSOCK_FIN)!=0;
+		bool compressed = (frame[0] & WEBSOCK_RSV1)!=0;
+		bool masked = (frame[1] & 0x80)!=0;
+		uint64_t size = frame[1] & 0x7F;
+		unsigned int header_size = 2;
+		if (size==126) {
+			if (available<4) break;
+			size = ((uint64_t)frame[2]<<8) | (uint64_t)frame[3];
+			header_size = 4;
+		} else if (size==127) {
+			if (available<10) break;
+			size = 0;
+			for (int i=0;i<8;i++) size = (size<<8) | (uint64_t)frame[2+i];
+			header_size = 10;
+		}
+		if (masked) header_size += 4;
+
+		if (size>MAX_TCP_SIZE) {
+			std::cerr << "invalid TUIO/WEB frame size: " << size << std::endl;
+			return -1;
+		}
+		if (available<header_size+size) break;
+
+		char *payload = (char*)&frame[header_size];
+		if (masked) WebSockProtocol::maskPayload(payload, (size_t)size, &frame[header_size-4]);
+		offset += header_size+(unsigned int)size;
+
+		switch (opcode) {
+			case WEBSOCK_OPCODE_CLOSE:
+				sendFrame(WEBSOCK_OPCODE_CLOSE, payload, (size>=2) ? 2 : 0);
+				return -1;
+			case WEBSOCK_OPCODE_PING:
+				sendFrame(WEBSOCK_OPCODE_PONG, payload, (unsigned int)size);
+				break;
+			case WEBSOCK_OPCODE_PONG:
+				break;
+			default: {
+				if (opcode!=WEBSOCK_OPCODE_CONTINUATION) {
+					message.clear();
+					message_opcode = opcode;
+					message_compressed = compressed;
+					// complete binary messages are processed in place
+					if (fin && !compressed) {
+						if ((opcode==WEBSOCK_OPCODE_BINARY) && (size>0)) ProcessPacket(payload, (int)size, IpEndpointName(), receive_time);
+						break;
+					}
+				}
+
+				message.append(payload, (size_t)size);
+				if (message.size()>MAX_TCP_SIZE) {
+					std::cerr << "invalid TUIO/WEB message size: " << message.size() << std::endl;
+					return -1;
+				}
+				if (!fin) break;
+
+				if (message_compressed && !inflateMessage()) {
+					std::cerr << "invalid TUIO/WEB compressed message" << std::endl;
+					return -1;
+				}
+				if ((message_opcode==WEBSOCK_OPCODE_BINARY) && !message.empty()) ProcessPacket(message.data(), (int)message.size(), IpEndpointName(), receive_time);
+				message.clear();
+			}
+		}
+	}
+
+	// carry over the partial frame
+	if (offset>0) {
+		data_size -= offset;
+		if (data_size>0) memmove(buffer, &buffer[offset], data_size);
+	}
+	return 1;
+}
+
+bool WebSockReceiver::inflateMessage() {
+#ifdef WEBSOCK_DEFLATE
+	z_stream *stream = (z_stream*)inflater;
+	if (!compression || (stream==NULL)) return false;
+
+	// the inflater keeps its window, which also supports servers with context takeover
+	message.append("\x00\x00\xff\xff", 4);
+	stream->next_in = (Bytef*)message.data();
+	stream->avail_in = (uInt)message.size();
+
+	std::string output;
+	char chunk[4096];
+	do {
+		stream->next_out = (Bytef*)chunk;
+		stream->avail_out = sizeof(chunk);
+		int ret = inflate(stream, Z_SYNC_FLUSH);
+		if ((ret!=Z_OK) && (ret!=Z_BUF_ERROR) && (ret!=Z_STREAM_END)) return false;
+		output.append(chunk, sizeof(chunk)-stream->avail_out);
+		if (output.size()>MAX_TCP_SIZE) return false;
+		// a message may also end with a final block
+		if (ret==Z_STREAM_END) {
+			inflateReset(stream);
+			break;
+		}
+	} while (stream->avail_out==0);
+
+	message.swap(output);
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool WebSockReceiver::sendFrame(unsigned char opcode, const char *data, unsigned int size) {
+	if (((int)tcp_socket<0) || (size>TUIO_PING_SIZE+64)) return false;
+
+	// client frames are masked with a new key
+	mask_seed ^= mask_seed << 13;
+	mask_seed ^= mask_seed >> 17;
+	mask_seed ^= mask_seed << 5;
+	unsigned char mask[4];
+	memcpy(mask, &mask_seed, 4);
+
+	// the small frame is sent in a single write, and dropped if the socket buffer is full
+	char frame[TUIO_PING_SIZE+64+16];
+	unsigned int header_size = WebSockProtocol::frameHeader(frame, WEBSOCK_FIN | opcode, size, mask);
+	if (size>0) {
+		memcpy(&frame[header_size], data, size);
+		WebSockProtocol::maskPayload(&frame[header_size], size, mask);
+	}
+	int length = (int)(header_size+size);
+#ifdef MSG_NOSIGNAL
+	return (send(tcp_socket, frame, length, MSG_NOSIGNAL)==length);
+#else
+	return (send(tcp_socket, frame, length, 0)==length);
+#endif
+}
+
+bool WebSockReceiver::replyPacket( const char *data, int size, const IpEndpointName& remoteEndpoint ) {
+	if (!open || (size<=0) || (size>TUIO_PING_SIZE)) return false;
+	return sendFrame(WEBSOCK_OPCODE_BINARY, data, (unsigned int)size);
+}
+
+void WebSockReceiver::closeSocket() {
+	poller.removeSocket(tcp_socket);
+#ifdef WIN32
+	closesocket(tcp_socket);
+#else
+	close(tcp_socket);
+#endif
+	tcp_socket = -1;
+	open = false;
+	data_size = 0;
+}
+
+void WebSockReceiver::connect(bool lk) {
+
+	if (connected) return;
+	if ((int)tcp_socket<0) return;
+	locked = lk;
+
+	running = true;
+	connected = true;
+
+	if (!locked) {
+#ifndef WIN32
+		pthread_create(&server_thread , NULL, ServerThreadFunc, this);
+#else
+		server_thread = CreateThread( 0, 0, ServerThreadFunc, this, 0, &ServerThreadId );
+#endif
+	} else runEventLoop();
+}
+
+void WebSockReceiver::disconnect() {
+
+	if (!connected) return;
+
+	running = false;
+	poller.wakeup();
+
+	if (!locked) {
+#ifdef WIN32
+		WaitForSingleObject(server_thread, INFINITE);
+		if( server_thread ) CloseHandle( server_thread );
+#else
+		pthread_join(server_thread, NULL);
+#endif
+		server_thread = 0;
+	} else locked = false;
+
+	connected = false;
+}
@@ -0,0 +1,157 @@
+/*
+ TUIO C++ Library
+ Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 3.0 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library.
+*/
+
+#ifndef INCLUDED_WEBSOCKRECEIVER_H
+#define INCLUDED_WEBSOCKRECEIVER_H
+
+#include "OscReceiver.h"
+#include "SocketPoller.h"
+#include "WebSockProtocol.h"
+#include <string>
+
+#ifndef MAX_TCP_SIZE
+#define MAX_TCP_SIZE 65536
+#endif
+#define WEBSOCK_STREAM_BUFFER_SIZE (2*(MAX_TCP_SIZE+14))
+#define WEBSOCK_MAX_RESPONSE 8192
+
+#ifdef WIN32
+#include <winsock.h>
+#include <io.h>
+typedef int socklen_t;
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+namespace TUIO {
+
+	/**
+	 * The WebSockReceiver provides the OscReceiver functionality for the WebSocket transport method of the WebSockSender.
+	 * It connects to a WebSocket server and sends the HTTP upgrade request, while the response and all following frames
+	 * are parsed incrementally by an event loop with non-blocking reads. Binary messages are passed in place to the
+	 * attached TuioClients unless they were fragmented or compressed, and replies are sent as masked binary frames.
+	 *
+	 * @author Martin Kaltenbrunner
+	 * @version 1.1.6
+	 */
+	class LIBDECL WebSockReceiver: public OscReceiver {
+
+	public:
+
+		/**
+		 * This constructor creates a WebSockReceiver connected to the provided host and port
+		 *
+		 * @param  host  the host name to connect, defaults to "localhost"
+		 * @param  port  the WebSocket port number, defaults to the HTTP-alt port 8080
+		 * @param  path  the requested resource path, defaults to "/"
+		 * @param  deflate  offer the permessage-deflate extension to the server if set to true
+		 */
+		WebSockReceiver (const char *host="localhost", int port=8080, const char *path="/", bool deflate=false);
+
+		/**
+		 * The destructor disconnects the WebSockReceiver and closes its socket
+		 */
+		virtual ~WebSockReceiver();
+
+		/**
+		 * The WebSockReceiver connects and starts receiving TUIO messages via WebSocket
+		 *
+		 * @param  lock  running in the background if set to false (default)
+		 */
+		void connect(bool lock=false);
+
+		/**
+		 * The WebSockReceiver disconnects and stops receiving TUIO messages via WebSocket
+		 */
+		void disconnect();
+
+		/**
+		 * This method runs the event loop until the WebSockReceiver is disconnected,
+		 * it is only public to be accessible from the thread function
+		 */
+		void runEventLoop();
+
+		/**
+		 * Sends the provided OSC packet as a masked binary frame to the WebSocket server
+		 *
+		 * @param  data  the OSC packet data
+		 * @param  size  the OSC packet size
+		 * @param  remoteEndpoint  the source of the received OSC packet, which is not used
+		 * @return true if the packet was sent
+		 */
+		bool replyPacket( const char *data, int size, const IpEndpointName &remoteEndpoint );
+
+		/**
+		 * Returns true once the server accepted the WebSocket handshake
+		 *
+		 * @return true if the handshake is complete
+		 */
+		bool isOpen() { return open; };
+
+		/**
+		 * Returns true if the server accepted the permessage-deflate extension
+		 *
+		 * @return true if the messages can be compressed
+		 */
+		bool isCompressed() { return compression; };
+
+#ifndef WIN32
+		int tcp_socket;
+#else
+		SOCKET tcp_socket;
+#endif
+
+	private:
+
+		int receive();
+		int processHandshake();
+		int processFrames(osc::int64 receive_time);
+		bool inflateMessage();
+		bool sendFrame(unsigned char opcode, const char *data, unsigned int size);
+		void closeSocket();
+
+		SocketPoller poller;
+		char *buffer;
+		unsigned int data_size;
+		std::string message;
+		bool message_compressed;
+		unsigned char message_opcode;
+		std::string key;
+		unsigned int mask_seed;
+		bool open;
+		bool compression;
+		void *inflater;
+		bool running;
+
+#ifndef WIN32
+		pthread_t server_thread;
+#else
+		HANDLE server_thread;
+		DWORD ServerThreadId;
+#endif
+
+		bool locked;
+	};
+};
+#endif /* INCLUDED_WEBSOCKRECEIVER_H */
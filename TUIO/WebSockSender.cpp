@@ -18,263 +18,301 @@
 */
 
 #include "WebSockSender.h"
+#include "TuioClock.h"
+#include <ctype.h>
+
+#ifdef WEBSOCK_DEFLATE
+#include <zlib.h>
+#endif
+
+#define WEBSOCK_DEFLATE_RESPONSE "Sec-WebSocket-Extensions: permessage-deflate; server_no_context_takeover; client_no_context_takeover\r\n"
 
 using namespace TUIO;
 
 WebSockSender::WebSockSender()
-	:TcpSender( 8080 )
+	:TcpSender( 8080, true )
 {
-	local = true;
-	buffer_size = MAX_TCP_SIZE;
+	init();
 	port_no = 8080;
 }
 
 WebSockSender::WebSockSender(int port)
-	:TcpSender( port )
+	:TcpSender( port, true )
 {
-	local = true;
-	buffer_size = MAX_TCP_SIZE;
+	init();
 	port_no = port;
 }
 
-bool WebSockSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
-	if (!connected) return false; 
-	if ( bundle->Size() > buffer_size ) return false;
-	if ( bundle->Size() == 0 ) return false;
-	
-#ifdef OSC_HOST_LITTLE_ENDIAN             
-	data_size[0] =  bundle->Size()>>24;
-	data_size[1] = (bundle->Size()>>16) & 255;
-	data_size[2] = (bundle->Size()>>8) & 255;
-	data_size[3] = (bundle->Size()) & 255;
-#else
-	*((int32_t*)data_size) = bundle->Size();
+WebSockSender::~WebSockSender() {
+
+	stopEventLoop();
+#ifdef WEBSOCK_DEFLATE
+	if (deflater) {
+		deflateEnd((z_stream*)deflater);
+		delete (z_stream*)deflater;
+	}
+	if (inflater) {
+		inflateEnd((z_stream*)inflater);
+		delete (z_stream*)inflater;
+	}
 #endif
+}
+
+void WebSockSender::init() {
+	local = true;
+	buffer_size = MAX_TCP_SIZE;
+	compression = false;
+	deflater = NULL;
+	inflater = NULL;
+}
 
-#ifdef WIN32
-	std::list<SOCKET>::iterator client;
+bool WebSockSender::setDeflate(bool enable) {
+#ifdef WEBSOCK_DEFLATE
+	if (enable && (deflater==NULL)) {
+		z_stream *stream = new z_stream();
+		memset(stream, 0, sizeof(z_stream));
+		// raw deflate with a full window, since every message is compressed independently
+		if (deflateInit2(stream, WEBSOCK_DEFLATE_LEVEL, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY)!=Z_OK) {
+			std::cerr << "could not initialize " << tuio_type() << " compression" << std::endl;
+			delete stream;
+			return false;
+		}
+		inflater = new z_stream();
+		memset(inflater, 0, sizeof(z_stream));
+		inflateInit2((z_stream*)inflater, -15);
+		deflater = stream;
+	}
+	compression = enable;
+	return true;
 #else
-	std::list<int>::iterator client;
+	if (enable) std::cerr << tuio_type() << " compression is not available" << std::endl;
+	return false;
 #endif
-	
-	for (client = tcp_client_list.begin(); client!=tcp_client_list.end(); client++) {
-		size_t len = bundle->Size();
-		// add WebSocket header on top
-		uint8_t header[4] = {
-			0x82,
-			(uint8_t)( len & 0xFF), 
-			(uint8_t)((len >>8) & 0xFF),
-			(uint8_t)( len & 0xFF)
-		};
-		int hs = 2;
-		if (len > 125) { hs = 4; header[1] = 126; }
-		memcpy(&data_buffer[0], &header, hs);
-		memcpy(&data_buffer[hs], bundle->Data(), bundle->Size());
-		send((*client),data_buffer, hs+bundle->Size(),0);
-	}
+}
 
-	return true;
+unsigned int WebSockSender::packetHeader(char *header, unsigned int size) {
+	// add WebSocket header on top
+	return WebSockProtocol::frameHeader(header, WEBSOCK_FIN | WEBSOCK_OPCODE_BINARY, size);
 }
 
-void WebSockSender::newClient( int tcp_client ) {
+void WebSockSender::encodeFrame(int format, const char *data, unsigned int size, TcpFrame &frame) {
+#ifdef WEBSOCK_DEFLATE
+	if ((format==WEBSOCK_FORMAT_DEFLATE) && (size>=WEBSOCK_DEFLATE_THRESHOLD)) {
+		z_stream *stream = (z_stream*)deflater;
+		unsigned long bound = deflateBound(stream, size)+16;
+		if (deflate_buffer.size()<bound) deflate_buffer.resize(bound);
 
-	// socket -> file descriptor
-#ifdef WIN32
-	FILE* conn = _fdopen( tcp_client, "r+" );
-#else
-	FILE* conn = fdopen( tcp_client, "r+" );
+		// without context takeover each packet is compressed only once for all clients
+		deflateReset(stream);
+		stream->next_in = (Bytef*)data;
+		stream->avail_in = size;
+		stream->next_out = (Bytef*)&deflate_buffer[0];
+		stream->avail_out = (uInt)deflate_buffer.size();
+
+		if (deflate(stream, Z_SYNC_FLUSH)==Z_OK) {
+			// the trailing empty block of the sync flush is implied by the extension
+			unsigned int deflate_size = (unsigned int)(deflate_buffer.size()-stream->avail_out);
+			if (deflate_size>=4) deflate_size -= 4;
+			if (deflate_size<size) {
+				frame.header_size = WebSockProtocol::frameHeader(frame.header, WEBSOCK_FIN | WEBSOCK_RSV1 | WEBSOCK_OPCODE_BINARY, deflate_size);
+				frame.data = &deflate_buffer[0];
+				frame.data_size = deflate_size;
+				return;
+			}
+		}
+	}
 #endif
+	TcpSender::encodeFrame(format, data, size, frame);
+}
 
-	// websocket challenge-response
-	uint8_t digest[SHA1_HASH_SIZE];
-	char buf[1024] = "...";
-	char key[1024];
-
-	// read client handshake challenge
-	while ((buf[0] != 0) && (buf[0] != '\r')) {
-		fgets( buf, sizeof(buf), conn );
-		if (strncmp(buf,"Sec-WebSocket-Key: ",19) == 0) {
-			strncpy(key,buf+19,sizeof(key));
-			key[strlen(buf)-21] = 0;
-			break;
+void WebSockSender::processInput(TcpClient *client) {
+	if (!client->ready && !processHandshake(client)) return;
+	processFrames(client);
+}
+
+bool WebSockSender::processHandshake(TcpClient *client) {
+
+	std::string &request = client->input;
+	size_t end = request.find("\r\n\r\n");
+	if (end==std::string::npos) {
+		if (request.size()>WEBSOCK_MAX_REQUEST) client->closing = true;
+		return false;
+	}
+
+	// collect the relevant header fields, their names are case-insensitive
+	std::string key, extensions;
+	size_t line = request.find("\r\n")+2;
+	while (line<end) {
+		size_t next = request.find("\r\n", line);
+		size_t colon = request.find(':', line);
+		if (colon<next) {
+			std::string name = request.substr(line, colon-line);
+			for (size_t i=0;i<name.size();i++) name[i] = (char)tolower((unsigned char)name[i]);
+			size_t value = colon+1;
+			while ((value<next) && ((request[value]==' ') || (request[value]=='\t'))) value++;
+			size_t value_end = next;
+			while ((value_end>value) && ((request[value_end-1]==' ') || (request[value_end-1]=='\t'))) value_end--;
+
+			if (name=="sec-websocket-key") key = request.substr(value, value_end-value);
+			else if (name=="sec-websocket-extensions") {
+				if (!extensions.empty()) extensions += ",";
+				extensions += request.substr(value, value_end-value);
+			}
 		}
+		line = next+2;
+	}
+
+	bool upgrade = (request.compare(0, 4, "GET ")==0);
+	request.erase(0, end+4);
+
+	if (!upgrade || key.empty()) {
+		const char *reply = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n";
+		writeClient(client, NULL, 0, reply, (unsigned int)strlen(reply));
+		client->closing = true;
+		return false;
 	}
 
-	strncat(key,"258EAFA5-E914-47DA-95CA-C5AB0DC85B11",sizeof(key)-strlen(key)-1);
-	sha1(digest,(uint8_t*)key,strlen(key));
+	// websocket challenge-response
+	bool deflate_client = compression && acceptDeflate(extensions);
 
+	char buf[1024];
 	snprintf(buf, sizeof(buf),
 		"HTTP/1.1 101 Switching Protocols\r\n"
 		"Upgrade: websocket\r\n"
 		"Connection: Upgrade\r\n"
 		"Access-Control-Allow-Origin: *\r\n"
+		"%s"
 		"Sec-WebSocket-Accept: %s\r\n\r\n",
-		base64( digest, SHA1_HASH_SIZE ).c_str() ); 
+		deflate_client ? WEBSOCK_DEFLATE_RESPONSE : "",
+		WebSockProtocol::acceptKey(key).c_str() );
+	writeClient(client, NULL, 0, buf, (unsigned int)strlen(buf));
 
-	send(tcp_client,buf, strlen(buf),0);
+	client->format = deflate_client ? WEBSOCK_FORMAT_DEFLATE : WEBSOCK_FORMAT_PLAIN;
+	readyClient(client);
+	return true;
 }
 
+bool WebSockSender::acceptDeflate(const std::string &extensions) {
 
-/*
- * Incredibly minimal implementation of SHA1.
- * Totally independent of any other code (even libc) so it can be
- * run on bare hardware.
- *
- * Copyright (C) 2009 John Stumpo
- * All rights reserved.
- *
- * Redistribution and use in source and binary forms, with or without
- * modification, are permitted provided that the following conditions are met:
- *		 * Redistributions of source code must retain the above copyright
- *			 notice, this list of conditions and the following disclaimer.
- *		 * Redistributions in binary form must reproduce the above copyright
- *			 notice, this list of conditions and the following disclaimer in the
- *			 documentation and/or other materials provided with the distribution.
- *
- * THIS SOFTWARE IS PROVIDED BY JOHN STUMPO ''AS IS'' AND ANY
- * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
- * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
- * DISCLAIMED. IN NO EVENT SHALL JOHN STUMPO BE LIABLE FOR ANY
- * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
- * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
- * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
- * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
- * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
- * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
- */
-
-void WebSockSender::sha1( uint8_t digest[SHA1_HASH_SIZE], const uint8_t* inbuf, size_t length) {
-	
-	int i, j;
-	int remaining_bytes;
-	uint32_t h0, h1, h2, h3, h4, a, b, c, d, e, temp;
-	uint32_t w[80];
-	unsigned char buf[64];
-	
-	/* Initialize SHA1 hash state. */
-	h0 = 0x67452301;
-	h1 = 0xefcdab89;
-	h2 = 0x98badcfe;
-	h3 = 0x10325476;
-	h4 = 0xc3d2e1f0;
-	
-	/* The extra 9 bytes are the pad byte (0x80) and 64-bit bit count that
-	 are appended to the data being hashed.	(There will more than likely
-	 also be some zeroes in between the 0x80 and the bit count so that we
-	 operate on a multiple of 64 bytes; 9 bytes, though, is the minimal
-	 amount of extra data.)	*/
-	for (i = 0; i < length + 9; i += 64) {
-		
-		/* Perform any padding necessary. */
-		remaining_bytes = (int)length - i;
-		if (remaining_bytes >= 64) {
-			memcpy(buf, inbuf + i, 64);
-		} else if (remaining_bytes >= 0) {
-			memcpy(buf, inbuf + i, remaining_bytes);
-			memset(buf + remaining_bytes, 0, 64 - remaining_bytes);
-			buf[remaining_bytes] = 0x80;
-		} else {
-			memset(buf, 0, 64);
-		}
-		
-		if (remaining_bytes < 56)
-			*(uint32_t*)(buf + 60) = SWAP(length * 8);
-		
-		/* Build the input array. */
-		for (j = 0; j < 16; j++)
-			w[j] = SWAP(*(uint32_t*)(buf + j * 4));
-		
-		for (j = 16; j < 80; j++)
-			w[j] = ROL(w[j - 3] ^ w[j - 8] ^ w[j - 14] ^ w[j - 16], 1);
-		
-		/* Load hash state. */
-		a = h0;
-		b = h1;
-		c = h2;
-		d = h3;
-		e = h4;
-		
-		for (j = 0; j < 80; j++) {
-			
-			if (j < 20)
-				temp = ((b & c) | ((~b) & d)) + 0x5a827999;
-			else if (j < 40)
-				temp = (b ^ c ^ d) + 0x6ed9eba1;
-			else if (j < 60)
-				temp = ((b & c) | (b & d) | (c & d)) + 0x8f1bbcdc;
-			else
-				temp = (b ^ c ^ d) + 0xca62c1d6;
-			
-			temp += ROL(a, 5) + e + w[j];
-			
-			e = d;
-			d = c;
-			c = ROR(b, 2);
-			b = a;
-			a = temp;
+	// accept the first permessage-deflate offer that does not restrict our window size
+	size_t offer = 0;
+	while (offer<extensions.size()) {
+		size_t offer_end = extensions.find(',', offer);
+		if (offer_end==std::string::npos) offer_end = extensions.size();
+
+		bool accept = true;
+		int index = 0;
+		size_t param = offer;
+		while (param<offer_end) {
+			size_t param_end = extensions.find(';', param);
+			if ((param_end==std::string::npos) || (param_end>offer_end)) param_end = offer_end;
+			std::string token;
+			for (size_t i=param;i<param_end;i++) {
+				if ((extensions[i]!=' ') && (extensions[i]!='\t') && (extensions[i]!='"')) token += (char)tolower((unsigned char)extensions[i]);
+			}
+
+			if (index==0) accept = (token=="permessage-deflate");
+			else if (token.compare(0, 23, "server_max_window_bits=")==0) accept = accept && (atoi(token.c_str()+23)>=15);
+			else if ((token!="server_no_context_takeover") && (token!="client_no_context_takeover") && (token.compare(0, 22, "client_max_window_bits")!=0)) accept = false;
+
+			index++;
+			param = param_end+1;
 		}
-		
-		/* Incorporate the results of the hash operation. */
-		h0 += a;
-		h1 += b;
-		h2 += c;
-		h3 += d;
-		h4 += e;
+
+		if (accept) return true;
+		offer = offer_end+1;
 	}
-	
-	/* Write the hash into the output buffer. */
-	*(uint32_t*)(digest) = SWAP(h0);
-	*(uint32_t*)(digest + 4) = SWAP(h1);
-	*(uint32_t*)(digest + 8) = SWAP(h2);
-	*(uint32_t*)(digest + 12) = SWAP(h3);
-	*(uint32_t*)(digest + 16) = SWAP(h4);
+	return false;
 }
 
-/* 
- * a very simple base64 encoder, licensed as public domain. original source:
- * https://en.wikibooks.org/wiki/Algorithm_Implementation/Miscellaneous/Base64
- */
-
-const static unsigned char encodeLookup[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-const static unsigned char padCharacter = '=';
-
-std::string WebSockSender::base64( uint8_t* cursor, size_t size ) {
-	
-	std::string encodedString;
-	uint32_t temp;
-	
-	encodedString.reserve(((size/3) + (size % 3 > 0)) * 4);
-	
-	for (size_t idx = 0; idx < size/3; idx++) {
-		
-		temp  = (*cursor++) << 16;
-		temp += (*cursor++) << 8;
-		temp += (*cursor++);
-		
-		encodedString.append( 1, encodeLookup[(temp & 0x00FC0000) >> 18] );
-		encodedString.append( 1, encodeLookup[(temp & 0x0003F000) >> 12] );
-		encodedString.append( 1, encodeLookup[(temp & 0x00000FC0) >> 6 ] );
-		encodedString.append( 1, encodeLookup[(temp & 0x0000003F)      ] );
-	}
-	
-	switch (size % 3) {
-		case 1:
-			temp = (*cursor++) << 16;
-			encodedString.append( 1, encodeLookup[(temp & 0x00FC0000) >> 18] );
-			encodedString.append( 1, encodeLookup[(temp & 0x0003F000) >> 12] );
-			encodedString.append( 2, padCharacter );
-			break;
-		case 2:
-			temp  = (*cursor++) << 16;
-			temp += (*cursor++) << 8;
-			encodedString.append( 1, encodeLookup[(temp & 0x00FC0000) >> 18] );
-			encodedString.append( 1, encodeLookup[(temp & 0x0003F000) >> 12] );
-			encodedString.append( 1, encodeLookup[(temp & 0x00000FC0) >> 6 ] );
-			encodedString.append( 1, padCharacter);
-			break;
+void WebSockSender::processFrames(TcpClient *client) {
+
+	osc::int64 receive_time = TuioClock::getSystemTime();
+	char pong[TUIO_PING_SIZE];
+
+	while (client->input.size()>=2) {
+		const unsigned char *frame = (const unsigned char*)client->input.data();
+		unsigned char opcode = frame[0] & 0x0F;
+		bool compressed = (frame[0] & WEBSOCK_RSV1)!=0;
+		bool masked = (frame[1] & 0x80)!=0;
+		uint64_t size = frame[1] & 0x7F;
+		size_t offset = 2;
+		if (size==126) {
+			if (client->input.size()<4) return;
+			size = ((uint64_t)frame[2]<<8) | (uint64_t)frame[3];
+			offset = 4;
+		} else if (size==127) {
+			if (client->input.size()<10) return;
+			size = 0;
+			for (int i=0;i<8;i++) size = (size<<8) | (uint64_t)frame[2+i];
+			offset = 10;
+		}
+
+		// client frames need to be masked, and only carry control messages and clock synchronization requests
+		if (!masked || (size>WEBSOCK_MAX_MESSAGE)) {
+			client->closing = true;
+			return;
+		}
+		if (client->input.size()<offset+4+size) return;
+
+		const unsigned char *mask = frame+offset;
+		message.assign(client->input, offset+4, (size_t)size);
+		if (!message.empty()) WebSockProtocol::maskPayload(&message[0], message.size(), mask);
+		client->input.erase(0, offset+4+(size_t)size);
+
+		switch (opcode) {
+			case WEBSOCK_OPCODE_CLOSE:
+				// echo the close status code and close the connection
+				sendControl(client, WEBSOCK_OPCODE_CLOSE, message.data(), (message.size()>=2) ? 2 : 0);
+				client->closing = true;
+				return;
+			case WEBSOCK_OPCODE_PING:
+				sendControl(client, WEBSOCK_OPCODE_PONG, message.data(), (unsigned int)message.size());
+				break;
+			case WEBSOCK_OPCODE_TEXT:
+			case WEBSOCK_OPCODE_BINARY: {
+				if (compressed && ((client->format!=WEBSOCK_FORMAT_DEFLATE) || !inflateMessage())) {
+					client->closing = true;
+					return;
+				}
+				unsigned int pong_size = TuioClock::answerPing(message.data(), (unsigned int)message.size(), receive_time, pong, sizeof(pong));
+				if (pong_size>0) replyClient(client, pong, pong_size);
+				break;
+			}
+		}
 	}
-	
-	return encodedString;
 }
 
+bool WebSockSender::inflateMessage() {
+#ifdef WEBSOCK_DEFLATE
+	z_stream *stream = (z_stream*)inflater;
+	if (stream==NULL) return false;
+
+	message.append("\x00\x00\xff\xff", 4);
+	inflateReset(stream);
+	stream->next_in = (Bytef*)message.data();
+	stream->avail_in = (uInt)message.size();
 
+	std::string output;
+	char chunk[4096];
+	do {
+		stream->next_out = (Bytef*)chunk;
+		stream->avail_out = sizeof(chunk);
+		int ret = inflate(stream, Z_SYNC_FLUSH);
+		if ((ret!=Z_OK) && (ret!=Z_STREAM_END) && (ret!=Z_BUF_ERROR)) return false;
+		output.append(chunk, sizeof(chunk)-stream->avail_out);
+		if (output.size()>WEBSOCK_MAX_MESSAGE) return false;
+	} while (stream->avail_out==0);
+
+	message.swap(output);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void WebSockSender::sendControl(TcpClient *client, unsigned char opcode, const char *data, unsigned int size) {
+	char header[16];
+	unsigned int header_size = WebSockProtocol::frameHeader(header, WEBSOCK_FIN | opcode, size);
+	writeClient(client, header, header_size, data, size);
+}
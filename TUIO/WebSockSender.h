@@ -53,24 +53,29 @@ __inline int c99_snprintf(char *outBuf, size_t size, const char *format, ...)
 #endif
 
 
-/* All of these macros assume use on a 32-bit variable.
- Additionally, SWAP assumes we're little-endian.	*/
-#define SWAP(a) ((((a) >> 24) & 0x000000ff) | (((a) >>	8) & 0x0000ff00) | \
-(((a) <<	8) & 0x00ff0000) | (((a) << 24) & 0xff000000))
-#define ROL(a, b) (((a) << (b)) | ((a) >> (32 - (b))))
-#define ROR(a, b) ROL((a), (32 - (b)))
-#define SHA1_HASH_SIZE (160/8)
-
 #include "TcpSender.h"
+#include "WebSockProtocol.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
 #include <vector>
 
+#define WEBSOCK_MAX_REQUEST 8192
+#define WEBSOCK_MAX_MESSAGE 65536
+#define WEBSOCK_DEFLATE_THRESHOLD 128
+#define WEBSOCK_DEFLATE_LEVEL 1
+
+#define WEBSOCK_FORMAT_PLAIN 0
+#define WEBSOCK_FORMAT_DEFLATE 1
+
 namespace TUIO {
 	
 	/**
-	 * The WebSockSender implements the WebSocket transport method for OSC
+	 * The WebSockSender implements the WebSocket transport method for OSC.
+	 * The HTTP upgrade handshake of each client is processed asynchronously by the TcpSender event loop,
+	 * and packets are only delivered to clients that completed the handshake.
+	 * With setDeflate() the permessage-deflate extension is offered to the clients,
+	 * each packet is then compressed once and shared by all clients that accepted the extension.
 	 *
 	 * @author Florian Echtler
 	 * @version 1.1.6
@@ -94,28 +99,55 @@ namespace TUIO {
 		/**
 		 * The destructor closes the socket. 
 		 */
-		virtual ~WebSockSender() {}
-		
+		virtual ~WebSockSender();
+
 		/**
-		 * This method delivers the provided OSC data
+		 * This method enables or disables the permessage-deflate extension for all clients that connect afterwards.
+		 * Compression requires a library built with WEBSOCK_DEFLATE and zlib,
+		 * packets smaller than WEBSOCK_DEFLATE_THRESHOLD are always sent uncompressed.
 		 *
-		 * @param *bundle  the OSC stream to deliver
-		 * @return true if the data was delivered successfully
+		 * @param  enable  offer permessage-deflate to new clients if set to true
+		 * @return true if permessage-deflate is available
 		 */
-		bool sendOscPacket (osc::OutboundPacketStream *bundle);
+		bool setDeflate(bool enable);
 
 		/**
-		 * This method is called whenever a new client connects
+		 * This method returns true if permessage-deflate is offered to new clients
 		 *
-		 * @param tcp_client the socket handle of the new client
+		 * @return true if permessage-deflate is enabled
 		 */
-		void newClient( int tcp_client );
+		bool getDeflate() { return compression; }
 	
 		const char* tuio_type() { return "TUIO/WEB"; }
+
+	protected:
+
+		/**
+		 * This method writes the WebSocket binary frame header for a packet of the provided size
+		 *
+		 * @param  header  the header buffer of at least 16 bytes
+		 * @param  size  the packet size in bytes
+		 * @return the header size in bytes
+		 */
+		unsigned int packetHeader(char *header, unsigned int size);
+
+		void encodeFrame(int format, const char *data, unsigned int size, TcpFrame &frame);
+		void processInput(TcpClient *client);
+
 	private:
-		
-		void sha1( uint8_t digest[SHA1_HASH_SIZE], const uint8_t* inbuf, size_t length );
-		std::string base64( uint8_t* buffer, size_t size );
+
+		void init();
+		bool processHandshake(TcpClient *client);
+		void processFrames(TcpClient *client);
+		bool acceptDeflate(const std::string &extensions);
+		bool inflateMessage();
+		void sendControl(TcpClient *client, unsigned char opcode, const char *data, unsigned int size);
+
+		bool compression;
+		void *deflater;
+		void *inflater;
+		std::vector<char> deflate_buffer;
+		std::string message;
 	};
 }
 #endif /* INCLUDED_WEBSOCKSENDER_H */
@@ -0,0 +1,714 @@
+/*
+	TUIO C++ Example - part of the reacTIVision project
+	http://reactivision.sourceforge.net/
+
+	Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "TuioBench.h"
+#include "ShmSender.h"
+#include "ShmReceiver.h"
+#include "UdpSender.h"
+#include "UdpReceiver.h"
+#include "UnixSender.h"
+#include "UnixReceiver.h"
+#include "TcpSender.h"
+#include "TcpReceiver.h"
+#include "WebSockSender.h"
+#include "WebSockReceiver.h"
+#include "TuioSceneReader.h"
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <new>
+#include <algorithm>
+#ifndef WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define BENCH_ENTITIES 100
+#define BENCH_LARGE_SCENE 500
+#define BENCH_MTU_SIZE 1500
+#define BENCH_FRAMES 1000
+#define BENCH_TRACKER_WORK 200000
+#define BENCH_SHM_NAME "/tuiobench"
+#define BENCH_UDP_PORT 3399
+#define BENCH_TCP_PORT 3398
+#define BENCH_WEB_PORT 8098
+#define BENCH_UNIX_PATH "/tmp/tuiobench.sock"
+#define BENCH_SCENE_NAME "/tuiobench_scene"
+
+#ifdef WIN32
+#define BENCH_THREAD __declspec(thread)
+#else
+#define BENCH_THREAD __thread
+#endif
+
+static double _benchtime = 1.0;
+static std::string _filter("");
+static bool _transport = false;
+
+// the heap allocations of each thread are counted separately, so that background threads do not distort the results
+static BENCH_THREAD long _allocs = 0;
+
+void* operator new(size_t size) {
+	_allocs++;
+	void *ptr = malloc(size>0 ? size : 1);
+	if (ptr==NULL) throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void *ptr) throw() {
+	free(ptr);
+}
+
+void operator delete[](void *ptr) throw() {
+	free(ptr);
+}
+
+// the sized variants are used since C++14, and must release the memory of the replaced operator new as well
+void operator delete(void *ptr, size_t) throw() {
+	operator delete(ptr);
+}
+
+void operator delete[](void *ptr, size_t) throw() {
+	operator delete[](ptr);
+}
+
+CaptureSender::CaptureSender(int size)
+	:capture	(false)
+	,bytes		(0)
+{
+	local = true;
+	buffer_size = size;
+}
+
+bool CaptureSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
+	if ( bundle->Size() == 0 ) return false;
+	bytes += (long)bundle->Size();
+	if (capture) packets.push_back(std::string(bundle->Data(), bundle->Size()));
+	return true;
+}
+
+DeliveryTap::DeliveryTap()
+	:packets	(0)
+{
+#ifdef WIN32
+	deliveryEvent = CreateEvent(NULL,FALSE,FALSE,NULL);
+#else
+	pthread_mutex_init(&deliveryMutex,NULL);
+	pthread_cond_init(&deliveryCond,NULL);
+#endif
+}
+
+DeliveryTap::~DeliveryTap() {
+#ifdef WIN32
+	CloseHandle(deliveryEvent);
+#else
+	pthread_cond_destroy(&deliveryCond);
+	pthread_mutex_destroy(&deliveryMutex);
+#endif
+}
+
+void DeliveryTap::ProcessPacket( const char *data, int size, const IpEndpointName &remoteEndpoint ) {
+#ifdef WIN32
+	InterlockedIncrement(&packets);
+	SetEvent(deliveryEvent);
+#else
+	pthread_mutex_lock(&deliveryMutex);
+	packets++;
+	pthread_cond_signal(&deliveryCond);
+	pthread_mutex_unlock(&deliveryMutex);
+#endif
+}
+
+void DeliveryTap::waitFor(long count) {
+#ifdef WIN32
+	while (packets<count) WaitForSingleObject(deliveryEvent, INFINITE);
+#else
+	pthread_mutex_lock(&deliveryMutex);
+	while (packets<count) pthread_cond_wait(&deliveryCond, &deliveryMutex);
+	pthread_mutex_unlock(&deliveryMutex);
+#endif
+}
+
+static osc::int64 cpuTime() {
+	return (osc::int64)clock() * (1000000000LL/CLOCKS_PER_SEC);
+}
+
+void BenchTimer::start() {
+	start_allocs = _allocs;
+	start_cpu = cpuTime();
+	start_time = TuioClock::getSystemTime();
+}
+
+void BenchTimer::stop() {
+	elapsed += TuioClock::getSystemTime() - start_time;
+	cpu += cpuTime() - start_cpu;
+	allocs += _allocs - start_allocs;
+}
+
+/* frame times advance by 10ms, independent of the actual benchmark speed */
+static TuioTime frameTime(long frame) {
+	return TuioTime(frame/100, (frame%100)*10000);
+}
+
+static float wave(long frame, int index, float phase) {
+	return 0.5f + 0.4f*sinf((float)frame*0.01f + (float)index*0.1f + phase);
+}
+
+/* updates a scene of entities of a single profile within the current frame */
+class BenchScene {
+
+	public:
+		BenchScene(TuioManager *manager, char profile, int count=BENCH_ENTITIES) : manager(manager), profile(profile), count(count) {
+			for (int i=0;i<count;i++) {
+				if (profile=='c') cursorList.push_back(manager->addTuioCursor(wave(0,i,0.0f), wave(0,i,1.0f)));
+				else if (profile=='o') objectList.push_back(manager->addTuioObject(i, wave(0,i,0.0f), wave(0,i,1.0f), wave(0,i,2.0f)));
+				else blobList.push_back(manager->addTuioBlob(wave(0,i,0.0f), wave(0,i,1.0f), wave(0,i,2.0f), 0.05f, 0.05f, 0.0025f));
+			}
+		}
+
+		void move(long frame) {
+			for (int i=0;i<count;i++) {
+				float x = wave(frame,i,0.0f);
+				float y = wave(frame,i,1.0f);
+				float a = wave(frame,i,2.0f);
+				if (profile=='c') manager->updateTuioCursor(cursorList[i], x, y);
+				else if (profile=='o') manager->updateTuioObject(objectList[i], x, y, a);
+				else manager->updateTuioBlob(blobList[i], x, y, a, 0.05f, 0.05f, 0.0025f);
+			}
+		}
+
+	private:
+		TuioManager *manager;
+		char profile;
+		int count;
+		std::vector<TuioCursor*> cursorList;
+		std::vector<TuioObject*> objectList;
+		std::vector<TuioBlob*> blobList;
+};
+
+static void commitFrame(long n, BenchTimer &timer, char profile, bool packed, int bits) {
+
+	CaptureSender *sender = new CaptureSender(MAX_UDP_SIZE);
+	TuioServer server(sender);
+	// the packed profile is always encoded in addition to the regular profile
+	if (packed) server.addPackedOscSender(new CaptureSender(MAX_UDP_SIZE));
+	if (bits>0) server.enableQuantization(bits);
+
+	server.initFrame(frameTime(0));
+	BenchScene scene(&server, profile);
+	server.commitFrame();
+
+	timer.start();
+	for (long i=1;i<=n;i++) {
+		server.initFrame(frameTime(i));
+		scene.move(i);
+		server.commitFrame();
+	}
+	timer.stop();
+}
+
+static void commitFrameCursor(long n, BenchTimer &timer) { commitFrame(n, timer, 'c', false, 0); }
+static void commitFrameObject(long n, BenchTimer &timer) { commitFrame(n, timer, 'o', false, 0); }
+static void commitFrameBlob(long n, BenchTimer &timer) { commitFrame(n, timer, 'b', false, 0); }
+static void commitFrameCursorPacked(long n, BenchTimer &timer) { commitFrame(n, timer, 'c', true, 0); }
+static void commitFrameCursorQuantized(long n, BenchTimer &timer) { commitFrame(n, timer, 'c', false, 12); }
+
+/* moves all entities of a scene that grows during the benchmark setup */
+static void moveAll(TuioServer *server, std::vector<TuioCursor*> &cursorList, std::vector<TuioObject*> &objectList, std::vector<TuioBlob*> &blobList, long frame) {
+	for (int i=0;i<(int)cursorList.size();i++) {
+		float x = wave(frame,i,0.0f);
+		float y = wave(frame,i,1.0f);
+		float a = wave(frame,i,2.0f);
+		server->updateTuioCursor(cursorList[i], x, y);
+		server->updateTuioObject(objectList[i], x, y, a);
+		server->updateTuioBlob(blobList[i], x, y, a, 0.05f, 0.05f, 0.0025f);
+	}
+}
+
+/* commits all three profiles into packets of the Ethernet MTU, the packed profile then also has to be split into several bundles */
+static void commitFrameSplitPacked(long n, BenchTimer &timer) {
+
+	TuioServer server(new CaptureSender(BENCH_MTU_SIZE));
+	server.addPackedOscSender(new CaptureSender(BENCH_MTU_SIZE));
+	server.setSourceName("TuioBench", "255.255.255.255");
+
+	// the scene grows by one entity per frame, so that the bundles are split at every possible filling
+	std::vector<TuioCursor*> cursorList;
+	std::vector<TuioObject*> objectList;
+	std::vector<TuioBlob*> blobList;
+	for (long frame=0;frame<BENCH_ENTITIES;frame++) {
+		server.initFrame(frameTime(frame));
+		cursorList.push_back(server.addTuioCursor(0.0f, 0.0f));
+		objectList.push_back(server.addTuioObject((int)frame, 0.0f, 0.0f, 0.0f));
+		blobList.push_back(server.addTuioBlob(0.0f, 0.0f, 0.0f, 0.05f, 0.05f, 0.0025f));
+		moveAll(&server, cursorList, objectList, blobList, frame);
+		server.commitFrame();
+	}
+
+	timer.start();
+	for (long i=1;i<=n;i++) {
+		server.initFrame(frameTime(BENCH_ENTITIES+i));
+		moveAll(&server, cursorList, objectList, blobList, BENCH_ENTITIES+i);
+		server.commitFrame();
+	}
+	timer.stop();
+}
+
+/* commits a large scene of all three profiles, which are encoded sequentially or in parallel */
+static void commitFrameAll(long n, BenchTimer &timer, bool parallel) {
+
+	TuioServer server(new CaptureSender(MAX_UDP_SIZE));
+	server.enableParallelEncoding(parallel);
+
+	server.initFrame(frameTime(0));
+	BenchScene cursors(&server, 'c', BENCH_LARGE_SCENE);
+	BenchScene objects(&server, 'o', BENCH_LARGE_SCENE);
+	BenchScene blobs(&server, 'b', BENCH_LARGE_SCENE);
+	server.commitFrame();
+
+	timer.start();
+	for (long i=1;i<=n;i++) {
+		server.initFrame(frameTime(i));
+		cursors.move(i);
+		objects.move(i);
+		blobs.move(i);
+		server.commitFrame();
+	}
+	timer.stop();
+}
+
+static void commitFrameAll(long n, BenchTimer &timer) { commitFrameAll(n, timer, false); }
+static void commitFrameAllParallel(long n, BenchTimer &timer) { commitFrameAll(n, timer, true); }
+
+/* runs a tracker loop with a fixed processing time per camera frame, which commits a scene of all three profiles to a UDP receiver */
+static void trackerLoop(long n, BenchTimer &timer, bool pipelined) {
+
+	UdpReceiver receiver(BENCH_UDP_PORT, MAX_UDP_SIZE);
+	receiver.connect();
+	TuioServer server(new UdpSender("localhost", BENCH_UDP_PORT, MAX_UDP_SIZE));
+	server.enablePipelinedCommit(pipelined);
+
+	server.initFrame(frameTime(0));
+	BenchScene cursors(&server, 'c');
+	BenchScene objects(&server, 'o');
+	BenchScene blobs(&server, 'b');
+	server.commitFrame();
+	timer.samples.reserve(n);
+
+	timer.start();
+	for (long i=1;i<=n;i++) {
+		osc::int64 frame_start = TuioClock::getSystemTime();
+		server.initFrame(frameTime(i));
+		cursors.move(i);
+		objects.move(i);
+		blobs.move(i);
+
+		osc::int64 commit_start = TuioClock::getSystemTime();
+		server.commitFrame();
+		timer.sample(TuioClock::getSystemTime()-commit_start);
+
+		// the image processing of the next camera frame
+		while (TuioClock::getSystemTime()-frame_start<BENCH_TRACKER_WORK);
+	}
+	timer.stop();
+
+	server.enablePipelinedCommit(false);
+	receiver.disconnect();
+}
+
+static void trackerLoop(long n, BenchTimer &timer) { trackerLoop(n, timer, false); }
+static void trackerLoopPipelined(long n, BenchTimer &timer) { trackerLoop(n, timer, true); }
+
+static void outboundMessage(long n, BenchTimer &timer) {
+
+	char buffer[IP_MTU_SIZE];
+	osc::OutboundPacketStream stream(buffer, IP_MTU_SIZE);
+
+	timer.start();
+	for (long i=0;i<n;i++) {
+		stream.Clear();
+		stream << osc::BeginBundleImmediate;
+		stream << osc::BeginMessage("/tuio/2Dcur") << "set" << (osc::int32)i << 0.5f << 0.5f << 0.1f << 0.1f << 0.0f << osc::EndMessage;
+		stream << osc::EndBundle;
+	}
+	timer.stop();
+}
+
+/* encodes a sequence of frames once, which are then replayed in a loop */
+static void cannedFrames(char profile, std::vector<std::string> &packets) {
+
+	CaptureSender *sender = new CaptureSender(MAX_UDP_SIZE);
+	TuioServer server(sender);
+	server.initFrame(frameTime(0));
+	BenchScene scene(&server, profile);
+	server.commitFrame();
+
+	sender->capture = true;
+	for (long i=1;i<=BENCH_FRAMES;i++) {
+		server.initFrame(frameTime(i));
+		scene.move(i);
+		server.commitFrame();
+	}
+	packets = sender->packets;
+}
+
+static void processPackets(long n, BenchTimer &timer, char profile) {
+
+	std::vector<std::string> packets;
+	cannedFrames(profile, packets);
+
+	CannedReceiver receiver;
+	TuioClient client(&receiver);
+	client.connect();
+
+	IpEndpointName endpoint;
+	timer.start();
+	for (long i=0;i<n;i++) {
+		const std::string &packet = packets[i%packets.size()];
+		receiver.ProcessPacket(packet.data(), (int)packet.size(), endpoint);
+	}
+	timer.stop();
+
+	client.disconnect();
+}
+
+static void processCursorPacket(long n, BenchTimer &timer) { processPackets(n, timer, 'c'); }
+static void processObjectPacket(long n, BenchTimer &timer) { processPackets(n, timer, 'o'); }
+static void processBlobPacket(long n, BenchTimer &timer) { processPackets(n, timer, 'b'); }
+
+static void managerChurn(long n, BenchTimer &timer) {
+
+	TuioManager manager;
+	std::vector<TuioCursor*> cursorList;
+	manager.initFrame(frameTime(0));
+	for (int i=0;i<BENCH_ENTITIES;i++) cursorList.push_back(manager.addTuioCursor(wave(0,i,0.0f), wave(0,i,1.0f)));
+	manager.commitFrame();
+
+	// each frame replaces a tenth of the cursors and moves the others
+	timer.start();
+	for (long i=1;i<=n;i++) {
+		manager.initFrame(frameTime(i));
+		for (int j=0;j<BENCH_ENTITIES;j++) {
+			if ((j%10)==(i%10)) {
+				manager.removeTuioCursor(cursorList[j]);
+				cursorList[j] = manager.addTuioCursor(wave(i,j,0.0f), wave(i,j,1.0f));
+			} else manager.updateTuioCursor(cursorList[j], wave(i,j,0.0f), wave(i,j,1.0f));
+		}
+		manager.commitFrame();
+	}
+	timer.stop();
+}
+
+/* keeps replaying the canned frames into a TuioClient until it is stopped */
+struct ContentionState {
+	CannedReceiver *receiver;
+	std::vector<std::string> *packets;
+	volatile bool running;
+};
+
+#ifndef WIN32
+static void* ContentionThreadFunc( void* obj )
+#else
+static DWORD WINAPI ContentionThreadFunc( LPVOID obj )
+#endif
+{
+	ContentionState *state = static_cast<ContentionState*>(obj);
+	IpEndpointName endpoint;
+	long i = 0;
+	while (state->running) {
+		const std::string &packet = (*state->packets)[i++ % state->packets->size()];
+		state->receiver->ProcessPacket(packet.data(), (int)packet.size(), endpoint);
+	}
+	return 0;
+}
+
+static void dispatcherGetters(long n, BenchTimer &timer, bool list) {
+
+	std::vector<std::string> packets;
+	cannedFrames('c', packets);
+
+	CannedReceiver receiver;
+	TuioClient client(&receiver);
+	client.connect();
+
+	ContentionState state;
+	state.receiver = &receiver;
+	state.packets = &packets;
+	state.running = true;
+#ifndef WIN32
+	pthread_t thread;
+	pthread_create(&thread, NULL, ContentionThreadFunc, &state);
+#else
+	HANDLE thread = CreateThread( 0, 0, ContentionThreadFunc, &state, 0, NULL );
+#endif
+
+	long found = 0;
+	timer.start();
+	for (long i=0;i<n;i++) {
+		if (list) found += (long)client.getTuioCursors().size();
+		else if (client.getTuioCursor(i%BENCH_ENTITIES)!=NULL) found++;
+	}
+	timer.stop();
+
+	state.running = false;
+#ifndef WIN32
+	pthread_join(thread, NULL);
+#else
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#endif
+	client.disconnect();
+}
+
+static void dispatcherGetCursors(long n, BenchTimer &timer) { dispatcherGetters(n, timer, true); }
+static void dispatcherGetCursor(long n, BenchTimer &timer) { dispatcherGetters(n, timer, false); }
+
+static void containerUpdate(long n, BenchTimer &timer) {
+
+	TuioCursor cursor(frameTime(0), 0, 0, 0.5f, 0.5f);
+
+	timer.start();
+	for (long i=1;i<=n;i++) cursor.update(frameTime(i), wave(i,0,0.0f), wave(i,0,1.0f));
+	timer.stop();
+}
+
+/* sends single packets to a receiving thread within the same process and waits for each to arrive */
+static void delivery(long n, BenchTimer &timer, char transport) {
+
+	std::vector<std::string> packets;
+	cannedFrames('c', packets);
+
+	OscSender *sender;
+	OscReceiver *receiver;
+	if (transport=='s') {
+		sender = new ShmSender(BENCH_SHM_NAME);
+		receiver = new ShmReceiver(BENCH_SHM_NAME);
+	} else if (transport=='u') {
+		receiver = new UnixReceiver(BENCH_UNIX_PATH);
+		sender = new UnixSender(BENCH_UNIX_PATH);
+	} else if (transport=='q') {
+		receiver = new UnixReceiver(BENCH_UNIX_PATH, true);
+		sender = new UnixSender(BENCH_UNIX_PATH, true);
+	} else if (transport=='t') {
+		sender = new TcpSender(BENCH_TCP_PORT);
+		receiver = new TcpReceiver("127.0.0.1", BENCH_TCP_PORT);
+	} else if ((transport=='w') || (transport=='z')) {
+		WebSockSender *websock = new WebSockSender(BENCH_WEB_PORT);
+		if (transport=='z') websock->setDeflate(true);
+		sender = websock;
+		receiver = new WebSockReceiver("127.0.0.1", BENCH_WEB_PORT, "/", transport=='z');
+	} else {
+		sender = new UdpSender("localhost", BENCH_UDP_PORT, MAX_UDP_SIZE);
+		receiver = new UdpReceiver(BENCH_UDP_PORT, MAX_UDP_SIZE);
+	}
+
+	DeliveryTap tap;
+	receiver->addPacketTap(&tap);
+	receiver->connect();
+
+	// the receiver only gets the packets that are sent after it attached
+	while (tap.packets==0) {
+		sender->sendOscData(packets[0].data(), (unsigned int)packets[0].size());
+#ifdef WIN32
+		Sleep(10);
+#else
+		usleep(10000);
+#endif
+	}
+
+	long count = tap.packets;
+	timer.start();
+	for (long i=0;i<n;i++) {
+		const std::string &packet = packets[i%packets.size()];
+		sender->sendOscData(packet.data(), (unsigned int)packet.size());
+		tap.waitFor(++count);
+	}
+	timer.stop();
+
+	receiver->disconnect();
+	delete receiver;
+	delete sender;
+}
+
+static void deliveryShm(long n, BenchTimer &timer) { delivery(n, timer, 's'); }
+static void deliveryUnix(long n, BenchTimer &timer) { delivery(n, timer, 'u'); }
+static void deliveryUnixSeqPacket(long n, BenchTimer &timer) { delivery(n, timer, 'q'); }
+static void deliveryUdp(long n, BenchTimer &timer) { delivery(n, timer, 'd'); }
+static void deliveryTcp(long n, BenchTimer &timer) { delivery(n, timer, 't'); }
+static void deliveryWebSock(long n, BenchTimer &timer) { delivery(n, timer, 'w'); }
+static void deliveryWebSockDeflate(long n, BenchTimer &timer) { delivery(n, timer, 'z'); }
+
+/* takes snapshots of a published scene with all three profiles */
+static void sceneSnapshot(long n, BenchTimer &timer) {
+
+	TuioServer server(new CaptureSender(MAX_UDP_SIZE));
+	server.setScenePublisher(new TuioScenePublisher(NULL, BENCH_SCENE_NAME));
+
+	server.initFrame(frameTime(0));
+	BenchScene cursors(&server, 'c');
+	BenchScene objects(&server, 'o');
+	BenchScene blobs(&server, 'b');
+	server.commitFrame();
+
+	TuioSceneReader reader(BENCH_SCENE_NAME);
+	reader.update();
+
+	timer.start();
+	for (long i=0;i<n;i++) reader.update();
+	timer.stop();
+}
+
+static Benchmark _benchmarks[] = {
+	{ "CommitFrameCursor", commitFrameCursor, false },
+	{ "CommitFrameObject", commitFrameObject, false },
+	{ "CommitFrameBlob", commitFrameBlob, false },
+	{ "CommitFrameCursorPacked", commitFrameCursorPacked, false },
+	{ "CommitFrameCursorQuantized", commitFrameCursorQuantized, false },
+	{ "CommitFrameSplitPacked", commitFrameSplitPacked, false },
+	{ "CommitFrameAll", commitFrameAll, false },
+	{ "CommitFrameAllParallel", commitFrameAllParallel, false },
+	{ "TrackerLoop", trackerLoop, true },
+	{ "TrackerLoopPipelined", trackerLoopPipelined, true },
+	{ "OutboundMessage", outboundMessage, false },
+	{ "ProcessCursorPacket", processCursorPacket, false },
+	{ "ProcessObjectPacket", processObjectPacket, false },
+	{ "ProcessBlobPacket", processBlobPacket, false },
+	{ "ManagerChurn", managerChurn, false },
+	{ "DispatcherGetCursors", dispatcherGetCursors, false },
+	{ "DispatcherGetCursor", dispatcherGetCursor, false },
+	{ "ContainerUpdate", containerUpdate, false },
+	{ "DeliveryShm", deliveryShm, true },
+	{ "DeliveryUnix", deliveryUnix, true },
+	{ "DeliveryUnixSeqPacket", deliveryUnixSeqPacket, true },
+	{ "DeliveryUdp", deliveryUdp, true },
+	{ "DeliveryTcp", deliveryTcp, true },
+	{ "DeliveryWebSock", deliveryWebSock, true },
+	{ "DeliveryWebSockDeflate", deliveryWebSockDeflate, true },
+	{ "SceneSnapshot", sceneSnapshot, false },
+	{ NULL, NULL, false }
+};
+
+static void runBenchmark(Benchmark &benchmark) {
+
+	// the iteration count grows until a single run takes the configured time
+	osc::int64 target = (osc::int64)(_benchtime*1000000000.0);
+	long n = 1;
+	BenchTimer timer;
+	for (;;) {
+		timer = BenchTimer();
+		benchmark.function(n, timer);
+		if ((timer.elapsed>=target) || (n>=1000000000L)) break;
+
+		double next = (timer.elapsed>0) ? (double)n*target/timer.elapsed*1.2 : (double)n*10.0;
+		if (next>(double)n*10.0) next = (double)n*10.0;
+		if (next<(double)n*2.0) next = (double)n*2.0;
+		n = (long)next;
+	}
+
+	// the output follows the Go benchmark format
+	printf("Benchmark%s\t%10ld\t%12.1f ns/op\t%12.1f cpu-ns/op\t%8.2f allocs/op", benchmark.name, n, (double)timer.elapsed/n, (double)timer.cpu/n, (double)timer.allocs/n);
+
+	// the sampled calls are reported as additional metrics
+	if (!timer.samples.empty()) {
+		std::vector<osc::int64> &samples = timer.samples;
+		std::sort(samples.begin(), samples.end());
+		printf("\t%12.1f p50-ns/call\t%12.1f p99-ns/call\t%12.1f max-ns/call", (double)samples[samples.size()/2], (double)samples[samples.size()*99/100], (double)samples.back());
+	}
+	printf("\n");
+	fflush(stdout);
+}
+
+static void show_help() {
+	std::cout << "Usage: TuioBench -b [name] -t [seconds] -n -l" << std::endl;
+	std::cout << "        -b [name] only run the benchmarks containing this name" << std::endl;
+	std::cout << "        -n also run the transport benchmarks, which open local sockets and shared memory" << std::endl;
+	std::cout << "        -t [seconds] minimum duration of each benchmark (default is 1)" << std::endl;
+	std::cout << "        -l list the benchmarks" << std::endl;
+	std::cout << "        -h show this help" << std::endl;
+}
+
+static void init(int argc, char** argv) {
+	char c;
+
+#ifndef WIN32
+	while ((c = getopt(argc, argv, "b:t:nlh")) != -1) {
+		switch (c) {
+			case 'b':
+				_filter = std::string(optarg);
+				break;
+			case 't':
+				_benchtime = atof(optarg);
+				break;
+			case 'n':
+				_transport = true;
+				break;
+			case 'l':
+				for (int i=0;_benchmarks[i].name!=NULL;i++) std::cout << "Benchmark" << _benchmarks[i].name << std::endl;
+				exit(0);
+			case 'h':
+				show_help();
+				exit(0);
+			default:
+				show_help();
+				exit(1);
+		}
+	}
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+	init(argc, argv);
+
+	// the transports report their state on the console, which would interleave with the results
+	std::cout.rdbuf(NULL);
+
+	// a benchmark that throws, such as an encoder exceeding its packet size, fails the whole run
+	int result = 0;
+	for (int i=0;_benchmarks[i].name!=NULL;i++) {
+		if ((_filter!="") && (strstr(_benchmarks[i].name, _filter.c_str())==NULL)) continue;
+		if (_benchmarks[i].transport && !_transport) continue;
+		try {
+			runBenchmark(_benchmarks[i]);
+		} catch (std::exception &e) {
+			printf("--- FAIL: Benchmark%s\n\t%s\n", _benchmarks[i].name, e.what());
+			fflush(stdout);
+			result = 1;
+		}
+	}
+	return result;
+}
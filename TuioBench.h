@@ -0,0 +1,123 @@
+/*
+	TUIO C++ Example - part of the reacTIVision project
+	http://reactivision.sourceforge.net/
+
+	Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef INCLUDED_TUIOBENCH_H
+#define INCLUDED_TUIOBENCH_H
+
+#include "TuioServer.h"
+#include "TuioClient.h"
+#include "OscReceiver.h"
+#include "TuioClock.h"
+#include <string>
+#include <vector>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+using namespace TUIO;
+
+/* keeps a copy of the encoded bundles if capturing, otherwise only counts them */
+class CaptureSender : public OscSender {
+
+	public:
+		CaptureSender(int size);
+
+		bool sendOscPacket (osc::OutboundPacketStream *bundle);
+		bool isConnected () { return true; }
+		const char* tuio_type() { return "TUIO/NULL"; }
+
+		bool capture;
+		long bytes;
+		std::vector<std::string> packets;
+};
+
+/* delivers the canned packets directly to the attached TuioClient */
+class CannedReceiver : public OscReceiver {
+
+	public:
+		void connect(bool lock=false) { connected = true; }
+		void disconnect() { connected = false; }
+};
+
+/* counts the packets that arrived at a receiver and lets the sender wait for them */
+class DeliveryTap : public PacketListener {
+
+	public:
+		DeliveryTap();
+		~DeliveryTap();
+
+		void ProcessPacket( const char *data, int size, const IpEndpointName &remoteEndpoint );
+		void waitFor(long count);
+
+		volatile long packets;
+
+	private:
+#ifdef WIN32
+		HANDLE deliveryEvent;
+#else
+		pthread_mutex_t deliveryMutex;
+		pthread_cond_t deliveryCond;
+#endif
+};
+
+/* measures the time, the process CPU time and the heap allocations of the timed section of a benchmark,
+   as well as the optional durations of single calls within this section */
+class BenchTimer {
+
+	public:
+		BenchTimer() : elapsed(0), cpu(0), allocs(0), start_time(0), start_cpu(0), start_allocs(0) {}
+
+		void start();
+		void stop();
+		void sample(osc::int64 duration) { samples.push_back(duration); }
+
+		osc::int64 elapsed;
+		osc::int64 cpu;
+		long allocs;
+		std::vector<osc::int64> samples;
+
+	private:
+		osc::int64 start_time;
+		osc::int64 start_cpu;
+		long start_allocs;
+};
+
+typedef void (*BenchFunction)(long iterations, BenchTimer &timer);
+
+struct Benchmark {
+	const char *name;
+	BenchFunction function;
+	bool transport;
+};
+
+#endif /* INCLUDED_TUIOBENCH_H */
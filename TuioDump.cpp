@@ -33,8 +33,27 @@
 static std::string _address("localhost");
 static bool _udp = true;
 static int _port = 3333;
+static int _sockets = 1;
+static int _latency = 0;
+static bool _clock_sync = false;
+static int _jitter = 0;
+static std::string _replay("");
+static std::string _shm("");
+static std::string _scene("");
+static std::string _unix("");
+static int _websocket = 0;
+static bool _deflate = false;
+static std::string _group("");
+static std::string _interface("");
 
 
+TuioDump::TuioDump()
+: latency_client	(NULL)
+, latency_interval	(0)
+, latency_report	(0)
+{
+}
+
 void TuioDump::addTuioObject(TuioObject *tobj) {
 	std::cout << "add obj " << tobj->getSymbolID() << " (" << tobj->getSessionID() << "/"<<  tobj->getTuioSourceID() << ") "<< tobj->getX() << " " << tobj->getY() << " " << tobj->getAngle() << std::endl;
 }
@@ -76,15 +95,64 @@ void TuioDump::removeTuioBlob(TuioBlob *tblb) {
 
 void  TuioDump::refresh(TuioTime frameTime) {
 	//std::cout << "refresh " << frameTime.getTotalMilliseconds() << std::endl;
+
+	if (latency_client==NULL) return;
+	if (latency_report==0) latency_report = frameTime.getTotalMilliseconds() + latency_interval;
+	if (frameTime.getTotalMilliseconds()<latency_report) return;
+	latency_report = frameTime.getTotalMilliseconds() + latency_interval;
+
+	printLatency("receive", latency_client->getLatencyHistogram(TUIO_LATENCY_RECEIVE));
+	printLatency("decode", latency_client->getLatencyHistogram(TUIO_LATENCY_DECODE));
+	printLatency("dispatch", latency_client->getLatencyHistogram(TUIO_LATENCY_DISPATCH));
+	JitterBuffer *jitter = latency_client->getJitterBuffer();
+	if (jitter!=NULL) {
+		std::cout << "jitter depth " << jitter->getDepth() << " delay " << jitter->getDelay()/1000.0
+			<< " late " << jitter->getLateCount() << " dropped " << jitter->getDroppedCount() << " duplicate " << jitter->getDuplicateCount() << std::endl;
+	}
+	if (latency_client->hasClockOffset()) {
+		printLatency("frame", latency_client->getLatencyHistogram(TUIO_LATENCY_FRAME));
+		std::cout << "clock offset " << latency_client->getClockOffset()/1000.0 << " delay " << latency_client->getRoundTripDelay()/1000.0 << std::endl;
+	}
+}
+
+void TuioDump::setLatencyReport(TuioClient *client, int seconds) {
+	latency_client = client;
+	latency_interval = seconds*1000;
+	latency_report = 0;
+	client->enableLatencyStatistics(true);
+}
+
+void TuioDump::printLatency(const char *stage, LatencyHistogram *histogram) {
+	// all latencies are reported in microseconds
+	std::cout << "latency " << stage << " count " << histogram->getCount()
+		<< " min " << histogram->getMin()/1000.0
+		<< " p50 " << histogram->getPercentile(50.0)/1000.0
+		<< " p90 " << histogram->getPercentile(90.0)/1000.0
+		<< " p99 " << histogram->getPercentile(99.0)/1000.0
+		<< " p99.9 " << histogram->getPercentile(99.9)/1000.0
+		<< " max " << histogram->getMax()/1000.0
+		<< " mean " << histogram->getMean()/1000.0 << std::endl;
 }
 
 
 static void show_help() {
-	std::cout << "Usage: TuioDump -p [port] -t -a [address]" << std::endl;
+	std::cout << "Usage: TuioDump -p [port] -t -a [address] -r [sockets] -g [group] -i [address] -l [seconds] -c -j [ms] -f [file] -M [name] -u [path] -w [port] -z -S [name]" << std::endl;
 	std::cout << "        -p [port] for alternative port number" << std::endl;
-	std::cout << "        -t for TUIO/TCP (dedault is TUIO/UDP)" << std::endl;
+	std::cout << "        -t for TUIO/TCP (dedault is TUIO/UDP), or a sequenced packet socket with -u" << std::endl;
 	std::cout << "        -a [address] for remote TUIO/TCP server" << std::endl;
 	std::cout << "           use 'incoming' for TUIO/TCP socket" << std::endl;
+	std::cout << "        -r [sockets] for parallel TUIO/UDP receive sockets (Linux)" << std::endl;
+	std::cout << "        -g [group] join a TUIO/UDP multicast group" << std::endl;
+	std::cout << "        -i [address] local address of the multicast interface" << std::endl;
+	std::cout << "        -l [seconds] report the frame latency statistics periodically" << std::endl;
+	std::cout << "        -c synchronize with the clock of the TUIO source" << std::endl;
+	std::cout << "        -j [ms] reorder the frames in a jitter buffer with a maximum delay" << std::endl;
+	std::cout << "        -f [file] replay a TuioRecord session instead of receiving" << std::endl;
+	std::cout << "        -M [name] for TUIO/SHM from a shared-memory segment such as /tuio" << std::endl;
+	std::cout << "        -u [path] for TUIO/UNIX from a local socket path such as /tmp/tuio.sock" << std::endl;
+	std::cout << "        -w [port] for TUIO/WEB from the WebSocket server at -a [address] (default is localhost)" << std::endl;
+	std::cout << "        -z request permessage-deflate compression from the TUIO/WEB server" << std::endl;
+	std::cout << "        -S [name] re-publish the scene state to a shared-memory segment such as /tuio_scene" << std::endl;
 	std::cout << "        -h show this help" << std::endl;
 }
 
@@ -92,7 +160,7 @@ static void init(int argc, char** argv) {
 	char c;
 	
 #ifndef WIN32
-	while ((c = getopt(argc, argv, "p:a:th")) != -1) {
+	while ((c = getopt(argc, argv, "p:a:r:g:i:l:j:f:M:S:u:w:czth")) != -1) {
 		switch (c) {
 			case 't':
 				_udp = false;
@@ -103,6 +171,42 @@ static void init(int argc, char** argv) {
 			case 'p':
 				_port = atoi(optarg);
 				break;
+			case 'r':
+				_sockets = atoi(optarg);
+				break;
+			case 'l':
+				_latency = atoi(optarg);
+				break;
+			case 'c':
+				_clock_sync = true;
+				break;
+			case 'j':
+				_jitter = atoi(optarg);
+				break;
+			case 'f':
+				_replay = std::string(optarg);
+				break;
+			case 'M':
+				_shm = std::string(optarg);
+				break;
+			case 'S':
+				_scene = std::string(optarg);
+				break;
+			case 'u':
+				_unix = std::string(optarg);
+				break;
+			case 'w':
+				_websocket = atoi(optarg);
+				break;
+			case 'z':
+				_deflate = true;
+				break;
+			case 'g':
+				_group = std::string(optarg);
+				break;
+			case 'i':
+				_interface = std::string(optarg);
+				break;
 			case 'h':
 				show_help();
 				exit(0);
@@ -119,7 +223,12 @@ int main(int argc, char* argv[])
 	init(argc, argv);
 	
 	OscReceiver *osc_receiver;
-	if (_udp) osc_receiver = new UdpReceiver(_port);
+	if (_replay!="") osc_receiver = new TuioPlayer(_replay.c_str());
+	else if (_shm!="") osc_receiver = new ShmReceiver(_shm.c_str());
+	else if (_unix!="") osc_receiver = new UnixReceiver(_unix.c_str(), !_udp);
+	else if (_websocket>0) osc_receiver = new WebSockReceiver(_address.c_str(), _websocket, "/", _deflate);
+	else if (_udp && (_group!="")) osc_receiver = new UdpReceiver(_group.c_str(), _port, MAX_UDP_SIZE, (_interface!="") ? _interface.c_str() : NULL);
+	else if (_udp) osc_receiver = new UdpReceiver(_port,MAX_UDP_SIZE,_sockets);
 	else {
 		if (_address=="incoming") osc_receiver = new TcpReceiver(_port);
 		else osc_receiver = new TcpReceiver(_address.c_str(), _port);
@@ -127,8 +236,21 @@ int main(int argc, char* argv[])
 	TuioDump dump;
 	TuioClient client(osc_receiver);
 	client.addTuioListener(&dump);
+	TuioScenePublisher *publisher = NULL;
+	if (_scene!="") {
+		try { publisher = new TuioScenePublisher(&client, _scene.c_str()); }
+		catch (std::exception &e) { publisher = NULL; }
+		if (publisher) client.addTuioListener(publisher);
+	}
+	if (_latency>0) dump.setLatencyReport(&client, _latency);
+	if (_clock_sync) client.enableClockSync(true);
+	if (_jitter>0) client.enableJitterBuffer(true, _jitter);
 	client.connect(true);
 
+	if (publisher) {
+		client.removeTuioListener(publisher);
+		delete publisher;
+	}
 	delete osc_receiver;
 	return 0;
 }
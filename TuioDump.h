@@ -34,6 +34,11 @@
 #include "TuioClient.h"
 #include "UdpReceiver.h"
 #include "TcpReceiver.h"
+#include "TuioPlayer.h"
+#include "ShmReceiver.h"
+#include "UnixReceiver.h"
+#include "WebSockReceiver.h"
+#include "TuioScenePublisher.h"
 #include <math.h>
 
 using namespace TUIO;
@@ -41,6 +46,8 @@ using namespace TUIO;
 class TuioDump : public TuioListener {
 	
 	public:
+		TuioDump();
+
 		void addTuioObject(TuioObject *tobj);
 		void updateTuioObject(TuioObject *tobj);
 		void removeTuioObject(TuioObject *tobj);
@@ -54,6 +61,15 @@ class TuioDump : public TuioListener {
 		void removeTuioBlob(TuioBlob *tblb);
 
 		void refresh(TuioTime frameTime);
+
+		void setLatencyReport(TuioClient *client, int seconds);
+
+	private:
+		void printLatency(const char *stage, LatencyHistogram *histogram);
+
+		TuioClient *latency_client;
+		long latency_interval;
+		long latency_report;
 };
 
 #endif /* INCLUDED_TUIODUMP_H */
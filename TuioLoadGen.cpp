@@ -0,0 +1,523 @@
+/*
+	TUIO C++ Example - part of the reacTIVision project
+	http://reactivision.sourceforge.net/
+
+	Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "TuioLoadGen.h"
+#include "UdpSender.h"
+#include "TcpSender.h"
+#include "WebSockSender.h"
+#include "ShmSender.h"
+#include "UnixSender.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <csignal>
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+#define LOAD_PI 3.14159265f
+#define LOAD_SPEED 0.5f
+#define LOAD_SIZE 0.05f
+
+static std::string _address("localhost");
+static int _port = 3333;
+static int _size = MAX_UDP_SIZE;
+static int _tcp = 0;
+static int _websocket = 0;
+static bool _deflate = false;
+static std::string _shm("");
+static std::string _scene("");
+static std::string _unix("");
+static std::string _interface("");
+static bool _network = true;
+static int _cursors = 100;
+static int _objects = 0;
+static int _blobs = 0;
+static int _rate = 60;
+static int _cursor_interval = 0;
+static int _object_interval = 0;
+static int _blob_interval = 0;
+static int _motion = LOAD_WALK;
+static float _churn = 0.0f;
+static float _duration = 10.0f;
+static float _interval = 1.0f;
+static unsigned int _seed = 1;
+
+static TuioLoadGen *_loadgen = NULL;
+
+LoadSender::LoadSender(OscSender *sender, int size)
+	:bytes		(0)
+	,packets	(0)
+	,send_time	(0)
+	,sender		(sender)
+{
+	buffer_size = (sender!=NULL) ? sender->getBufferSize() : size;
+	local = (sender!=NULL) ? sender->isLocal() : true;
+}
+
+LoadSender::~LoadSender() {
+	delete sender;
+}
+
+bool LoadSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
+	bytes += bundle->Size();
+	packets++;
+	if (sender==NULL) return true;
+
+	osc::int64 start = TuioClock::getSystemTime();
+	bool sent = sender->sendOscPacket(bundle);
+	send_time += TuioClock::getSystemTime() - start;
+	return sent;
+}
+
+TuioLoadGen::TuioLoadGen(TuioServer *server, unsigned int seed)
+	:server		(server)
+	,motion		(LOAD_WALK)
+	,churn		(0.0f)
+	,symbol		(0)
+	,running	(false)
+{
+	random_state = (osc::uint64)seed*2654435761ULL + 1;
+}
+
+TuioLoadGen::~TuioLoadGen() {
+}
+
+double TuioLoadGen::random() {
+	// xorshift64*, which gives the same scene for a seed on every platform
+	random_state ^= random_state >> 12;
+	random_state ^= random_state << 25;
+	random_state ^= random_state >> 27;
+	return (double)((random_state * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
+
+void TuioLoadGen::addEntities(char profile, int count) {
+	for (int i=0;i<count;i++) {
+		LoadEntity entity;
+		entity.profile = profile;
+		entity.tcur = NULL;
+		entity.tobj = NULL;
+		entity.tblb = NULL;
+		entityList.push_back(entity);
+	}
+}
+
+void TuioLoadGen::spawn(LoadEntity &entity) {
+
+	entity.model = (motion==LOAD_MIXED) ? (int)(random()*3.0) : motion;
+	float direction = (float)random()*2.0f*LOAD_PI;
+	entity.vx = LOAD_SPEED*cosf(direction);
+	entity.vy = LOAD_SPEED*sinf(direction);
+	entity.va = ((float)random()-0.5f)*2.0f*LOAD_PI;
+	entity.angle = (float)random()*2.0f*LOAD_PI;
+
+	switch (entity.model) {
+		case LOAD_SWIPE:
+			// swipes enter at one edge and leave at the opposite edge
+			if (fabsf(entity.vx)>fabsf(entity.vy)) {
+				entity.x = (entity.vx>0.0f) ? 0.0f : 1.0f;
+				entity.y = (float)random();
+			} else {
+				entity.x = (float)random();
+				entity.y = (entity.vy>0.0f) ? 0.0f : 1.0f;
+			}
+			break;
+		case LOAD_ROTATE:
+			entity.radius = 0.05f + (float)random()*0.2f;
+			entity.cx = entity.radius + (float)random()*(1.0f-2.0f*entity.radius);
+			entity.cy = entity.radius + (float)random()*(1.0f-2.0f*entity.radius);
+			entity.x = entity.cx + entity.radius*cosf(entity.angle);
+			entity.y = entity.cy + entity.radius*sinf(entity.angle);
+			break;
+		default:
+			entity.x = (float)random();
+			entity.y = (float)random();
+	}
+
+	switch (entity.profile) {
+		case 'c':
+			entity.tcur = server->addTuioCursor(entity.x, entity.y);
+			break;
+		case 'o':
+			entity.tobj = server->addTuioObject(symbol++, entity.x, entity.y, entity.angle);
+			break;
+		case 'b':
+			entity.tblb = server->addTuioBlob(entity.x, entity.y, entity.angle, LOAD_SIZE, LOAD_SIZE, LOAD_SIZE*LOAD_SIZE);
+			break;
+	}
+}
+
+void TuioLoadGen::release(LoadEntity &entity) {
+	if (entity.tcur!=NULL) server->removeTuioCursor(entity.tcur);
+	if (entity.tobj!=NULL) server->removeTuioObject(entity.tobj);
+	if (entity.tblb!=NULL) server->removeTuioBlob(entity.tblb);
+	entity.tcur = NULL;
+	entity.tobj = NULL;
+	entity.tblb = NULL;
+}
+
+void TuioLoadGen::move(LoadEntity &entity, float dt) {
+
+	switch (entity.model) {
+		case LOAD_WALK:
+			entity.vx += ((float)random()-0.5f)*4.0f*dt;
+			entity.vy += ((float)random()-0.5f)*4.0f*dt;
+			entity.x += entity.vx*dt;
+			entity.y += entity.vy*dt;
+			if ((entity.x<0.0f) || (entity.x>1.0f)) { entity.vx = -entity.vx; entity.x += 2.0f*entity.vx*dt; }
+			if ((entity.y<0.0f) || (entity.y>1.0f)) { entity.vy = -entity.vy; entity.y += 2.0f*entity.vy*dt; }
+			entity.angle += entity.va*dt;
+			break;
+		case LOAD_SWIPE:
+			entity.x += entity.vx*dt;
+			entity.y += entity.vy*dt;
+			if ((entity.x<0.0f) || (entity.x>1.0f) || (entity.y<0.0f) || (entity.y>1.0f)) {
+				release(entity);
+				spawn(entity);
+				return;
+			}
+			break;
+		case LOAD_ROTATE:
+			entity.angle += entity.va*dt;
+			entity.x = entity.cx + entity.radius*cosf(entity.angle);
+			entity.y = entity.cy + entity.radius*sinf(entity.angle);
+			break;
+	}
+
+	entity.angle = fmodf(entity.angle, 2.0f*LOAD_PI);
+	if (entity.angle<0.0f) entity.angle += 2.0f*LOAD_PI;
+
+	if (entity.tcur!=NULL) server->updateTuioCursor(entity.tcur, entity.x, entity.y);
+	if (entity.tobj!=NULL) server->updateTuioObject(entity.tobj, entity.x, entity.y, entity.angle);
+	if (entity.tblb!=NULL) server->updateTuioBlob(entity.tblb, entity.x, entity.y, entity.angle, LOAD_SIZE, LOAD_SIZE, LOAD_SIZE*LOAD_SIZE);
+}
+
+void TuioLoadGen::report(const char *label, long frames, osc::int64 period, osc::int64 encode_time, osc::int64 frame_time) {
+
+	// all senders deliver the same bundles, therefore the first one represents the encoded stream
+	if ((frames<=0) || senderList.empty()) return;
+	long bytes = senderList[0]->bytes;
+	long packets = senderList[0]->packets;
+
+	std::cout << std::fixed << std::setprecision(1) << label
+		<< " fps " << frames/(period/1000000000.0)
+		<< " encode " << encode_time/1000.0/frames << "us"
+		<< " frame " << frame_time/1000.0/frames << "us"
+		<< " bytes " << bytes/frames
+		<< " packets " << (double)packets/frames << std::endl;
+}
+
+void TuioLoadGen::run(int frame_rate, float duration, float report_interval) {
+
+	if (frame_rate<1) frame_rate = 1;
+	osc::int64 period = 1000000000LL/frame_rate;
+	float dt = 1.0f/frame_rate;
+	float churn_count = 0.0f;
+
+	server->initFrame(TuioTime::getSessionTime());
+	for (unsigned int i=0;i<entityList.size();i++) spawn(entityList[i]);
+	server->commitFrame();
+
+	osc::int64 start = TuioClock::getSystemTime();
+	osc::int64 end = start + (osc::int64)(duration*1000000000.0);
+	osc::int64 next_report = start + (osc::int64)(report_interval*1000000000.0);
+	osc::int64 report_start = start;
+	osc::int64 encode_time = 0, frame_time = 0, total_encode = 0, total_frame = 0;
+	long frames = 0, total_frames = 0;
+
+	for (unsigned int i=0;i<senderList.size();i++) {
+		senderList[i]->bytes = 0;
+		senderList[i]->packets = 0;
+		senderList[i]->send_time = 0;
+	}
+
+	running = true;
+	osc::int64 due = start;
+	while (running) {
+
+		osc::int64 frame_start = TuioClock::getSystemTime();
+		server->initFrame(TuioTime::getSessionTime());
+		for (unsigned int i=0;i<entityList.size();i++) move(entityList[i], dt);
+
+		// the churn replaces randomly chosen entities with new sessions
+		churn_count += churn*dt;
+		while ((churn_count>=1.0f) && !entityList.empty()) {
+			LoadEntity &entity = entityList[(int)(random()*entityList.size())];
+			release(entity);
+			spawn(entity);
+			churn_count -= 1.0f;
+		}
+
+		osc::int64 send_start = 0;
+		for (unsigned int i=0;i<senderList.size();i++) send_start += senderList[i]->send_time;
+		osc::int64 commit_start = TuioClock::getSystemTime();
+		server->commitFrame();
+		osc::int64 now = TuioClock::getSystemTime();
+		osc::int64 send_time = -send_start;
+		for (unsigned int i=0;i<senderList.size();i++) send_time += senderList[i]->send_time;
+
+		encode_time += (now-commit_start) - send_time;
+		frame_time += now-frame_start;
+		frames++;
+
+		if ((now>=next_report) || (now>=end)) {
+			report("frames", frames, now-report_start, encode_time, frame_time);
+			total_frames += frames;
+			total_encode += encode_time;
+			total_frame += frame_time;
+			for (unsigned int i=0;i<senderList.size();i++) {
+				senderList[i]->bytes = 0;
+				senderList[i]->packets = 0;
+			}
+			frames = 0;
+			encode_time = frame_time = 0;
+			report_start = now;
+			next_report = now + (osc::int64)(report_interval*1000000000.0);
+		}
+		if ((duration>0.0f) && (now>=end)) break;
+
+		// frames are scheduled on a fixed grid, late frames are sent immediately
+		due += period;
+		if (due<now) due = now;
+		osc::int64 wait = due - TuioClock::getSystemTime();
+		if (wait>0) {
+#ifdef WIN32
+			Sleep((DWORD)(wait/1000000));
+#else
+			usleep((useconds_t)(wait/1000));
+#endif
+		}
+	}
+
+	osc::int64 total_time = TuioClock::getSystemTime()-start;
+	if (total_frames>0) std::cout << std::fixed << std::setprecision(1) << "total fps " << total_frames/(total_time/1000000000.0)
+		<< " encode " << total_encode/1000.0/total_frames << "us"
+		<< " frame " << total_frame/1000.0/total_frames << "us"
+		<< " entities " << entityList.size() << std::endl;
+
+	server->initFrame(TuioTime::getSessionTime());
+	for (unsigned int i=0;i<entityList.size();i++) release(entityList[i]);
+	server->commitFrame();
+}
+
+static void stop(int signal) {
+	if (_loadgen!=NULL) _loadgen->stop();
+}
+
+static void show_help() {
+	std::cout << "Usage: TuioLoadGen -c [count] -o [count] -b [count] -r [Hz] -C [ms] -O [ms] -B [ms] -m [model] -x [rate] -d [seconds] -i [seconds] -a [address] -I [address] -p [port] -l [bytes] -t [port] -w [port] -z -M [name] -u [path] -S [name] -n -s [seed]" << std::endl;
+	std::cout << "        -c [count] synthetic cursors (default is 100)" << std::endl;
+	std::cout << "        -o [count] synthetic objects" << std::endl;
+	std::cout << "        -b [count] synthetic blobs" << std::endl;
+	std::cout << "        -r [Hz] frame rate up to 1000 (default is 60)" << std::endl;
+	std::cout << "        -C [ms] minimum interval between two cursor bundles" << std::endl;
+	std::cout << "        -O [ms] minimum interval between two object bundles" << std::endl;
+	std::cout << "        -B [ms] minimum interval between two blob bundles" << std::endl;
+	std::cout << "        -m [model] motion model: walk, swipe, rotate or mixed" << std::endl;
+	std::cout << "        -x [rate] entities removed and added again per second" << std::endl;
+	std::cout << "        -d [seconds] duration, 0 runs until interrupted (default is 10)" << std::endl;
+	std::cout << "        -i [seconds] report interval (default is 1)" << std::endl;
+	std::cout << "        -a [address] TUIO/UDP target address or multicast group (default is localhost)" << std::endl;
+	std::cout << "        -I [address] local address of the multicast interface" << std::endl;
+	std::cout << "        -p [port] TUIO/UDP target port (default is 3333)" << std::endl;
+	std::cout << "        -l [bytes] TUIO/UDP packet size, up to 65507 for large scenes on loopback" << std::endl;
+	std::cout << "        -t [port] additional TUIO/TCP socket" << std::endl;
+	std::cout << "        -w [port] additional TUIO/WEB socket" << std::endl;
+	std::cout << "        -z offer permessage-deflate compression to TUIO/WEB clients" << std::endl;
+	std::cout << "        -M [name] additional TUIO/SHM shared-memory segment" << std::endl;
+	std::cout << "        -u [path] additional TUIO/UNIX datagram socket" << std::endl;
+	std::cout << "        -S [name] publish the scene state to a shared-memory segment" << std::endl;
+	std::cout << "        -n encode without sending to measure the encoder alone" << std::endl;
+	std::cout << "        -s [seed] random seed (default is 1)" << std::endl;
+	std::cout << "        -h show this help" << std::endl;
+}
+
+static void init(int argc, char** argv) {
+	char c;
+
+#ifndef WIN32
+	while ((c = getopt(argc, argv, "c:o:b:r:C:O:B:m:x:d:i:a:I:p:l:t:w:M:S:u:s:nzh")) != -1) {
+		switch (c) {
+			case 'c':
+				_cursors = atoi(optarg);
+				break;
+			case 'o':
+				_objects = atoi(optarg);
+				break;
+			case 'b':
+				_blobs = atoi(optarg);
+				break;
+			case 'r':
+				_rate = atoi(optarg);
+				if (_rate>1000) _rate = 1000;
+				break;
+			case 'C':
+				_cursor_interval = atoi(optarg);
+				break;
+			case 'O':
+				_object_interval = atoi(optarg);
+				break;
+			case 'B':
+				_blob_interval = atoi(optarg);
+				break;
+			case 'm':
+				if (strcmp(optarg,"swipe")==0) _motion = LOAD_SWIPE;
+				else if (strcmp(optarg,"rotate")==0) _motion = LOAD_ROTATE;
+				else if (strcmp(optarg,"mixed")==0) _motion = LOAD_MIXED;
+				else _motion = LOAD_WALK;
+				break;
+			case 'x':
+				_churn = (float)atof(optarg);
+				break;
+			case 'd':
+				_duration = (float)atof(optarg);
+				break;
+			case 'i':
+				_interval = (float)atof(optarg);
+				break;
+			case 'a':
+				_address = std::string(optarg);
+				break;
+			case 'p':
+				_port = atoi(optarg);
+				break;
+			case 'l':
+				_size = atoi(optarg);
+				break;
+			case 't':
+				_tcp = atoi(optarg);
+				break;
+			case 'w':
+				_websocket = atoi(optarg);
+				break;
+			case 'M':
+				_shm = std::string(optarg);
+				break;
+			case 'S':
+				_scene = std::string(optarg);
+				break;
+			case 'u':
+				_unix = std::string(optarg);
+				break;
+			case 'I':
+				_interface = std::string(optarg);
+				break;
+			case 'n':
+				_network = false;
+				break;
+			case 'z':
+				_deflate = true;
+				break;
+			case 's':
+				_seed = (unsigned int)atoi(optarg);
+				break;
+			case 'h':
+				show_help();
+				exit(0);
+			default:
+				show_help();
+				exit(1);
+		}
+	}
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+	init(argc, argv);
+
+	UdpSender *udp = _network ? new UdpSender(_address.c_str(), _port, _size) : NULL;
+	if ((udp!=NULL) && (_interface!="")) udp->setMulticastInterface(_interface.c_str());
+	LoadSender *udp_sender = new LoadSender(udp, _size);
+	TuioServer *server = new TuioServer(udp_sender);
+	TuioLoadGen loadgen(server, _seed);
+	loadgen.addSender(udp_sender);
+
+	if (_network && (_tcp>0)) {
+		LoadSender *tcp_sender = NULL;
+		try { tcp_sender = new LoadSender(new TcpSender(_tcp), _size); }
+		catch (std::exception &e) { tcp_sender = NULL; }
+		if (tcp_sender) { server->addOscSender(tcp_sender); loadgen.addSender(tcp_sender); }
+	}
+
+	if (_network && (_websocket>0)) {
+		LoadSender *web_sender = NULL;
+		try {
+			WebSockSender *websock = new WebSockSender(_websocket);
+			if (_deflate) websock->setDeflate(true);
+			web_sender = new LoadSender(websock, _size);
+		} catch (std::exception &e) { web_sender = NULL; }
+		if (web_sender) { server->addOscSender(web_sender); loadgen.addSender(web_sender); }
+	}
+
+	if (_network && (_shm!="")) {
+		LoadSender *shm_sender = NULL;
+		try { shm_sender = new LoadSender(new ShmSender(_shm.c_str()), _size); }
+		catch (std::exception &e) { shm_sender = NULL; }
+		if (shm_sender) { server->addOscSender(shm_sender); loadgen.addSender(shm_sender); }
+	}
+
+	if (_network && (_unix!="")) {
+		LoadSender *unix_sender = NULL;
+		try { unix_sender = new LoadSender(new UnixSender(_unix.c_str()), _size); }
+		catch (std::exception &e) { unix_sender = NULL; }
+		if (unix_sender) { server->addOscSender(unix_sender); loadgen.addSender(unix_sender); }
+	}
+
+	if (_network && (_scene!="")) {
+		int max_entities = TUIO_SCENE_MAX;
+		if (_cursors>max_entities) max_entities = _cursors;
+		if (_objects>max_entities) max_entities = _objects;
+		if (_blobs>max_entities) max_entities = _blobs;
+		TuioScenePublisher *publisher = NULL;
+		try { publisher = new TuioScenePublisher(NULL, _scene.c_str(), max_entities); }
+		catch (std::exception &e) { publisher = NULL; }
+		if (publisher) server->setScenePublisher(publisher);
+	}
+
+	server->setCursorInterval(_cursor_interval);
+	server->setObjectInterval(_object_interval);
+	server->setBlobInterval(_blob_interval);
+
+	loadgen.setMotion(_motion);
+	loadgen.setChurn(_churn);
+	loadgen.addEntities('c', _cursors);
+	loadgen.addEntities('o', _objects);
+	loadgen.addEntities('b', _blobs);
+
+	_loadgen = &loadgen;
+	signal(SIGINT, stop);
+	loadgen.run(_rate, _duration, _interval);
+
+	delete server;
+	return 0;
+}
@@ -0,0 +1,108 @@
+/*
+	TUIO C++ Example - part of the reacTIVision project
+	http://reactivision.sourceforge.net/
+
+	Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef INCLUDED_TUIOLOADGEN_H
+#define INCLUDED_TUIOLOADGEN_H
+
+#include "TuioServer.h"
+#include "TuioClock.h"
+#include <vector>
+
+#define LOAD_WALK 0
+#define LOAD_SWIPE 1
+#define LOAD_ROTATE 2
+#define LOAD_MIXED 3
+
+using namespace TUIO;
+
+/* forwards the encoded bundles to another OscSender, or nowhere, and measures the delivered bytes and the send time */
+class LoadSender : public OscSender {
+
+	public:
+		LoadSender(OscSender *sender, int size);
+		~LoadSender();
+
+		bool sendOscPacket (osc::OutboundPacketStream *bundle);
+		bool isConnected () { return ((sender==NULL) || sender->isConnected()); }
+		void answerPings () { if (sender!=NULL) sender->answerPings(); }
+		const char* tuio_type() { return (sender!=NULL) ? sender->tuio_type() : "TUIO/NULL"; }
+
+		long bytes;
+		long packets;
+		osc::int64 send_time;
+
+	private:
+		OscSender *sender;
+};
+
+/* a synthetic cursor, object or blob and the state of its motion model */
+struct LoadEntity {
+	char profile;	// 'c', 'o' or 'b'
+	int model;
+	TuioCursor *tcur;
+	TuioObject *tobj;
+	TuioBlob *tblb;
+	float x, y, angle;
+	float vx, vy, va;
+	float cx, cy, radius;
+};
+
+class TuioLoadGen {
+
+	public:
+		TuioLoadGen(TuioServer *server, unsigned int seed);
+		~TuioLoadGen();
+
+		void addEntities(char profile, int count);
+		void setMotion(int model) { motion = model; }
+		void setChurn(float rate) { churn = rate; }
+		void addSender(LoadSender *sender) { senderList.push_back(sender); }
+
+		void run(int frame_rate, float duration, float report_interval);
+		void stop() { running = false; }
+
+	private:
+		void spawn(LoadEntity &entity);
+		void release(LoadEntity &entity);
+		void move(LoadEntity &entity, float dt);
+		void report(const char *label, long frames, osc::int64 period, osc::int64 encode_time, osc::int64 frame_time);
+		double random();
+
+		TuioServer *server;
+		std::vector<LoadEntity> entityList;
+		std::vector<LoadSender*> senderList;
+		int motion;
+		float churn;
+		int symbol;
+		osc::uint64 random_state;
+		volatile bool running;
+};
+
+#endif /* INCLUDED_TUIOLOADGEN_H */
@@ -0,0 +1,489 @@
+/*
+	TUIO C++ Example - part of the reacTIVision project
+	http://reactivision.sourceforge.net/
+
+	Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "TuioProxy.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#ifndef WIN32
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+static int _port = 3334;
+static std::string _host("localhost");
+static int _target = 3333;
+static float _loss = 0.0f;
+static float _burst = 1.0f;
+static float _duplication = 0.0f;
+static float _reorder = 0.0f;
+static int _gap = 10;
+static int _delay = 0;
+static int _jitter = 0;
+static int _distribution = PROXY_UNIFORM;
+static bool _replies = false;
+static unsigned int _seed = 1;
+static std::string _logfile("");
+
+#ifndef WIN32
+static void* DeliveryThreadFunc( void* obj )
+#else
+static DWORD WINAPI DeliveryThreadFunc( LPVOID obj )
+#endif
+{
+	static_cast<TuioProxy*>(obj)->runDelivery();
+	return 0;
+};
+
+void ReplyListener::ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint) {
+	proxy->processReply(data, size, 0);
+}
+
+void ReplyListener::ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint, osc::int64 receiveTime) {
+	proxy->processReply(data, size, receiveTime);
+}
+
+TuioProxy::TuioProxy(int port, const char *host, int target_port)
+	:replyListener	(this)
+	,seq		(0)
+	,running	(false)
+	,loss		(0.0f)
+	,burst		(1.0f)
+	,duplication	(0.0f)
+	,reorder	(0.0f)
+	,reorder_gap	(0)
+	,delay		(0)
+	,jitter		(0)
+	,distribution	(PROXY_UNIFORM)
+	,impair_replies	(false)
+	,loss_state	(false)
+	,random_state	(1)
+	,received	(0)
+	,forwarded	(0)
+	,lost		(0)
+	,duplicated	(0)
+	,reordered	(0)
+	,replies	(0)
+	,log_file	(NULL)
+{
+	front_socket = new UdpReceiveSocket(IpEndpointName(IpEndpointName::ANY_ADDRESS, port));
+	back_socket = new UdpTransmitSocket(IpEndpointName(GetHostByName(host), target_port));
+	front_socket->SetEnableReceiveTimestamps(true);
+	back_socket->SetEnableReceiveTimestamps(true);
+	multiplexer.AttachSocketListener(front_socket, this);
+	multiplexer.AttachSocketListener(back_socket, &replyListener);
+
+#ifdef WIN32
+	queueMutex = CreateMutex(NULL,FALSE,NULL);
+	queueEvent = CreateEvent(NULL,FALSE,FALSE,NULL);
+#else
+	pthread_mutex_init(&queueMutex,NULL);
+	pthread_cond_init(&queueCond,NULL);
+#endif
+
+	std::cout << "forwarding UDP port " << port << " to " << host << ":" << target_port << std::endl;
+}
+
+TuioProxy::~TuioProxy() {
+	multiplexer.DetachSocketListener(front_socket, this);
+	multiplexer.DetachSocketListener(back_socket, &replyListener);
+	delete front_socket;
+	delete back_socket;
+	for (unsigned int i=0;i<queue.size();i++) delete queue[i];
+	if (log_file) fclose(log_file);
+#ifdef WIN32
+	CloseHandle(queueMutex);
+	CloseHandle(queueEvent);
+#else
+	pthread_mutex_destroy(&queueMutex);
+	pthread_cond_destroy(&queueCond);
+#endif
+}
+
+void TuioProxy::setLoss(float percent, float length) {
+	loss = percent/100.0f;
+	burst = (length<1.0f) ? 1.0f : length;
+}
+
+void TuioProxy::setDuplication(float percent) {
+	duplication = percent/100.0f;
+}
+
+void TuioProxy::setReorder(float percent, int gap) {
+	reorder = percent/100.0f;
+	reorder_gap = (osc::int64)gap*1000000;
+}
+
+void TuioProxy::setDelay(int d, int j, int dist) {
+	delay = (osc::int64)d*1000000;
+	jitter = (osc::int64)j*1000000;
+	distribution = dist;
+}
+
+void TuioProxy::setSeed(unsigned int seed) {
+	random_state = (osc::uint64)seed*2654435761ULL + 1;
+}
+
+bool TuioProxy::openLog(const char *file) {
+	log_file = fopen(file, "w");
+	if (log_file==NULL) return false;
+	fprintf(log_file, "# seq direction size receive_ns send_ns event\n");
+	return true;
+}
+
+double TuioProxy::random() {
+	// xorshift64*, which gives the same sequence for a seed on every platform
+	random_state ^= random_state >> 12;
+	random_state ^= random_state << 25;
+	random_state ^= random_state >> 27;
+	return (double)((random_state * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
+
+double TuioProxy::sampleJitter() {
+	if (jitter==0) return 0.0;
+	switch (distribution) {
+		case PROXY_NORMAL: {
+			double u1 = random();
+			double u2 = random();
+			if (u1<1e-12) u1 = 1e-12;
+			return (double)jitter * sqrt(-2.0*log(u1)) * cos(6.283185307179586*u2);
+		}
+		case PROXY_PARETO: {
+			// a heavy tail with shape 2.5, scaled to a mean of the jitter value
+			double u = random();
+			if (u<1e-12) u = 1e-12;
+			return (double)jitter * 1.5 * (pow(u, -1.0/2.5) - 1.0);
+		}
+		default:
+			return (double)jitter * (2.0*random() - 1.0);
+	}
+}
+
+bool TuioProxy::isLost() {
+	if (loss<=0.0f) return false;
+	if (burst<=1.0f) return (random()<loss);
+
+	// the Gilbert model loses all packets in its bad state, which lasts for the mean burst length
+	double leave = 1.0/burst;
+	double enter = loss*leave/(1.0-loss);
+	if (loss_state) {
+		if (random()<leave) loss_state = false;
+	} else if (random()<enter) loss_state = true;
+	return loss_state;
+}
+
+void TuioProxy::ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint) {
+	ProcessPacket(data, size, remoteEndpoint, 0);
+}
+
+void TuioProxy::ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint, osc::int64 receiveTime) {
+	// the replies of the target are returned to the latest sender
+	client = remoteEndpoint;
+	received++;
+	schedulePacket(data, size, false, (receiveTime>0) ? receiveTime : TuioClock::getSystemTime());
+}
+
+void TuioProxy::processReply(const char *data, int size, osc::int64 receiveTime) {
+	replies++;
+	osc::int64 receive_time = (receiveTime>0) ? receiveTime : TuioClock::getSystemTime();
+	if (impair_replies) schedulePacket(data, size, true, receive_time);
+	else queuePacket(data, size, true, receive_time, receive_time, "reply");
+}
+
+void TuioProxy::schedulePacket(const char *data, int size, bool reply, osc::int64 receive_time) {
+
+	if (isLost()) {
+		ProxyPacket packet;
+		packet.seq = seq++;
+		packet.reply = reply;
+		packet.data.assign(data, size);
+		packet.receive_time = receive_time;
+		packet.send_time = -1;
+		packet.event = "loss";
+		lost++;
+#ifdef WIN32
+		WaitForSingleObject(queueMutex, INFINITE);
+		logPacket(&packet);
+		ReleaseMutex(queueMutex);
+#else
+		pthread_mutex_lock(&queueMutex);
+		logPacket(&packet);
+		pthread_mutex_unlock(&queueMutex);
+#endif
+		return;
+	}
+
+	int copies = 1;
+	if ((duplication>0.0f) && (random()<duplication)) copies = 2;
+
+	for (int i=0;i<copies;i++) {
+		const char *event = (i==0) ? "forward" : "duplicate";
+		osc::int64 send_time = receive_time + delay + (osc::int64)sampleJitter();
+		if ((reorder>0.0f) && (random()<reorder)) {
+			send_time += reorder_gap;
+			event = (i==0) ? "reorder" : "duplicate";
+			reordered++;
+		}
+		if (send_time<receive_time) send_time = receive_time;
+		if (i>0) duplicated++;
+		queuePacket(data, size, reply, receive_time, send_time, event);
+	}
+}
+
+void TuioProxy::queuePacket(const char *data, int size, bool reply, osc::int64 receive_time, osc::int64 send_time, const char *event) {
+
+	ProxyPacket *packet = new ProxyPacket();
+	packet->data.assign(data, size);
+	packet->reply = reply;
+	packet->receive_time = receive_time;
+	packet->send_time = send_time;
+	packet->event = event;
+
+#ifdef WIN32
+	WaitForSingleObject(queueMutex, INFINITE);
+#else
+	pthread_mutex_lock(&queueMutex);
+#endif
+	packet->seq = seq++;
+	queue.push_back(packet);
+	std::push_heap(queue.begin(), queue.end(), ProxyPacketLater());
+#ifdef WIN32
+	SetEvent(queueEvent);
+	ReleaseMutex(queueMutex);
+#else
+	pthread_cond_signal(&queueCond);
+	pthread_mutex_unlock(&queueMutex);
+#endif
+}
+
+void TuioProxy::logPacket(ProxyPacket *packet) {
+	if (log_file==NULL) return;
+	fprintf(log_file, "%lu %s %d %lld %lld %s\n", packet->seq, packet->reply ? "reply" : "forward", (int)packet->data.size(),
+		(long long)packet->receive_time, (long long)packet->send_time, packet->event);
+}
+
+void TuioProxy::runDelivery() {
+
+#ifdef WIN32
+	WaitForSingleObject(queueMutex, INFINITE);
+#else
+	pthread_mutex_lock(&queueMutex);
+#endif
+	while (running) {
+
+		osc::int64 timeout = -1;
+		if (!queue.empty()) {
+			ProxyPacket *packet = queue.front();
+			osc::int64 now = TuioClock::getSystemTime();
+			if (packet->send_time<=now) {
+				std::pop_heap(queue.begin(), queue.end(), ProxyPacketLater());
+				queue.pop_back();
+#ifdef WIN32
+				ReleaseMutex(queueMutex);
+#else
+				pthread_mutex_unlock(&queueMutex);
+#endif
+				if (packet->reply) {
+					if (client.port!=IpEndpointName::ANY_PORT) front_socket->SendTo(client, packet->data.data(), packet->data.size());
+				} else {
+					back_socket->Send(packet->data.data(), packet->data.size());
+					forwarded++;
+				}
+				packet->send_time = TuioClock::getSystemTime();
+#ifdef WIN32
+				WaitForSingleObject(queueMutex, INFINITE);
+#else
+				pthread_mutex_lock(&queueMutex);
+#endif
+				logPacket(packet);
+				delete packet;
+				continue;
+			}
+			timeout = packet->send_time-now;
+		}
+
+#ifdef WIN32
+		ReleaseMutex(queueMutex);
+		WaitForSingleObject(queueEvent, (timeout<0) ? INFINITE : (DWORD)(timeout/1000000+1));
+		WaitForSingleObject(queueMutex, INFINITE);
+#else
+		if (timeout<0) pthread_cond_wait(&queueCond, &queueMutex);
+		else {
+			struct timeval now;
+			gettimeofday(&now, NULL);
+			osc::int64 until = (osc::int64)now.tv_sec*1000000000 + (osc::int64)now.tv_usec*1000 + timeout;
+			struct timespec deadline;
+			deadline.tv_sec = (time_t)(until/1000000000);
+			deadline.tv_nsec = (long)(until%1000000000);
+			pthread_cond_timedwait(&queueCond, &queueMutex, &deadline);
+		}
+#endif
+	}
+#ifdef WIN32
+	ReleaseMutex(queueMutex);
+#else
+	pthread_mutex_unlock(&queueMutex);
+#endif
+}
+
+void TuioProxy::run() {
+
+	running = true;
+#ifndef WIN32
+	pthread_create(&delivery_thread, NULL, DeliveryThreadFunc, this);
+#else
+	delivery_thread = CreateThread(0, 0, DeliveryThreadFunc, this, 0, NULL);
+#endif
+
+	multiplexer.RunUntilSigInt();
+
+#ifdef WIN32
+	WaitForSingleObject(queueMutex, INFINITE);
+	running = false;
+	SetEvent(queueEvent);
+	ReleaseMutex(queueMutex);
+	WaitForSingleObject(delivery_thread, INFINITE);
+	CloseHandle(delivery_thread);
+#else
+	pthread_mutex_lock(&queueMutex);
+	running = false;
+	pthread_cond_signal(&queueCond);
+	pthread_mutex_unlock(&queueMutex);
+	pthread_join(delivery_thread, NULL);
+#endif
+}
+
+void TuioProxy::printStatistics() {
+	std::cout << "received " << received << " forwarded " << forwarded << " lost " << lost
+		<< " duplicated " << duplicated << " reordered " << reordered << " replies " << replies << std::endl;
+}
+
+static void show_help() {
+	std::cout << "Usage: TuioProxy -p [port] -a [address] -t [port] -l [percent] -b [length] -d [percent] -r [percent] -g [ms] -D [ms] -j [ms] -x [distribution] -R -s [seed] -f [logfile]" << std::endl;
+	std::cout << "        -p [port] receiving UDP port (default is 3334)" << std::endl;
+	std::cout << "        -a [address] target address (default is localhost)" << std::endl;
+	std::cout << "        -t [port] target UDP port (default is 3333)" << std::endl;
+	std::cout << "        -l [percent] packet loss" << std::endl;
+	std::cout << "        -b [length] mean loss burst length (default is 1)" << std::endl;
+	std::cout << "        -d [percent] packet duplication" << std::endl;
+	std::cout << "        -r [percent] packets held back for the reorder gap" << std::endl;
+	std::cout << "        -g [ms] reorder gap (default is 10)" << std::endl;
+	std::cout << "        -D [ms] constant delay" << std::endl;
+	std::cout << "        -j [ms] delay jitter" << std::endl;
+	std::cout << "        -x [distribution] jitter distribution: uniform, normal or pareto" << std::endl;
+	std::cout << "        -R also impair the replies of the target" << std::endl;
+	std::cout << "        -s [seed] random seed (default is 1)" << std::endl;
+	std::cout << "        -f [logfile] write the timing of each packet" << std::endl;
+	std::cout << "        -h show this help" << std::endl;
+}
+
+static void init(int argc, char** argv) {
+	char c;
+
+#ifndef WIN32
+	while ((c = getopt(argc, argv, "p:a:t:l:b:d:r:g:D:j:x:s:f:Rh")) != -1) {
+		switch (c) {
+			case 'p':
+				_port = atoi(optarg);
+				break;
+			case 'a':
+				_host = std::string(optarg);
+				break;
+			case 't':
+				_target = atoi(optarg);
+				break;
+			case 'l':
+				_loss = (float)atof(optarg);
+				break;
+			case 'b':
+				_burst = (float)atof(optarg);
+				break;
+			case 'd':
+				_duplication = (float)atof(optarg);
+				break;
+			case 'r':
+				_reorder = (float)atof(optarg);
+				break;
+			case 'g':
+				_gap = atoi(optarg);
+				break;
+			case 'D':
+				_delay = atoi(optarg);
+				break;
+			case 'j':
+				_jitter = atoi(optarg);
+				break;
+			case 'x':
+				if (strcmp(optarg,"normal")==0) _distribution = PROXY_NORMAL;
+				else if (strcmp(optarg,"pareto")==0) _distribution = PROXY_PARETO;
+				else _distribution = PROXY_UNIFORM;
+				break;
+			case 'R':
+				_replies = true;
+				break;
+			case 's':
+				_seed = (unsigned int)atoi(optarg);
+				break;
+			case 'f':
+				_logfile = std::string(optarg);
+				break;
+			case 'h':
+				show_help();
+				exit(0);
+			default:
+				show_help();
+				exit(1);
+		}
+	}
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+	init(argc, argv);
+
+	TuioProxy proxy(_port, _host.c_str(), _target);
+	proxy.setLoss(_loss, _burst);
+	proxy.setDuplication(_duplication);
+	proxy.setReorder(_reorder, _gap);
+	proxy.setDelay(_delay, _jitter, _distribution);
+	proxy.setReplyImpairment(_replies);
+	proxy.setSeed(_seed);
+	if ((_logfile!="") && !proxy.openLog(_logfile.c_str())) {
+		std::cerr << "could not open log file " << _logfile << std::endl;
+		return 1;
+	}
+
+	proxy.run();
+	proxy.printStatistics();
+	return 0;
+}
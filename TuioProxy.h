@@ -0,0 +1,154 @@
+/*
+	TUIO C++ Example - part of the reacTIVision project
+	http://reactivision.sourceforge.net/
+
+	Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef INCLUDED_TUIOPROXY_H
+#define INCLUDED_TUIOPROXY_H
+
+#include "TuioClock.h"
+#include "ip/UdpSocket.h"
+#include "ip/PacketListener.h"
+#include "ip/NetworkingUtils.h"
+#include "osc/OscTypes.h"
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#define PROXY_UNIFORM 0
+#define PROXY_NORMAL 1
+#define PROXY_PARETO 2
+
+using namespace TUIO;
+
+/* a datagram that waits in the delivery queue */
+struct ProxyPacket {
+	std::string data;
+	unsigned long seq;
+	bool reply;
+	osc::int64 receive_time;
+	osc::int64 send_time;
+	const char *event;
+};
+
+/* orders the delivery queue by send time and arrival */
+struct ProxyPacketLater {
+	bool operator()(const ProxyPacket *a, const ProxyPacket *b) const {
+		if (a->send_time!=b->send_time) return (a->send_time>b->send_time);
+		return (a->seq>b->seq);
+	}
+};
+
+class TuioProxy;
+
+/* passes the replies of the target back to the proxy */
+class ReplyListener : public PacketListener {
+
+	public:
+		ReplyListener(TuioProxy *proxy) : proxy(proxy) {}
+
+		void ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint);
+		void ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint, osc::int64 receiveTime);
+
+	private:
+		TuioProxy *proxy;
+};
+
+/* forwards UDP datagrams to a target port with configurable loss, duplication, reordering and delay */
+class TuioProxy : public PacketListener {
+
+	public:
+		TuioProxy(int port, const char *host, int target_port);
+		~TuioProxy();
+
+		void setLoss(float percent, float burst);
+		void setDuplication(float percent);
+		void setReorder(float percent, int gap);
+		void setDelay(int delay, int jitter, int distribution);
+		void setReplyImpairment(bool flag) { impair_replies = flag; }
+		void setSeed(unsigned int seed);
+		bool openLog(const char *file);
+
+		void run();
+		void runDelivery();
+		void printStatistics();
+
+		void ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint);
+		void ProcessPacket(const char *data, int size, const IpEndpointName &remoteEndpoint, osc::int64 receiveTime);
+		void processReply(const char *data, int size, osc::int64 receiveTime);
+
+	private:
+		void schedulePacket(const char *data, int size, bool reply, osc::int64 receive_time);
+		void queuePacket(const char *data, int size, bool reply, osc::int64 receive_time, osc::int64 send_time, const char *event);
+		void logPacket(ProxyPacket *packet);
+		bool isLost();
+		double random();
+		double sampleJitter();
+
+		UdpReceiveSocket *front_socket;
+		UdpTransmitSocket *back_socket;
+		SocketReceiveMultiplexer multiplexer;
+		ReplyListener replyListener;
+		IpEndpointName client;
+
+		std::vector<ProxyPacket*> queue;
+		unsigned long seq;
+		bool running;
+
+		float loss, burst;
+		float duplication;
+		float reorder;
+		osc::int64 reorder_gap;
+		osc::int64 delay, jitter;
+		int distribution;
+		bool impair_replies;
+		bool loss_state;
+		osc::uint64 random_state;
+
+		long received, forwarded, lost, duplicated, reordered, replies;
+		FILE *log_file;
+
+#ifdef WIN32
+		HANDLE queueMutex;
+		HANDLE queueEvent;
+		HANDLE delivery_thread;
+#else
+		pthread_mutex_t queueMutex;
+		pthread_cond_t queueCond;
+		pthread_t delivery_thread;
+#endif
+};
+
+#endif /* INCLUDED_TUIOPROXY_H */
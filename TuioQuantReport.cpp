@@ -0,0 +1,295 @@
+/*
+	TUIO C++ Example - part of the reacTIVision project
+	http://reactivision.sourceforge.net/
+
+	Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "TuioQuantReport.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cmath>
+#include <map>
+#include <set>
+
+static std::string _logfile("");
+static int _rate = 60;
+static int _size = IP_MTU_SIZE;
+
+LoopbackSender::LoopbackSender(LoopbackReceiver *rcv, int size)
+	:bytes		(0)
+	,packets	(0)
+	,receiver	(rcv)
+{
+	local = true;
+	buffer_size = size;
+}
+
+bool LoopbackSender::sendOscPacket (osc::OutboundPacketStream *bundle) {
+	if ( bundle->Size() > buffer_size ) return false;
+	if ( bundle->Size() == 0 ) return false;
+
+	bytes += (long)bundle->Size();
+	packets++;
+	receiver->ProcessPacket( bundle->Data(), (int)bundle->Size(), IpEndpointName() );
+	return true;
+}
+
+TuioQuantReport::TuioQuantReport(int rate, int size)
+	:frame_rate		(rate)
+	,packet_size	(size)
+	,reference_bytes(0)
+{
+}
+
+bool TuioQuantReport::loadSession(std::istream &log) {
+	
+	// TuioDump does not print frame boundaries, therefore a new frame is started
+	// as soon as an entity appears a second time within the current frame
+	DumpFrame frame;
+	std::set<std::pair<char,long> > frameEntities;
+	
+	std::string line;
+	while (std::getline(log,line)) {
+		char cmd[8], type[8];
+		int id, src;
+		DumpEvent event;
+		memset(&event,0,sizeof(event));
+		
+		int n = sscanf(line.c_str(),"%7s %7s %d (%ld/%d) %f %f %f %f %f %f",cmd,type,&id,&event.s_id,&src,&event.x,&event.y,&event.angle,&event.width,&event.height,&event.area);
+		if (n<5) continue;
+		
+		if (strcmp(cmd,"add")==0) event.command = 'a';
+		else if (strcmp(cmd,"set")==0) event.command = 's';
+		else if (strcmp(cmd,"del")==0) event.command = 'd';
+		else continue;
+
+		if (strcmp(type,"cur")==0) event.profile = 'c';
+		else if (strcmp(type,"obj")==0) event.profile = 'o';
+		else if (strcmp(type,"blb")==0) event.profile = 'b';
+		else continue;
+		
+		if ((event.command!='d') && (n<7)) continue;
+		event.symbol = id;
+		
+		std::pair<char,long> entity(event.profile,event.s_id);
+		if (frameEntities.count(entity)>0) {
+			frames.push_back(frame);
+			frame.clear();
+			frameEntities.clear();
+		}
+		frameEntities.insert(entity);
+		frame.push_back(event);
+	}
+	if (frame.size()>0) frames.push_back(frame);
+	
+	return (frames.size()>0);
+}
+
+void TuioQuantReport::replaySession(int bits) {
+	
+	LoopbackReceiver *receiver = new LoopbackReceiver();
+	LoopbackSender *sender = new LoopbackSender(receiver,packet_size);
+	TuioClient *client = new TuioClient(receiver);
+	client->connect();
+
+	TuioServer *server = new TuioServer(sender);
+	if (bits>0) server->enableQuantization(bits);
+	sender->bytes = 0;
+	sender->packets = 0;
+	
+	std::map<long,TuioCursor*> cursors;
+	std::map<long,TuioObject*> objects;
+	std::map<long,TuioBlob*> blobs;
+	
+	double max_error = 0.0;
+	double sum_error = 0.0;
+	double max_angle = 0.0;
+	long samples = 0;
+	
+	for (unsigned int f=0;f<frames.size();f++) {
+		server->initFrame(TuioTime((long)(f*1000/frame_rate)));
+		
+		for (DumpFrame::iterator event=frames[f].begin(); event!=frames[f].end(); event++) {
+			switch (event->profile) {
+				case 'c': {
+					std::map<long,TuioCursor*>::iterator tcur = cursors.find(event->s_id);
+					if (event->command=='d') {
+						if (tcur==cursors.end()) break;
+						server->removeTuioCursor(tcur->second);
+						cursors.erase(tcur);
+					} else if (tcur==cursors.end()) cursors[event->s_id] = server->addTuioCursor(event->x,event->y);
+					else server->updateTuioCursor(tcur->second,event->x,event->y);
+					break;
+				}
+				case 'o': {
+					std::map<long,TuioObject*>::iterator tobj = objects.find(event->s_id);
+					if (event->command=='d') {
+						if (tobj==objects.end()) break;
+						server->removeTuioObject(tobj->second);
+						objects.erase(tobj);
+					} else if (tobj==objects.end()) objects[event->s_id] = server->addTuioObject(event->symbol,event->x,event->y,event->angle);
+					else server->updateTuioObject(tobj->second,event->x,event->y,event->angle);
+					break;
+				}
+				case 'b': {
+					std::map<long,TuioBlob*>::iterator tblb = blobs.find(event->s_id);
+					if (event->command=='d') {
+						if (tblb==blobs.end()) break;
+						server->removeTuioBlob(tblb->second);
+						blobs.erase(tblb);
+					} else if (tblb==blobs.end()) blobs[event->s_id] = server->addTuioBlob(event->x,event->y,event->angle,event->width,event->height,event->area);
+					else server->updateTuioBlob(tblb->second,event->x,event->y,event->angle,event->width,event->height,event->area);
+					break;
+				}
+			}
+		}
+		server->commitFrame();
+		
+		// compare the decoded client state with the original server state
+		for (std::map<long,TuioCursor*>::iterator tcur=cursors.begin(); tcur!=cursors.end(); tcur++) {
+			TuioCursor *rcur = client->getTuioCursor(tcur->second->getSessionID());
+			if (rcur==NULL) continue;
+			double error = std::max(fabs(rcur->getX()-tcur->second->getX()),fabs(rcur->getY()-tcur->second->getY()));
+			max_error = std::max(max_error,error);
+			sum_error += error;
+			samples++;
+		}
+		for (std::map<long,TuioObject*>::iterator tobj=objects.begin(); tobj!=objects.end(); tobj++) {
+			TuioObject *robj = client->getTuioObject(tobj->second->getSessionID());
+			if (robj==NULL) continue;
+			double error = std::max(fabs(robj->getX()-tobj->second->getX()),fabs(robj->getY()-tobj->second->getY()));
+			max_error = std::max(max_error,error);
+			sum_error += error;
+			samples++;
+			double angle = fabs(robj->getAngle()-tobj->second->getAngle());
+			if (angle>M_PI) angle = 2*M_PI - angle;
+			max_angle = std::max(max_angle,angle);
+		}
+		for (std::map<long,TuioBlob*>::iterator tblb=blobs.begin(); tblb!=blobs.end(); tblb++) {
+			TuioBlob *rblb = client->getTuioBlob(tblb->second->getSessionID());
+			if (rblb==NULL) continue;
+			double error = std::max(fabs(rblb->getX()-tblb->second->getX()),fabs(rblb->getY()-tblb->second->getY()));
+			max_error = std::max(max_error,error);
+			sum_error += error;
+			samples++;
+			double angle = fabs(rblb->getAngle()-tblb->second->getAngle());
+			if (angle>M_PI) angle = 2*M_PI - angle;
+			max_angle = std::max(max_angle,angle);
+		}
+	}
+	
+	long bytes = sender->bytes;
+	long packets = sender->packets;
+	if (bits==0) reference_bytes = bytes;
+	
+	std::ostringstream label;
+	if (bits>0) label << bits << " bit";
+	else label << "float";
+	
+	std::cout << std::setw(8) << label.str();
+	std::cout << std::setw(12) << std::fixed << std::setprecision(1) << (double)bytes/frames.size();
+	std::cout << std::setw(10) << std::setprecision(2) << (double)packets/frames.size();
+	if (reference_bytes>0) std::cout << std::setw(9) << std::setprecision(1) << 100.0*(reference_bytes-bytes)/reference_bytes << "%";
+	else std::cout << std::setw(10) << "-";
+	std::cout << std::setw(12) << std::scientific << std::setprecision(2) << max_error;
+	std::cout << std::setw(12) << (samples>0 ? sum_error/samples : 0.0);
+	std::cout << std::setw(10) << std::fixed << std::setprecision(2) << max_error*4096.0;
+	std::cout << std::setw(10) << std::setprecision(3) << max_angle*180.0/M_PI << std::endl;
+	
+	delete server;
+	client->disconnect();
+	delete client;
+	delete receiver;
+}
+
+static void show_help() {
+	std::cout << "Usage: TuioQuantReport -f [logfile] -r [rate] -s [size]" << std::endl;
+	std::cout << "        -f [logfile] TuioDump session log (default is stdin)" << std::endl;
+	std::cout << "        -r [rate] replay frame rate (default is 60)" << std::endl;
+	std::cout << "        -s [size] maximum packet size (default is 1500)" << std::endl;
+	std::cout << "        -h show this help" << std::endl;
+}
+
+static void init(int argc, char** argv) {
+	char c;
+	
+#ifndef WIN32
+	while ((c = getopt(argc, argv, "f:r:s:h")) != -1) {
+		switch (c) {
+			case 'f':
+				_logfile = std::string(optarg);
+				break;
+			case 'r':
+				_rate = atoi(optarg);
+				if (_rate<1) _rate = 1;
+				break;
+			case 's':
+				_size = atoi(optarg);
+				if (_size<MIN_UDP_SIZE) _size = MIN_UDP_SIZE;
+				break;
+			case 'h':
+				show_help();
+				exit(0);
+			default:
+				show_help();
+				exit(1);
+		}
+	}
+#endif
+}
+
+int main(int argc, char* argv[])
+{
+	init(argc, argv);
+	
+	TuioQuantReport report(_rate,_size);
+	bool loaded = false;
+	if (_logfile.size()>0) {
+		std::ifstream log(_logfile.c_str());
+		if (!log) {
+			std::cerr << "could not open session log " << _logfile << std::endl;
+			return 1;
+		}
+		loaded = report.loadSession(log);
+	} else loaded = report.loadSession(std::cin);
+	
+	if (!loaded) {
+		std::cerr << "no TUIO events found in session log" << std::endl;
+		return 1;
+	}
+	
+	std::cout << "replaying " << report.getFrameCount() << " frames at " << _rate << " fps" << std::endl;
+	std::cout << std::setw(8) << "coding" << std::setw(12) << "bytes/frm" << std::setw(10) << "pkts/frm" << std::setw(10) << "saving";
+	std::cout << std::setw(12) << "max err" << std::setw(12) << "mean err" << std::setw(10) << "max/4096" << std::setw(10) << "max deg" << std::endl;
+	
+	int levels[] = { 0, 16, 14, 12, 10, 8 };
+	for (int i=0;i<6;i++) report.replaySession(levels[i]);
+	
+	return 0;
+}
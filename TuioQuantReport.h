@@ -0,0 +1,94 @@
+/*
+	TUIO C++ Example - part of the reacTIVision project
+	http://reactivision.sourceforge.net/
+
+	Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef INCLUDED_TUIOQUANTREPORT_H
+#define INCLUDED_TUIOQUANTREPORT_H
+
+#include "TuioServer.h"
+#include "TuioClient.h"
+#include "OscReceiver.h"
+#include <string>
+#include <vector>
+
+using namespace TUIO;
+
+/* a single add, set or del line of a TuioDump session log */
+struct DumpEvent {
+	char command;	// 'a', 's' or 'd'
+	char profile;	// 'c', 'o' or 'b'
+	long s_id;
+	int symbol;
+	float x, y, angle, width, height, area;
+};
+
+typedef std::vector<DumpEvent> DumpFrame;
+
+/* delivers the received OSC data directly to the attached TuioClient */
+class LoopbackReceiver : public OscReceiver {
+	
+	public:
+		void connect(bool lock=false) { connected = true; }
+		void disconnect() { connected = false; }
+};
+
+/* hands the encoded bundles to a LoopbackReceiver and counts the delivered bytes */
+class LoopbackSender : public OscSender {
+	
+	public:
+		LoopbackSender(LoopbackReceiver *receiver, int size);
+		
+		bool sendOscPacket (osc::OutboundPacketStream *bundle);
+		bool isConnected () { return true; }
+		const char* tuio_type() { return "TUIO/LOOP"; }
+
+		long bytes;
+		long packets;
+
+	private:
+		LoopbackReceiver *receiver;
+};
+
+class TuioQuantReport {
+	
+	public:
+		TuioQuantReport(int frame_rate, int packet_size);
+		
+		bool loadSession(std::istream &log);
+		void replaySession(int bits);
+		int getFrameCount() { return (int)frames.size(); }
+	
+	private:
+		std::vector<DumpFrame> frames;
+		int frame_rate;
+		int packet_size;
+		long reference_bytes;
+};
+
+#endif /* INCLUDED_TUIOQUANTREPORT_H */
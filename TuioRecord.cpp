@@ -0,0 +1,215 @@
+/*
+	TUIO C++ Example - part of the reacTIVision project
+	http://reactivision.sourceforge.net/
+
+	Copyright (c) 2005-2017 Martin Kaltenbrunner <martin@tuio.org>
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files
+	(the "Software"), to deal in the Software without restriction,
+	including without limitation the rights to use, copy, modify, merge,
+	publish, distribute, sublicense, and/or sell copies of the Software,
+	and to permit persons to whom the Software is furnished to do so,
+	subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	Any person wishing to distribute modifications to the Software is
+	requested to send the modifications to the original developer so that
+	they can be incorporated into the canonical version.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+	ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+	CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+	WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "TuioRecorder.h"
+#include "TuioPlayer.h"
+#include "TuioClock.h"
+#include "UdpReceiver.h"
+#include "TcpReceiver.h"
+#include "UdpSender.h"
+#include "TcpSender.h"
+#include <iostream>
+#include <cstdlib>
+#include <csignal>
+#include <string>
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+using namespace TUIO;
+
+static std::string _record("");
+static std::string _replay("");
+static std::string _info("");
+static std::string _address("localhost");
+static bool _udp = true;
+static int _port = 3333;
+static double _speed = 1.0;
+static double _seek = 0.0;
+
+static volatile bool _running = true;
+
+static void stop(int signal) {
+	_running = false;
+}
+
+static void idle() {
+#ifdef WIN32
+	Sleep(100);
+#else
+	usleep(100000);
+#endif
+}
+
+static int record() {
+
+	OscReceiver *osc_receiver;
+	if (_udp) osc_receiver = new UdpReceiver(_port);
+	else {
+		if (_address=="incoming") osc_receiver = new TcpReceiver(_port);
+		else osc_receiver = new TcpReceiver(_address.c_str(), _port);
+	}
+
+	TuioRecorder recorder;
+	if (!recorder.open(_record.c_str())) {
+		delete osc_receiver;
+		return 1;
+	}
+
+	osc_receiver->addPacketTap(&recorder);
+	osc_receiver->connect();
+	std::cout << "recording to " << _record << ", press Ctrl-C to stop" << std::endl;
+
+	signal(SIGINT, stop);
+	while (_running) idle();
+
+	osc_receiver->disconnect();
+	recorder.close();
+	std::cout << "recorded " << recorder.getPacketCount() << " packets" << std::endl;
+
+	delete osc_receiver;
+	return 0;
+}
+
+static int replay() {
+
+	TuioPlayer player(_replay.c_str());
+	if (!player.getRecording()->isOpen()) return 1;
+
+	OscSender *osc_sender;
+	if (_udp) osc_sender = new UdpSender(_address.c_str(), _port);
+	else {
+		if (_address=="incoming") osc_sender = new TcpSender(_port);
+		else osc_sender = new TcpSender(_address.c_str(), _port);
+	}
+
+	// a listening TcpSender waits for its first client
+	signal(SIGINT, stop);
+	while (_running && !osc_sender->isConnected()) idle();
+
+	player.addOscSender(osc_sender);
+	player.setSpeed(_speed);
+	if (_seek>0.0) player.seek((osc::int64)(_seek*1000000000.0));
+
+	osc::int64 start = TuioClock::getSystemTime();
+	if (_running) player.connect();
+	while (_running && player.isPlaying()) idle();
+	player.disconnect();
+
+	double duration = (TuioClock::getSystemTime()-start)/1000000000.0;
+	std::cout << "replayed " << _replay << " in " << duration << " s" << std::endl;
+
+	delete osc_sender;
+	return 0;
+}
+
+static int info() {
+
+	TuioRecording recording;
+	if (!recording.open(_info.c_str())) {
+		std::cerr << "could not open TUIO recording " << _info << std::endl;
+		return 1;
+	}
+
+	double duration = (recording.getEndTime()-recording.getStartTime())/1000000000.0;
+	std::cout << _info << ": " << recording.getPacketCount() << " packets, " << duration << " s";
+	if (!recording.isComplete()) std::cout << ", incomplete";
+	std::cout << std::endl;
+	return 0;
+}
+
+static void show_help() {
+	std::cout << "Usage: TuioRecord -f [file] -r [file] -i [file] -p [port] -t -a [address] -x [speed] -k [seconds]" << std::endl;
+	std::cout << "        -f [file] record the received TUIO packets" << std::endl;
+	std::cout << "        -r [file] replay a recording" << std::endl;
+	std::cout << "        -i [file] print the recording properties" << std::endl;
+	std::cout << "        -p [port] for alternative port number" << std::endl;
+	std::cout << "        -t for TUIO/TCP (default is TUIO/UDP)" << std::endl;
+	std::cout << "        -a [address] for the TUIO/TCP server or the replay target" << std::endl;
+	std::cout << "           use 'incoming' for TUIO/TCP socket" << std::endl;
+	std::cout << "        -x [speed] replay speed factor, 0 replays as fast as possible" << std::endl;
+	std::cout << "        -k [seconds] start the replay at this position" << std::endl;
+	std::cout << "        -h show this help" << std::endl;
+}
+
+static void init(int argc, char** argv) {
+	char c;
+
+#ifndef WIN32
+	while ((c = getopt(argc, argv, "f:r:i:p:a:x:k:th")) != -1) {
+		switch (c) {
+			case 'f':
+				_record = std::string(optarg);
+				break;
+			case 'r':
+				_replay = std::string(optarg);
+				break;
+			case 'i':
+				_info = std::string(optarg);
+				break;
+			case 't':
+				_udp = false;
+				break;
+			case 'a':
+				_address = std::string(optarg);
+				break;
+			case 'p':
+				_port = atoi(optarg);
+				break;
+			case 'x':
+				_speed = atof(optarg);
+				break;
+			case 'k':
+				_seek = atof(optarg);
+				break;
+			case 'h':
+				show_help();
+				exit(0);
+			default:
+				show_help();
+				exit(1);
+		}
+	}
+#endif
+
+	if ((_record=="") && (_replay=="") && (_info=="")) {
+		show_help();
+		exit(1);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	init(argc, argv);
+
+	if (_info!="") return info();
+	if (_replay!="") return replay();
+	return record();
+}
@@ -38,6 +38,8 @@
 #define INCLUDED_OSCPACK_PACKETLISTENER_H
 
 
+#include "osc/OscTypes.h"
+
 class IpEndpointName;
 
 class PacketListener{
@@ -45,6 +47,15 @@ public:
     virtual ~PacketListener() {}
     virtual void ProcessPacket( const char *data, int size, 
 			const IpEndpointName& remoteEndpoint ) = 0;
+
+    // called instead of the above for sockets with receive timestamps enabled,
+    // receiveTime is the kernel receive time in nanoseconds since the epoch
+    virtual void ProcessPacket( const char *data, int size, 
+			const IpEndpointName& remoteEndpoint, osc::int64 receiveTime )
+    {
+        (void) receiveTime;
+        ProcessPacket( data, size, remoteEndpoint );
+    }
 };
 
 #endif /* INCLUDED_OSCPACK_PACKETLISTENER_H */
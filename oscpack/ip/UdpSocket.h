@@ -41,6 +41,7 @@
 
 #include "NetworkingUtils.h"
 #include "IpEndpointName.h"
+#include "osc/OscTypes.h"
 
 
 class PacketListener;
@@ -102,6 +103,47 @@ public:
 	// operating systems.
 	void SetAllowReuse( bool allowReuse );
 
+	// Distribute incoming datagrams across several sockets bound
+	// to the same port, the kernel hashes each remote endpoint to
+	// one of these sockets. Sets SO_REUSEPORT on Linux 3.9 and later,
+	// has no effect on systems without load balancing support.
+	void SetEnableReusePort( bool enableReusePort );
+
+	// Set the size of the kernel receive and send buffers.
+	// Sets SO_RCVBUF and SO_SNDBUF, the kernel may adjust the size.
+	void SetReceiveBufferSize( int size );
+	void SetSendBufferSize( int size );
+
+	// Join or leave an IPv4 multicast group on the interface with
+	// the given local address, or on the default interface for
+	// IpEndpointName::ANY_ADDRESS. The socket should be bound to the
+	// group port with SetAllowReuse() enabled, so that several
+	// receivers on the same host can share the group.
+	// Returns false if the membership could not be changed.
+	bool JoinMulticastGroup( unsigned long group, unsigned long interfaceAddress );
+	bool LeaveMulticastGroup( unsigned long group, unsigned long interfaceAddress );
+
+	// Configure the outgoing multicast datagrams: the number of router
+	// hops, the delivery to the receivers on the sending host, and the
+	// interface with the given local address.
+	// Sets IP_MULTICAST_TTL, IP_MULTICAST_LOOP and IP_MULTICAST_IF.
+	void SetMulticastTTL( int ttl );
+	void SetMulticastLoopback( bool enableLoopback );
+	void SetMulticastInterface( unsigned long interfaceAddress );
+
+	// Set the largest datagram that the SocketReceiveMultiplexer
+	// delivers for this socket, larger datagrams are truncated.
+	// Defaults to 4098 bytes, the maximum UDP payload is 65507 bytes.
+	void SetMaxPacketSize( std::size_t size );
+	std::size_t MaxPacketSize() const;
+
+	// Capture the kernel receive time of each datagram, which the
+	// SocketReceiveMultiplexer passes on to its PacketListener.
+	// Sets SO_TIMESTAMPNS on Linux and SO_TIMESTAMP on other posix
+	// systems, has no effect on Windows.
+	void SetEnableReceiveTimestamps( bool enableTimestamps );
+	bool ReceiveTimestamps() const;
+
 
 	// The socket is created in an unbound, unconnected state
 	// such a socket can only be used to send to an arbitrary
@@ -126,6 +168,13 @@ public:
 	bool IsBound() const;
 
     std::size_t ReceiveFrom( IpEndpointName& remoteEndpoint, char *data, std::size_t size );
+
+	// Receive a pending datagram without blocking, returns 0 if none
+	// is available. Also works on connected sockets, which only receive
+	// from their remote endpoint. receiveTime is the kernel receive time
+	// in nanoseconds since the epoch if receive timestamps are enabled,
+	// otherwise 0.
+    std::size_t ReceivePending( IpEndpointName& remoteEndpoint, char *data, std::size_t size, osc::int64& receiveTime );
 };
 
 
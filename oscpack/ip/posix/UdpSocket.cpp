@@ -38,6 +38,7 @@
 
 #include <pthread.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <netdb.h>
@@ -46,6 +47,10 @@
 #include <sys/time.h>
 #include <netinet/in.h> // for sockaddr_in
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
 #include <signal.h>
 #include <math.h>
 #include <errno.h>
@@ -97,9 +102,37 @@ static IpEndpointName IpEndpointNameFromSockaddr( const struct sockaddr_in& sock
 }
 
 
+// room for a single SCM_TIMESTAMPNS or SCM_TIMESTAMP control message
+#define RECEIVE_CONTROL_SIZE 64
+
+
+static osc::int64 ReceiveTimeFromControl( struct msghdr *message )
+{
+    for( struct cmsghdr *cmsg = CMSG_FIRSTHDR( message ); cmsg != 0; cmsg = CMSG_NXTHDR( message, cmsg ) ){
+        if( cmsg->cmsg_level != SOL_SOCKET )
+            continue;
+#ifdef SCM_TIMESTAMPNS
+        if( cmsg->cmsg_type == SCM_TIMESTAMPNS ){
+            struct timespec ts;
+            std::memcpy( &ts, CMSG_DATA( cmsg ), sizeof(ts) );
+            return (osc::int64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+        }
+#endif
+        if( cmsg->cmsg_type == SCM_TIMESTAMP ){
+            struct timeval tv;
+            std::memcpy( &tv, CMSG_DATA( cmsg ), sizeof(tv) );
+            return (osc::int64)tv.tv_sec * 1000000000 + (osc::int64)tv.tv_usec * 1000;
+        }
+    }
+    return 0;
+}
+
+
 class UdpSocket::Implementation{
 	bool isBound_;
 	bool isConnected_;
+	bool receiveTimestamps_;
+	std::size_t maxPacketSize_;
 
 	int socket_;
 	struct sockaddr_in connectedAddr_;
@@ -110,6 +143,8 @@ public:
 	Implementation()
 		: isBound_( false )
 		, isConnected_( false )
+		, receiveTimestamps_( false )
+		, maxPacketSize_( 4098 )
 		, socket_( -1 )
 	{
 		if( (socket_ = socket( AF_INET, SOCK_DGRAM, 0 )) == -1 ){
@@ -143,6 +178,79 @@ public:
 #endif
 	}
 
+	void SetEnableReusePort( bool enableReusePort )
+	{
+#if defined(__linux__) && defined(SO_REUSEPORT)
+		int reusePort = (enableReusePort) ? 1 : 0; // int on posix
+		setsockopt(socket_, SOL_SOCKET, SO_REUSEPORT, &reusePort, sizeof(reusePort));
+#endif
+	}
+
+	void SetReceiveBufferSize( int size )
+	{
+		setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	}
+
+	void SetSendBufferSize( int size )
+	{
+		setsockopt(socket_, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+	}
+
+	bool SetMulticastMembership( int option, unsigned long group, unsigned long interfaceAddress )
+	{
+		struct ip_mreq request;
+		std::memset( &request, 0, sizeof(request) );
+		request.imr_multiaddr.s_addr = htonl( group );
+		request.imr_interface.s_addr = (interfaceAddress == IpEndpointName::ANY_ADDRESS) ? INADDR_ANY : htonl( interfaceAddress );
+		return (setsockopt(socket_, IPPROTO_IP, option, &request, sizeof(request)) == 0);
+	}
+
+	bool JoinMulticastGroup( unsigned long group, unsigned long interfaceAddress )
+	{
+		return SetMulticastMembership( IP_ADD_MEMBERSHIP, group, interfaceAddress );
+	}
+
+	bool LeaveMulticastGroup( unsigned long group, unsigned long interfaceAddress )
+	{
+		return SetMulticastMembership( IP_DROP_MEMBERSHIP, group, interfaceAddress );
+	}
+
+	void SetMulticastTTL( int ttl )
+	{
+		unsigned char value = (unsigned char)((ttl < 0) ? 0 : (ttl > 255) ? 255 : ttl);
+		setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_TTL, &value, sizeof(value));
+	}
+
+	void SetMulticastLoopback( bool enableLoopback )
+	{
+		unsigned char value = (enableLoopback) ? 1 : 0;
+		setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_LOOP, &value, sizeof(value));
+	}
+
+	void SetMulticastInterface( unsigned long interfaceAddress )
+	{
+		struct in_addr address;
+		address.s_addr = (interfaceAddress == IpEndpointName::ANY_ADDRESS) ? INADDR_ANY : htonl( interfaceAddress );
+		setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_IF, &address, sizeof(address));
+	}
+
+	void SetMaxPacketSize( std::size_t size ) { maxPacketSize_ = size; }
+
+	std::size_t MaxPacketSize() const { return maxPacketSize_; }
+
+	void SetEnableReceiveTimestamps( bool enableTimestamps )
+	{
+		int timestamps = (enableTimestamps) ? 1 : 0; // int on posix
+#ifdef SO_TIMESTAMPNS
+		int result = setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPNS, &timestamps, sizeof(timestamps));
+#else
+		int result = setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMP, &timestamps, sizeof(timestamps));
+#endif
+		receiveTimestamps_ = enableTimestamps && (result == 0);
+	}
+
+	bool ReceiveTimestamps() const { return receiveTimestamps_; }
+
 	IpEndpointName LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 	{
 		assert( isBound_ );
@@ -246,6 +354,36 @@ public:
 		return (std::size_t)result;
 	}
 
+    std::size_t ReceiveFrom( IpEndpointName& remoteEndpoint, char *data, std::size_t size, osc::int64& receiveTime, int flags=0 )
+	{
+		assert( isBound_ || isConnected_ );
+
+		struct sockaddr_in fromAddr;
+		struct iovec vector;
+		char control[ RECEIVE_CONTROL_SIZE ];
+		struct msghdr message;
+
+		vector.iov_base = data;
+		vector.iov_len = size;
+		std::memset( &message, 0, sizeof(message) );
+		message.msg_name = &fromAddr;
+		message.msg_namelen = sizeof(fromAddr);
+		message.msg_iov = &vector;
+		message.msg_iovlen = 1;
+		message.msg_control = control;
+		message.msg_controllen = sizeof(control);
+
+        ssize_t result = recvmsg(socket_, &message, flags);
+		if( result < 0 )
+			return 0;
+
+		remoteEndpoint.address = ntohl(fromAddr.sin_addr.s_addr);
+		remoteEndpoint.port = ntohs(fromAddr.sin_port);
+		receiveTime = ReceiveTimeFromControl( &message );
+
+		return (std::size_t)result;
+	}
+
 	int Socket() { return socket_; }
 };
 
@@ -269,6 +407,66 @@ void UdpSocket::SetAllowReuse( bool allowReuse )
     impl_->SetAllowReuse( allowReuse );
 }
 
+void UdpSocket::SetEnableReusePort( bool enableReusePort )
+{
+    impl_->SetEnableReusePort( enableReusePort );
+}
+
+void UdpSocket::SetReceiveBufferSize( int size )
+{
+    impl_->SetReceiveBufferSize( size );
+}
+
+void UdpSocket::SetSendBufferSize( int size )
+{
+    impl_->SetSendBufferSize( size );
+}
+
+bool UdpSocket::JoinMulticastGroup( unsigned long group, unsigned long interfaceAddress )
+{
+    return impl_->JoinMulticastGroup( group, interfaceAddress );
+}
+
+bool UdpSocket::LeaveMulticastGroup( unsigned long group, unsigned long interfaceAddress )
+{
+    return impl_->LeaveMulticastGroup( group, interfaceAddress );
+}
+
+void UdpSocket::SetMulticastTTL( int ttl )
+{
+    impl_->SetMulticastTTL( ttl );
+}
+
+void UdpSocket::SetMulticastLoopback( bool enableLoopback )
+{
+    impl_->SetMulticastLoopback( enableLoopback );
+}
+
+void UdpSocket::SetMulticastInterface( unsigned long interfaceAddress )
+{
+    impl_->SetMulticastInterface( interfaceAddress );
+}
+
+void UdpSocket::SetMaxPacketSize( std::size_t size )
+{
+    impl_->SetMaxPacketSize( size );
+}
+
+std::size_t UdpSocket::MaxPacketSize() const
+{
+    return impl_->MaxPacketSize();
+}
+
+void UdpSocket::SetEnableReceiveTimestamps( bool enableTimestamps )
+{
+    impl_->SetEnableReceiveTimestamps( enableTimestamps );
+}
+
+bool UdpSocket::ReceiveTimestamps() const
+{
+    return impl_->ReceiveTimestamps();
+}
+
 IpEndpointName UdpSocket::LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 {
 	return impl_->LocalEndpointFor( remoteEndpoint );
@@ -304,6 +502,11 @@ std::size_t UdpSocket::ReceiveFrom( IpEndpointName& remoteEndpoint, char *data,
 	return impl_->ReceiveFrom( remoteEndpoint, data, size );
 }
 
+std::size_t UdpSocket::ReceivePending( IpEndpointName& remoteEndpoint, char *data, std::size_t size, osc::int64& receiveTime )
+{
+	return impl_->ReceiveFrom( remoteEndpoint, data, size, receiveTime, MSG_DONTWAIT );
+}
+
 
 struct AttachedTimerListener{
 	AttachedTimerListener( int id, int p, TimerListener *tl )
@@ -349,11 +552,31 @@ class SocketReceiveMultiplexer::Implementation{
 		return ((double)t.tv_sec*1000.) + ((double)t.tv_usec / 1000.);
 	}
 
+	// the receive buffer needs to hold the largest datagram of all attached sockets
+	std::size_t MaxPacketSize() const
+	{
+		std::size_t result = 1;
+		for( std::vector< std::pair< PacketListener*, UdpSocket* > >::const_iterator i = socketListeners_.begin();
+				i != socketListeners_.end(); ++i )
+			result = std::max( result, i->second->impl_->MaxPacketSize() );
+		return result;
+	}
+
 public:
     Implementation()
 	{
 		if( pipe(breakPipe_) != 0 )
 			throw std::runtime_error( "creation of asynchronous break pipes failed\n" );
+
+		// the reader is non-blocking, so that the pipe can be drained when Run() returns
+		fcntl( breakPipe_[0], F_SETFL, fcntl( breakPipe_[0], F_GETFL, 0 ) | O_NONBLOCK );
+	}
+
+    void DrainBreakPipe()
+	{
+		// a break byte that was not consumed by the loop would otherwise end the next Run() immediately
+		char buffer[64];
+		while( read( breakPipe_[0], buffer, sizeof(buffer) ) > 0 );
 	}
 
     ~Implementation()
@@ -402,6 +625,159 @@ public:
 		timerListeners_.erase( i );
 	}
 
+#ifdef __linux__
+    // on Linux the multiplexer waits with epoll and drains each ready socket
+    // with recvmmsg(), which receives a batch of datagrams per system call.
+    void Run()
+	{
+		break_ = false;
+
+        const std::size_t MAX_BUFFER_SIZE = MaxPacketSize();
+        const int MAX_BATCH_SIZE = 64;
+
+        // large datagrams are received in smaller batches to keep the buffer size bounded
+        int batchSize = (int)( (MAX_BATCH_SIZE * 4098) / MAX_BUFFER_SIZE );
+        if( batchSize < 1 )
+            batchSize = 1;
+        else if( batchSize > MAX_BATCH_SIZE )
+            batchSize = MAX_BATCH_SIZE;
+
+        int epollfd = epoll_create( (int)socketListeners_.size() + 1 );
+        if( epollfd < 0 )
+            throw std::runtime_error("epoll_create failed\n");
+
+        char *data = 0;
+
+        try{
+
+            // the asynchronous break pipe is registered with index zero,
+            // the sockets with their position in socketListeners_ plus one.
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            event.data.u32 = 0;
+            if( epoll_ctl( epollfd, EPOLL_CTL_ADD, breakPipe_[0], &event ) < 0 )
+                throw std::runtime_error("epoll_ctl failed\n");
+
+            for( std::size_t i = 0; i < socketListeners_.size(); ++i ){
+                event.events = EPOLLIN;
+                event.data.u32 = (uint32_t)(i + 1);
+                if( epoll_ctl( epollfd, EPOLL_CTL_ADD, socketListeners_[i].second->impl_->Socket(), &event ) < 0 )
+                    throw std::runtime_error("epoll_ctl failed\n");
+            }
+
+
+            // configure the timer queue
+            double currentTimeMs = GetCurrentTimeMs();
+
+            // expiry time ms, listener
+            std::vector< std::pair< double, AttachedTimerListener > > timerQueue_;
+            for( std::vector< AttachedTimerListener >::iterator i = timerListeners_.begin();
+                    i != timerListeners_.end(); ++i )
+                timerQueue_.push_back( std::make_pair( currentTimeMs + i->initialDelayMs, *i ) );
+            std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
+
+            data = new char[ batchSize * MAX_BUFFER_SIZE ];
+            IpEndpointName remoteEndpoint;
+
+            struct epoll_event events[ MAX_BATCH_SIZE ];
+            struct mmsghdr messages[ MAX_BATCH_SIZE ];
+            struct iovec vectors[ MAX_BATCH_SIZE ];
+            struct sockaddr_in fromAddrs[ MAX_BATCH_SIZE ];
+            char controls[ MAX_BATCH_SIZE ][ RECEIVE_CONTROL_SIZE ];
+
+            std::memset( messages, 0, sizeof(messages) );
+            for( int m = 0; m < batchSize; ++m ){
+                vectors[m].iov_base = data + m * MAX_BUFFER_SIZE;
+                vectors[m].iov_len = MAX_BUFFER_SIZE;
+                messages[m].msg_hdr.msg_iov = &vectors[m];
+                messages[m].msg_hdr.msg_iovlen = 1;
+                messages[m].msg_hdr.msg_name = &fromAddrs[m];
+                messages[m].msg_hdr.msg_namelen = sizeof(fromAddrs[m]);
+                messages[m].msg_hdr.msg_control = controls[m];
+                messages[m].msg_hdr.msg_controllen = RECEIVE_CONTROL_SIZE;
+            }
+
+            while( !break_ ){
+
+                int timeoutMs = -1;
+                if( !timerQueue_.empty() ){
+                    double remainingMs = timerQueue_.front().first - GetCurrentTimeMs();
+                    timeoutMs = ( remainingMs < 0 ) ? 0 : (int)ceil( remainingMs );
+                }
+
+                int eventCount = epoll_wait( epollfd, events, MAX_BATCH_SIZE, timeoutMs );
+                if( eventCount < 0 ){
+                    if( break_ ){
+                        break;
+                    }else if( errno == EINTR ){
+                        continue;
+                    }else{
+                        throw std::runtime_error("epoll_wait failed\n");
+                    }
+                }
+
+                for( int e = 0; e < eventCount && !break_; ++e ){
+
+                    if( events[e].data.u32 == 0 ){
+                        // clear pending data from the asynchronous break pipe,
+                        // a break issued before Run() was entered also ends it
+                        char c;
+                        read( breakPipe_[0], &c, 1 );
+                        break_ = true;
+                        continue;
+                    }
+
+                    PacketListener *listener = socketListeners_[ events[e].data.u32 - 1 ].first;
+                    UdpSocket *socket = socketListeners_[ events[e].data.u32 - 1 ].second;
+
+                    int count = recvmmsg( socket->impl_->Socket(), messages, batchSize, MSG_DONTWAIT, 0 );
+                    for( int m = 0; m < count; ++m ){
+
+                        if( messages[m].msg_len > 0 && !break_ ){
+                            remoteEndpoint.address = ntohl(fromAddrs[m].sin_addr.s_addr);
+                            remoteEndpoint.port = ntohs(fromAddrs[m].sin_port);
+                            if( socket->impl_->ReceiveTimestamps() )
+                                listener->ProcessPacket( data + m * MAX_BUFFER_SIZE, (int)messages[m].msg_len, remoteEndpoint,
+                                        ReceiveTimeFromControl( &messages[m].msg_hdr ) );
+                            else
+                                listener->ProcessPacket( data + m * MAX_BUFFER_SIZE, (int)messages[m].msg_len, remoteEndpoint );
+                        }
+
+                        // recvmmsg() overwrites the address and control lengths, which need to be restored for the next batch
+                        messages[m].msg_hdr.msg_namelen = sizeof(fromAddrs[m]);
+                        messages[m].msg_hdr.msg_controllen = RECEIVE_CONTROL_SIZE;
+                    }
+                }
+
+                // execute any expired timers
+                currentTimeMs = GetCurrentTimeMs();
+                bool resort = false;
+                for( std::vector< std::pair< double, AttachedTimerListener > >::iterator i = timerQueue_.begin();
+                        i != timerQueue_.end() && i->first <= currentTimeMs; ++i ){
+
+                    i->second.listener->TimerExpired();
+                    if( break_ )
+                        break;
+
+                    i->first += i->second.periodMs;
+                    resort = true;
+                }
+                if( resort )
+                    std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
+            }
+
+            delete [] data;
+            close( epollfd );
+            DrainBreakPipe();
+        }catch(...){
+            if( data )
+                delete [] data;
+            close( epollfd );
+            DrainBreakPipe();
+            throw;
+        }
+	}
+#else
     void Run()
 	{
 		break_ = false;
@@ -440,7 +816,7 @@ public:
                 timerQueue_.push_back( std::make_pair( currentTimeMs + i->initialDelayMs, *i ) );
             std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
 
-            const int MAX_BUFFER_SIZE = 4098;
+            const std::size_t MAX_BUFFER_SIZE = MaxPacketSize();
             data = new char[ MAX_BUFFER_SIZE ];
             IpEndpointName remoteEndpoint;
 
@@ -477,9 +853,11 @@ public:
                 }
 
                 if( FD_ISSET( breakPipe_[0], &tempfds ) ){
-                    // clear pending data from the asynchronous break pipe
+                    // clear pending data from the asynchronous break pipe,
+                    // a break issued before Run() was entered also ends it
                     char c;
                     read( breakPipe_[0], &c, 1 );
+                    break_ = true;
                 }
                 
                 if( break_ )
@@ -490,11 +868,21 @@ public:
 
                     if( FD_ISSET( i->second->impl_->Socket(), &tempfds ) ){
 
-                        std::size_t size = i->second->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE );
-                        if( size > 0 ){
-                            i->first->ProcessPacket( data, (int)size, remoteEndpoint );
-                            if( break_ )
-                                break;
+                        if( i->second->impl_->ReceiveTimestamps() ){
+                            osc::int64 receiveTime = 0;
+                            std::size_t size = i->second->impl_->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE, receiveTime );
+                            if( size > 0 ){
+                                i->first->ProcessPacket( data, (int)size, remoteEndpoint, receiveTime );
+                                if( break_ )
+                                    break;
+                            }
+                        }else{
+                            std::size_t size = i->second->ReceiveFrom( remoteEndpoint, data, MAX_BUFFER_SIZE );
+                            if( size > 0 ){
+                                i->first->ProcessPacket( data, (int)size, remoteEndpoint );
+                                if( break_ )
+                                    break;
+                            }
                         }
                     }
                 }
@@ -517,12 +905,15 @@ public:
             }
 
             delete [] data;
+            DrainBreakPipe();
         }catch(...){
             if( data )
                 delete [] data;
+            DrainBreakPipe();
             throw;
         }
 	}
+#endif
 
     void Break()
 	{
@@ -531,10 +922,10 @@ public:
 
     void AsynchronousBreak()
 	{
-		break_ = true;
-
-		// Send a termination message to the asynchronous break pipe, so select() will return
+		// Send a termination message to the asynchronous break pipe, so select() will return.
+		// It is written before the flag is set, so that Run() drains it even if it stops on the flag.
 		write( breakPipe_[1], "!", 1 );
+		break_ = true;
 	}
 };
 
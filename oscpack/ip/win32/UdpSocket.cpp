@@ -36,6 +36,7 @@
 */
 
 #include <winsock2.h>   // this must come first to prevent errors with MSVC7
+#include <ws2tcpip.h>   // for ip_mreq and the winsock2 multicast options
 #include <windows.h>
 #include <mmsystem.h>   // for timeGetTime()
 
@@ -96,6 +97,7 @@ class UdpSocket::Implementation{
 
 	bool isBound_;
 	bool isConnected_;
+	std::size_t maxPacketSize_;
 
 	SOCKET socket_;
 	struct sockaddr_in connectedAddr_;
@@ -106,6 +108,7 @@ public:
 	Implementation()
 		: isBound_( false )
 		, isConnected_( false )
+		, maxPacketSize_( 4098 )
 		, socket_( INVALID_SOCKET )
 	{
 		if( (socket_ = socket( AF_INET, SOCK_DGRAM, 0 )) == INVALID_SOCKET ){
@@ -137,6 +140,64 @@ public:
 		setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuseAddr, sizeof(reuseAddr));
 	}
 
+	void SetEnableReusePort( bool enableReusePort )
+	{
+		// Win32 does not distribute datagrams across sockets sharing a port
+		(void)enableReusePort;
+	}
+
+	void SetReceiveBufferSize( int size )
+	{
+		setsockopt(socket_, SOL_SOCKET, SO_RCVBUF, (const char*)&size, sizeof(size));
+	}
+
+	void SetSendBufferSize( int size )
+	{
+		setsockopt(socket_, SOL_SOCKET, SO_SNDBUF, (const char*)&size, sizeof(size));
+	}
+
+	bool SetMulticastMembership( int option, unsigned long group, unsigned long interfaceAddress )
+	{
+		struct ip_mreq request;
+		std::memset( &request, 0, sizeof(request) );
+		request.imr_multiaddr.s_addr = htonl( group );
+		request.imr_interface.s_addr = (interfaceAddress == IpEndpointName::ANY_ADDRESS) ? INADDR_ANY : htonl( interfaceAddress );
+		return (setsockopt(socket_, IPPROTO_IP, option, (const char*)&request, sizeof(request)) == 0);
+	}
+
+	bool JoinMulticastGroup( unsigned long group, unsigned long interfaceAddress )
+	{
+		return SetMulticastMembership( IP_ADD_MEMBERSHIP, group, interfaceAddress );
+	}
+
+	bool LeaveMulticastGroup( unsigned long group, unsigned long interfaceAddress )
+	{
+		return SetMulticastMembership( IP_DROP_MEMBERSHIP, group, interfaceAddress );
+	}
+
+	void SetMulticastTTL( int ttl )
+	{
+		DWORD value = (DWORD)((ttl < 0) ? 0 : (ttl > 255) ? 255 : ttl); // DWORD on win32
+		setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_TTL, (const char*)&value, sizeof(value));
+	}
+
+	void SetMulticastLoopback( bool enableLoopback )
+	{
+		DWORD value = (enableLoopback) ? 1 : 0; // DWORD on win32
+		setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_LOOP, (const char*)&value, sizeof(value));
+	}
+
+	void SetMulticastInterface( unsigned long interfaceAddress )
+	{
+		struct in_addr address;
+		address.s_addr = (interfaceAddress == IpEndpointName::ANY_ADDRESS) ? INADDR_ANY : htonl( interfaceAddress );
+		setsockopt(socket_, IPPROTO_IP, IP_MULTICAST_IF, (const char*)&address, sizeof(address));
+	}
+
+	void SetMaxPacketSize( std::size_t size ) { maxPacketSize_ = size; }
+
+	std::size_t MaxPacketSize() const { return maxPacketSize_; }
+
 	IpEndpointName LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 	{
 		assert( isBound_ );
@@ -239,6 +300,30 @@ public:
 		return result;
 	}
 
+    std::size_t ReceivePending( IpEndpointName& remoteEndpoint, char *data, std::size_t size )
+	{
+		// poll the socket, since it would need to be switched into non-blocking mode otherwise
+		fd_set readfds;
+		FD_ZERO( &readfds );
+		FD_SET( socket_, &readfds );
+		struct timeval timeout = { 0, 0 };
+		if( select( 0, &readfds, 0, 0, &timeout ) <= 0 )
+			return 0;
+
+		struct sockaddr_in fromAddr;
+        socklen_t fromAddrLen = sizeof(fromAddr);
+
+        int result = recvfrom(socket_, data, (int)size, 0,
+                    (struct sockaddr *) &fromAddr, (socklen_t*)&fromAddrLen);
+		if( result < 0 )
+			return 0;
+
+		remoteEndpoint.address = ntohl(fromAddr.sin_addr.s_addr);
+		remoteEndpoint.port = ntohs(fromAddr.sin_port);
+
+		return result;
+	}
+
 	SOCKET& Socket() { return socket_; }
 };
 
@@ -262,6 +347,67 @@ void UdpSocket::SetAllowReuse( bool allowReuse )
     impl_->SetAllowReuse( allowReuse );
 }
 
+void UdpSocket::SetEnableReusePort( bool enableReusePort )
+{
+    impl_->SetEnableReusePort( enableReusePort );
+}
+
+void UdpSocket::SetEnableReceiveTimestamps( bool enableTimestamps )
+{
+    // Win32 sockets do not provide kernel receive timestamps
+    (void) enableTimestamps;
+}
+
+bool UdpSocket::ReceiveTimestamps() const
+{
+    return false;
+}
+
+void UdpSocket::SetReceiveBufferSize( int size )
+{
+    impl_->SetReceiveBufferSize( size );
+}
+
+void UdpSocket::SetSendBufferSize( int size )
+{
+    impl_->SetSendBufferSize( size );
+}
+
+bool UdpSocket::JoinMulticastGroup( unsigned long group, unsigned long interfaceAddress )
+{
+    return impl_->JoinMulticastGroup( group, interfaceAddress );
+}
+
+bool UdpSocket::LeaveMulticastGroup( unsigned long group, unsigned long interfaceAddress )
+{
+    return impl_->LeaveMulticastGroup( group, interfaceAddress );
+}
+
+void UdpSocket::SetMulticastTTL( int ttl )
+{
+    impl_->SetMulticastTTL( ttl );
+}
+
+void UdpSocket::SetMulticastLoopback( bool enableLoopback )
+{
+    impl_->SetMulticastLoopback( enableLoopback );
+}
+
+void UdpSocket::SetMulticastInterface( unsigned long interfaceAddress )
+{
+    impl_->SetMulticastInterface( interfaceAddress );
+}
+
+void UdpSocket::SetMaxPacketSize( std::size_t size )
+{
+    impl_->SetMaxPacketSize( size );
+}
+
+std::size_t UdpSocket::MaxPacketSize() const
+{
+    return impl_->MaxPacketSize();
+}
+
 IpEndpointName UdpSocket::LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 {
 	return impl_->LocalEndpointFor( remoteEndpoint );
@@ -297,6 +443,12 @@ std::size_t UdpSocket::ReceiveFrom( IpEndpointName& remoteEndpoint, char *data,
 	return impl_->ReceiveFrom( remoteEndpoint, data, size );
 }
 
+std::size_t UdpSocket::ReceivePending( IpEndpointName& remoteEndpoint, char *data, std::size_t size, osc::int64& receiveTime )
+{
+	receiveTime = 0;
+	return impl_->ReceivePending( remoteEndpoint, data, size );
+}
+
 
 struct AttachedTimerListener{
 	AttachedTimerListener( int id, int p, TimerListener *tl )
@@ -429,7 +581,12 @@ public:
 			timerQueue_.push_back( std::make_pair( currentTimeMs + i->initialDelayMs, *i ) );
 		std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
 
-		const int MAX_BUFFER_SIZE = 4098;
+		// the receive buffer needs to hold the largest datagram of all attached sockets
+		std::size_t MAX_BUFFER_SIZE = 1;
+		for( std::size_t i = 0; i < socketListeners_.size(); ++i ){
+			if( socketListeners_[i].second->impl_->MaxPacketSize() > MAX_BUFFER_SIZE )
+				MAX_BUFFER_SIZE = socketListeners_[i].second->impl_->MaxPacketSize();
+		}
 		char *data = new char[ MAX_BUFFER_SIZE ];
 		IpEndpointName remoteEndpoint;
 
@@ -446,6 +603,10 @@ public:
             }
 
 			DWORD waitResult = WaitForMultipleObjects( (DWORD)socketListeners_.size() + 1, &events[0], FALSE, waitTime );
+
+			// a break issued before Run() was entered also ends it
+			if( waitResult == WAIT_OBJECT_0 + socketListeners_.size() )
+				break_ = true;
 			if( break_ )
 				break;
 